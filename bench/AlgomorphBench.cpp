@@ -0,0 +1,289 @@
+// Headless process() benchmark for Algomorph Advance and Algomorph Pocket.
+//
+// Build with `make bench` (RACK_DIR must point at a Rack SDK, as for the plugin itself), then run
+//      build/AlgomorphBench [--frames N] [--format csv|json]
+// Results are written to stdout, one row per scenario, in ns/sample.
+// The 64 voice rows compare one Algomorph Advance with an Algomorph Wide against four Algomorph Advance instances,
+// with every operator patched at 16 channels. Their time is for all the modules together.
+
+#include "../src/AlgomorphLarge.hpp"
+#include "../src/AlgomorphSmall.hpp"
+#include "../src/AlgomorphWide.hpp"
+#include "../src/plugin.hpp"
+#include "BenchCommon.hpp"
+#include <rack.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+static constexpr float BENCH_SAMPLE_RATE = 48000.f;
+static constexpr int BENCH_CHANNELS[] = {1, 4, 8, 16};
+static constexpr int BENCH_SIGNAL_FRAMES = 4800;     // 0.1 s of input, looped
+
+struct BenchFlags {
+    bool modeB = false;
+    bool ringMorph = false;
+    bool clickFilterEnabled = true;
+    bool avgMode = true;
+};
+
+struct BenchAuxSetup {
+    std::string name;
+    std::vector<std::pair<int, int>> modes;     // {auxIndex, mode}
+};
+
+struct BenchResult {
+    std::string module;
+    int channels;
+    BenchFlags flags;
+    std::string aux;
+    int blockSize;
+    double nsPerSample;
+};
+
+// Every combination exercises a distinct branch of the routing loop, so keep them few but meaningful
+static const std::vector<BenchAuxSetup> AUX_SETUPS = {
+    { "none", {} },
+    { "morph", { {0, AuxInputModes::MORPH}, {1, AuxInputModes::MORPH_ATTEN} } },
+    { "triple-morph", { {0, AuxInputModes::TRIPLE_MORPH}, {1, AuxInputModes::DOUBLE_MORPH}, {2, AuxInputModes::MORPH} } },
+    { "clock", { {0, AuxInputModes::CLOCK}, {1, AuxInputModes::RESET}, {2, AuxInputModes::SCENE_OFFSET} } },
+    { "atten", { {0, AuxInputModes::SUM_ATTEN}, {1, AuxInputModes::MOD_ATTEN}, {2, AuxInputModes::CLICK_FILTER} } },
+    { "wildcard", { {0, AuxInputModes::WILDCARD_MOD}, {1, AuxInputModes::WILDCARD_SUM} } },
+    { "shadow", { {0, AuxInputModes::SHADOW}, {1, AuxInputModes::SHADOW + 1}, {2, AuxInputModes::SHADOW + 2}, {3, AuxInputModes::SHADOW + 3} } }
+};
+
+template < typename MODULE >
+static void applyFlags(MODULE* module, const BenchFlags& flags) {
+    module->modeB = flags.modeB;
+    module->ringMorph = flags.ringMorph;
+    module->clickFilterEnabled = flags.clickFilterEnabled;
+    module->avgMode = flags.avgMode;
+
+    // Same seed for every scenario, so each one routes the same algorithms
+    seedRandom(0x416c676f, 0x6d6f7270);
+    for (int scene = 0; scene < 3; scene++)
+        module->randomizeAlgorithm(scene);
+    module->graphDirty = true;
+}
+
+// Deterministic, cheap test signals: a different phase per operator and channel
+static float benchSignal(int64_t frame, int index, int c) {
+    float phase = std::fmod((frame + 97 * index + 13 * c) * (110.f * (index + 1) / BENCH_SAMPLE_RATE), 1.f);
+    return 5.f * sin2pi_pade_05_5_4(phase);
+}
+
+struct BenchModule {
+    rack::engine::Module* module;
+    int inputs;                     // Its first inputs are patched
+};
+
+// The modules are processed in turn each frame, then their expander messages flipped, as the engine does
+static double timeProcess(const std::vector<BenchModule>& modules, int channels, int64_t frames) {
+    // Port::setChannels() is ignored on unconnected ports, so patch them the way the engine does when a cable is added
+    int totalInputs = 0;
+    for (const BenchModule& m : modules) {
+        for (int i = 0; i < m.inputs; i++)
+            m.module->inputs[i].channels = channels;
+        for (rack::engine::Output& output : m.module->outputs)
+            output.channels = 1;
+        totalInputs += m.inputs;
+    }
+
+    // The signals are computed up front and looped, so only the copy into the ports, as the engine does it, is timed
+    std::vector<float> signal(BENCH_SIGNAL_FRAMES * totalInputs * channels);
+    for (int frame = 0; frame < BENCH_SIGNAL_FRAMES; frame++) {
+        for (int i = 0; i < totalInputs; i++) {
+            for (int c = 0; c < channels; c++)
+                signal[(frame * totalInputs + i) * channels + c] = benchSignal(frame, i, c);
+        }
+    }
+
+    rack::engine::Module::ProcessArgs args;
+    args.sampleRate = BENCH_SAMPLE_RATE;
+    args.sampleTime = 1.f / BENCH_SAMPLE_RATE;
+
+    auto run = [&](int64_t from, int64_t to) {
+        for (int64_t frame = from; frame < to; frame++) {
+            const float* voltages = &signal[(frame % BENCH_SIGNAL_FRAMES) * totalInputs * channels];
+            for (const BenchModule& m : modules) {
+                for (int i = 0; i < m.inputs; i++, voltages += channels)
+                    std::copy(voltages, voltages + channels, m.module->inputs[i].voltages);
+            }
+            args.frame = frame;
+            for (const BenchModule& m : modules)
+                m.module->process(args);
+            for (const BenchModule& m : modules)
+                flipExpanderMessages(m.module);
+        }
+    };
+
+    // Warm up caches and let the click filters settle before timing
+    int64_t warmup = frames / 8;
+    run(0, warmup);
+
+    // One clock read around the whole run, so the clock itself isn't part of the cost per sample
+    auto start = std::chrono::steady_clock::now();
+    run(warmup, warmup + frames);
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / frames;
+}
+
+static double benchLarge(int channels, const BenchFlags& flags, const BenchAuxSetup& aux, int blockSize, int64_t frames) {
+    AlgomorphLarge* module = new AlgomorphLarge;
+    for (int auxIndex = 0; auxIndex < AlgomorphLarge::NUM_AUX_INPUTS; auxIndex++)
+        module->auxInput[auxIndex]->clearAuxModes();
+    for (const std::pair<int, int>& m : aux.modes) {
+        module->auxInput[m.first]->allowMultipleModes = true;
+        module->auxInput[m.first]->setMode(m.second);
+    }
+    applyFlags(module, flags);
+    module->params[AlgomorphLarge::MORPH_KNOB].setValue(0.35f);
+    module->blockSize = blockSize;
+
+    // Only connect the aux inputs that have a mode, so unconnected-aux paths stay representative
+    int auxInputs = 0;
+    for (const std::pair<int, int>& m : aux.modes)
+        auxInputs = std::max(auxInputs, m.first + 1);
+
+    double ns = timeProcess({{module, AlgomorphLarge::AUX_INPUTS + auxInputs}}, channels, frames);
+    delete module;
+    return ns;
+}
+
+static double benchSmall(int channels, const BenchFlags& flags, int64_t frames) {
+    AlgomorphSmall* module = new AlgomorphSmall;
+    applyFlags(module, flags);
+    module->params[AlgomorphSmall::MORPH_KNOB].setValue(0.35f);
+
+    double ns = timeProcess({{module, AlgomorphSmall::NUM_INPUTS}}, channels, frames);
+    delete module;
+    return ns;
+}
+
+// 64 voices per operator, through an Algomorph Wide or through instances of 16 voices each
+static double benchWide(int64_t frames) {
+    BenchFlags defaults;
+    AlgomorphLarge* module = new AlgomorphLarge;
+    applyFlags(module, defaults);
+    module->params[AlgomorphLarge::MORPH_KNOB].setValue(0.35f);
+    AlgomorphWide* wide = new AlgomorphWide;
+    module->model = modelAlgomorphLarge;
+    wide->model = modelAlgomorphWide;
+    placeSideBySide(module, wide);
+
+    double ns = timeProcess({{module, 4}, {wide, AlgomorphWide::NUM_INPUTS}}, CHANNELS, frames);
+    delete wide;
+    delete module;
+    return ns;
+}
+
+static double benchInstances(int instances, int64_t frames) {
+    BenchFlags defaults;
+    std::vector<BenchModule> modules;
+    for (int i = 0; i < instances; i++) {
+        AlgomorphLarge* module = new AlgomorphLarge;
+        applyFlags(module, defaults);
+        module->params[AlgomorphLarge::MORPH_KNOB].setValue(0.35f);
+        modules.push_back({module, 4});
+    }
+
+    double ns = timeProcess(modules, CHANNELS, frames);
+    for (const BenchModule& m : modules)
+        delete m.module;
+    return ns;
+}
+
+static void printCsv(const std::vector<BenchResult>& results) {
+    std::printf("module,channels,modeB,ringMorph,clickFilter,avgMode,aux,blockSize,nsPerSample\n");
+    for (const BenchResult& r : results) {
+        std::printf("%s,%d,%d,%d,%d,%d,%s,%d,%.2f\n", r.module.c_str(), r.channels, r.flags.modeB, r.flags.ringMorph,
+                    r.flags.clickFilterEnabled, r.flags.avgMode, r.aux.c_str(), r.blockSize, r.nsPerSample);
+    }
+}
+
+static void printJson(const std::vector<BenchResult>& results) {
+    json_t* rootJ = json_object();
+    json_object_set_new(rootJ, "sampleRate", json_real(BENCH_SAMPLE_RATE));
+    json_t* resultsJ = json_array();
+    for (const BenchResult& r : results) {
+        json_t* resultJ = json_object();
+        json_object_set_new(resultJ, "module", json_string(r.module.c_str()));
+        json_object_set_new(resultJ, "channels", json_integer(r.channels));
+        json_object_set_new(resultJ, "modeB", json_boolean(r.flags.modeB));
+        json_object_set_new(resultJ, "ringMorph", json_boolean(r.flags.ringMorph));
+        json_object_set_new(resultJ, "clickFilter", json_boolean(r.flags.clickFilterEnabled));
+        json_object_set_new(resultJ, "avgMode", json_boolean(r.flags.avgMode));
+        json_object_set_new(resultJ, "aux", json_string(r.aux.c_str()));
+        json_object_set_new(resultJ, "blockSize", json_integer(r.blockSize));
+        json_object_set_new(resultJ, "nsPerSample", json_real(r.nsPerSample));
+        json_array_append_new(resultsJ, resultJ);
+    }
+    json_object_set_new(rootJ, "results", resultsJ);
+    json_dumpf(rootJ, stdout, JSON_INDENT(2) | JSON_REAL_PRECISION(6));
+    std::printf("\n");
+    json_decref(rootJ);
+}
+
+int main(int argc, char* argv[]) {
+    int64_t frames = 48000;
+    bool json = false;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--frames") && i + 1 < argc)
+            frames = std::max(1LL, std::atoll(argv[++i]));
+        else if (!std::strcmp(argv[i], "--format") && i + 1 < argc)
+            json = !std::strcmp(argv[++i], "json");
+        else {
+            std::fprintf(stderr, "Usage: %s [--frames N] [--format csv|json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    rack::Context* context = createHeadlessContext(BENCH_SAMPLE_RATE);
+
+    std::vector<BenchResult> results;
+
+    for (int channels : BENCH_CHANNELS) {
+        for (int i = 0; i < 16; i++) {
+            BenchFlags flags;
+            flags.modeB = i & 1;
+            flags.ringMorph = i & 2;
+            flags.clickFilterEnabled = i & 4;
+            flags.avgMode = i & 8;
+
+            results.push_back({"AlgomorphLarge", channels, flags, "none", 0, benchLarge(channels, flags, AUX_SETUPS[0], 0, frames)});
+            results.push_back({"AlgomorphSmall", channels, flags, "none", 0, benchSmall(channels, flags, frames)});
+        }
+
+        // Aux combinations are measured against the default settings only
+        BenchFlags defaults;
+        for (unsigned a = 1; a < AUX_SETUPS.size(); a++)
+            results.push_back({"AlgomorphLarge", channels, defaults, AUX_SETUPS[a].name, 0, benchLarge(channels, defaults, AUX_SETUPS[a], 0, frames)});
+
+        // Block processing, with control running per frame of each block, against the aux setups it routes in one go
+        for (int blockSize : BLOCK_SIZES) {
+            if (blockSize == 0)
+                continue;
+            for (const char* name : {"none", "morph", "clock"}) {
+                const BenchAuxSetup& aux = *std::find_if(AUX_SETUPS.begin(), AUX_SETUPS.end(), [&](const BenchAuxSetup& setup) { return setup.name == name; });
+                results.push_back({"AlgomorphLarge", channels, defaults, aux.name, blockSize, benchLarge(channels, defaults, aux, blockSize, frames)});
+            }
+        }
+    }
+
+    BenchFlags defaults;
+    results.push_back({"AlgomorphLarge+Wide", (WIDE_GROUPS + 1) * CHANNELS, defaults, "none", 0, benchWide(frames)});
+    results.push_back({"AlgomorphLarge x4", 4 * CHANNELS, defaults, "none", 0, benchInstances(4, frames)});
+
+    if (json)
+        printJson(results);
+    else
+        printCsv(results);
+
+    delete context;
+    return 0;
+}
@@ -0,0 +1,418 @@
+// Headless UI drawing benchmark for the Algomorph display, connection lines and panel lights.
+//
+// Build and run with `make display-bench` (RACK_DIR must point at a Rack SDK, as for the plugin itself), or run from the
+// repository root:
+//      build/AlgomorphDisplayBench [--frames N] [--format csv|json]
+// Scenarios cover static scenes, morphing, mystery graphs, computed layouts and every table graph.
+// Drawing goes through a real NanoVG context whose render backend only records: draw calls, paths, vertices and
+// paint/composite changes between draw calls. NanoVG still flattens and tessellates every path on the CPU, so the
+// time per frame is the UI thread cost of building the frame, without the GPU. Counts are per frame, after NanoVG
+// has flattened curves and expanded strokes.
+//
+// The display is driven through AlgoDrawWidget::updateDisplayState() and drawGraph(), which is drawLayer() minus
+// the font lookup and framebuffer compositing that need a window. Light halos are drawn uncached
+// (HaloCache::direct()), which is what every halo costs in the app on a zoom change, and what each one cost per frame
+// before they were cached.
+
+#include "../src/AlgomorphLarge.hpp"
+#include "../src/AlgomorphDisplayWidget.hpp"
+#include "../src/Components.hpp"
+#include "../src/ConnectionBgWidget.hpp"
+#include "../src/plugin.hpp"
+#include "BenchCommon.hpp"
+#include <rack.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+
+static constexpr float DISPLAY_BENCH_SAMPLE_RATE = 48000.f;
+static constexpr int NUM_GRAPHS = 1980;         // Graph 1979 stands in for mystery graphs
+static const Vec DISPLAY_SIZE = mm2px(Vec(38.295, 31.590));
+
+// From AlgomorphLargeWidget
+static const std::vector<Vec> OP_BUTTON_CENTERS = { {mm2px(25.578), mm2px(86.926)},
+                                                    {mm2px(25.578), mm2px(75.904)},
+                                                    {mm2px(25.578), mm2px(64.883)},
+                                                    {mm2px(25.578), mm2px(53.863)} };
+static const std::vector<Vec> MOD_BUTTON_CENTERS = {    {mm2px(45.278), mm2px(86.926)},
+                                                        {mm2px(45.278), mm2px(75.904)},
+                                                        {mm2px(45.278), mm2px(64.883)},
+                                                        {mm2px(45.278), mm2px(53.863)} };
+
+
+/// Recording NanoVG backend
+
+struct DrawCounts {
+    long fills = 0;
+    long strokes = 0;
+    long triangles = 0;         // Text and images
+    long paths = 0;
+    long vertices = 0;
+    long stateChanges = 0;      // Draw calls whose paint or composite operation differs from the previous one
+
+    long drawCalls() const {
+        return fills + strokes + triangles;
+    }
+};
+
+struct Recorder {
+    DrawCounts counts;
+    NVGpaint lastPaint;
+    NVGcompositeOperationState lastComposite;
+    bool first = true;
+    std::map<int, std::pair<int, int>> textures;
+    int nextTexture = 1;
+
+    void notePaint(const NVGpaint* paint, NVGcompositeOperationState composite) {
+        if (first || std::memcmp(paint, &lastPaint, sizeof(NVGpaint)) || std::memcmp(&composite, &lastComposite, sizeof(composite)))
+            counts.stateChanges++;
+        lastPaint = *paint;
+        lastComposite = composite;
+        first = false;
+    }
+
+    static Recorder* get(void* uptr) {
+        return reinterpret_cast<Recorder*>(uptr);
+    }
+
+    static int renderCreate(void* uptr) {
+        return 1;
+    }
+
+    static int renderCreateTexture(void* uptr, int type, int w, int h, int imageFlags, const unsigned char* data) {
+        Recorder* r = get(uptr);
+        int id = r->nextTexture++;
+        r->textures[id] = std::make_pair(w, h);
+        return id;
+    }
+
+    static int renderDeleteTexture(void* uptr, int image) {
+        return get(uptr)->textures.erase(image) > 0;
+    }
+
+    static int renderUpdateTexture(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data) {
+        return 1;
+    }
+
+    static int renderGetTextureSize(void* uptr, int image, int* w, int* h) {
+        Recorder* r = get(uptr);
+        auto it = r->textures.find(image);
+        if (it == r->textures.end())
+            return 0;
+        *w = it->second.first;
+        *h = it->second.second;
+        return 1;
+    }
+
+    static void renderViewport(void* uptr, float width, float height, float devicePixelRatio) {}
+    static void renderCancel(void* uptr) {}
+    static void renderFlush(void* uptr) {}
+    static void renderDelete(void* uptr) {}
+
+    static void renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe, const float* bounds, const NVGpath* paths, int npaths) {
+        Recorder* r = get(uptr);
+        r->counts.fills++;
+        r->counts.paths += npaths;
+        for (int i = 0; i < npaths; i++)
+            r->counts.vertices += paths[i].nfill + paths[i].nstroke;
+        r->notePaint(paint, compositeOperation);
+    }
+
+    static void renderStroke(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe, float strokeWidth, const NVGpath* paths, int npaths) {
+        Recorder* r = get(uptr);
+        r->counts.strokes++;
+        r->counts.paths += npaths;
+        for (int i = 0; i < npaths; i++)
+            r->counts.vertices += paths[i].nstroke;
+        r->notePaint(paint, compositeOperation);
+    }
+
+    static void renderTriangles(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, const NVGvertex* verts, int nverts, float fringe) {
+        Recorder* r = get(uptr);
+        r->counts.triangles++;
+        r->counts.vertices += nverts;
+        r->notePaint(paint, compositeOperation);
+    }
+};
+
+static NVGcontext* createRecordingContext(Recorder* recorder) {
+    NVGparams params;
+    std::memset(&params, 0, sizeof(params));
+    params.userPtr = recorder;
+    params.edgeAntiAlias = 1;
+    params.renderCreate = Recorder::renderCreate;
+    params.renderCreateTexture = Recorder::renderCreateTexture;
+    params.renderDeleteTexture = Recorder::renderDeleteTexture;
+    params.renderUpdateTexture = Recorder::renderUpdateTexture;
+    params.renderGetTextureSize = Recorder::renderGetTextureSize;
+    params.renderViewport = Recorder::renderViewport;
+    params.renderCancel = Recorder::renderCancel;
+    params.renderFlush = Recorder::renderFlush;
+    params.renderFill = Recorder::renderFill;
+    params.renderStroke = Recorder::renderStroke;
+    params.renderTriangles = Recorder::renderTriangles;
+    params.renderDelete = Recorder::renderDelete;
+    return nvgCreateInternal(&params);
+}
+
+
+/// Scenarios
+
+struct DisplayBenchResult {
+    std::string scenario;
+    long frames;
+    double usPerFrame;
+    DrawCounts counts;          // Totals over all frames
+};
+
+// Draws `frames` frames with `drawFrame(vg, frame)` and reports the per-frame averages
+static DisplayBenchResult runScenario(const std::string& name, NVGcontext* vg, Recorder* recorder, long frames, std::function<void(NVGcontext*, long)> drawFrame) {
+    recorder->counts = DrawCounts();
+    recorder->first = true;
+    double seconds = 0.0;
+    for (long frame = 0; frame < frames; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        nvgBeginFrame(vg, 640.f, 480.f, 1.f);
+        drawFrame(vg, frame);
+        nvgEndFrame(vg);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return {name, frames, seconds * 1e6 / frames, recorder->counts};
+}
+
+typedef AlgomorphDisplayWidget<>::AlgoDrawWidget DisplayDrawWidget;
+
+static void setDisplay(DisplayDrawWidget* display, int sceneGraph, int morphGraph, float morph) {
+    display->setGraph(0, sceneGraph);
+    display->setGraph(1, morphGraph);
+    display->scene = 0;
+    display->morphScene = 1;
+    display->morph = morph;
+}
+
+static void drawDisplay(DisplayDrawWidget* display, NVGcontext* vg, float morph) {
+    display->morph = morph;
+    display->updateDisplayState();
+    nvgSave(vg);
+    display->drawGraph(vg);
+    nvgRestore(vg);
+}
+
+static std::shared_ptr<Svg> loadPluginSvg(const std::string& filename) {
+    std::shared_ptr<Svg> svg = std::make_shared<Svg>();
+    svg->loadFile(rack::asset::plugin(pluginInstance, filename));
+    return svg;
+}
+
+static void printCsv(const std::vector<DisplayBenchResult>& results) {
+    std::printf("scenario,frames,usPerFrame,drawCalls,fills,strokes,triangles,paths,vertices,stateChanges\n");
+    for (const DisplayBenchResult& r : results) {
+        double f = r.frames;
+        std::printf("%s,%ld,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", r.scenario.c_str(), r.frames, r.usPerFrame,
+                    r.counts.drawCalls() / f, r.counts.fills / f, r.counts.strokes / f, r.counts.triangles / f,
+                    r.counts.paths / f, r.counts.vertices / f, r.counts.stateChanges / f);
+    }
+}
+
+static void printJson(const std::vector<DisplayBenchResult>& results) {
+    json_t* rootJ = json_object();
+    json_t* resultsJ = json_array();
+    for (const DisplayBenchResult& r : results) {
+        double f = r.frames;
+        json_t* resultJ = json_object();
+        json_object_set_new(resultJ, "scenario", json_string(r.scenario.c_str()));
+        json_object_set_new(resultJ, "frames", json_integer(r.frames));
+        json_object_set_new(resultJ, "usPerFrame", json_real(r.usPerFrame));
+        json_object_set_new(resultJ, "drawCalls", json_real(r.counts.drawCalls() / f));
+        json_object_set_new(resultJ, "fills", json_real(r.counts.fills / f));
+        json_object_set_new(resultJ, "strokes", json_real(r.counts.strokes / f));
+        json_object_set_new(resultJ, "triangles", json_real(r.counts.triangles / f));
+        json_object_set_new(resultJ, "paths", json_real(r.counts.paths / f));
+        json_object_set_new(resultJ, "vertices", json_real(r.counts.vertices / f));
+        json_object_set_new(resultJ, "stateChanges", json_real(r.counts.stateChanges / f));
+        json_array_append_new(resultsJ, resultJ);
+    }
+    json_object_set_new(rootJ, "results", resultsJ);
+    json_dumpf(rootJ, stdout, JSON_INDENT(2) | JSON_REAL_PRECISION(6));
+    std::printf("\n");
+    json_decref(rootJ);
+}
+
+int main(int argc, char* argv[]) {
+    long frames = 1000;
+    bool json = false;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--frames") && i + 1 < argc)
+            frames = std::max(1L, std::atol(argv[++i]));
+        else if (!std::strcmp(argv[i], "--format") && i + 1 < argc)
+            json = !std::strcmp(argv[++i], "json");
+        else {
+            std::fprintf(stderr, "Usage: %s [--frames N] [--format csv|json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    rack::Context* context = createHeadlessContext(DISPLAY_BENCH_SAMPLE_RATE);
+
+    // Plugin assets are loaded relative to the working directory
+    pluginInstance = new rack::plugin::Plugin;
+    pluginInstance->path = ".";
+    rack::settings::haloBrightness = 0.25f;
+    rack::settings::rackBrightness = 1.f;
+    HaloCache::direct() = true;
+
+    Recorder recorder;
+    NVGcontext* vg = createRecordingContext(&recorder);
+    if (!vg) {
+        std::fprintf(stderr, "Could not create a NanoVG context\n");
+        return 1;
+    }
+
+    AlgomorphLarge* module = new AlgomorphLarge;
+    DisplayDrawWidget* display = new DisplayDrawWidget(module);
+    display->box.size = DISPLAY_SIZE;
+    display->font = std::make_shared<rack::window::Font>();
+    display->font->loadFile(rack::asset::plugin(pluginInstance, display->fontPath), vg);
+    // Drain whatever the module queued for the display on construction
+    display->updateDisplayState();
+
+    std::vector<DisplayBenchResult> results;
+
+    // Display
+    module->configMode = false;
+    setDisplay(display, 1000, 1500, 0.25f);
+    results.push_back(runScenario("display static", vg, &recorder, frames, [&](NVGcontext* vg, long frame) {
+        drawDisplay(display, vg, 0.25f);
+    }));
+    results.push_back(runScenario("display morph sweep", vg, &recorder, frames, [&](NVGcontext* vg, long frame) {
+        drawDisplay(display, vg, (frame % 512) / 511.f);
+    }));
+    module->modeB = true;
+    display->horizontalMarks[0] = 0x5;
+    display->forcedCarriers[1] = 0x3;
+    results.push_back(runScenario("display morph sweep, marks and carriers", vg, &recorder, frames, [&](NVGcontext* vg, long frame) {
+        module->rotor.step(1.f / 60.f);
+        drawDisplay(display, vg, (frame % 512) / 511.f);
+    }));
+    module->modeB = false;
+    display->horizontalMarks[0] = 0;
+    display->forcedCarriers[1] = 0;
+
+    setDisplay(display, -1, 1500, 0.f);
+    results.push_back(runScenario("display mystery morph sweep", vg, &recorder, frames, [&](NVGcontext* vg, long frame) {
+        drawDisplay(display, vg, (frame % 512) / 511.f);
+    }));
+    module->configMode = true;
+    results.push_back(runScenario("display mystery edit", vg, &recorder, frames, [&](NVGcontext* vg, long frame) {
+        drawDisplay(display, vg, 0.f);
+    }));
+
+    // States GRAPH_DATA has no graph for, laid out on the fly: a ring of 4 into every operator modulating every other
+    module->configMode = false;
+    setDisplay(display, 0, 0, 0.f);
+    display->setLayoutGraph(0, 0x311, 0x0);
+    display->setLayoutGraph(1, 0xFFF, 0x1);
+    results.push_back(runScenario("display computed layout morph sweep", vg, &recorder, frames, [&](NVGcontext* vg, long frame) {
+        drawDisplay(display, vg, (frame % 512) / 511.f);
+    }));
+    // Every connection state, more than the layout cache holds, so each one is laid out as it is drawn
+    module->configMode = true;
+    results.push_back(runScenario("display all layouts edit", vg, &recorder, 0x1000, [&](NVGcontext* vg, long frame) {
+        display->setLayoutGraph(0, frame, 0x0);
+        drawDisplay(display, vg, 0.f);
+    }));
+
+    // Every graph once, in edit mode and morphing halfway into another graph
+    results.push_back(runScenario("display all graphs edit", vg, &recorder, NUM_GRAPHS, [&](NVGcontext* vg, long frame) {
+        display->setGraph(0, frame);
+        drawDisplay(display, vg, 0.f);
+    }));
+    module->configMode = false;
+    results.push_back(runScenario("display all graphs morph", vg, &recorder, NUM_GRAPHS, [&](NVGcontext* vg, long frame) {
+        setDisplay(display, frame, (frame * 7 + 13) % NUM_GRAPHS, 0.5f);
+        drawDisplay(display, vg, 0.5f);
+    }));
+
+    // Panel decoration: connection lines and one of each light type, as on Algomorph Advance
+    ConnectionBgWidget<>* connectionBg = new ConnectionBgWidget<>(OP_BUTTON_CENTERS, MOD_BUTTON_CENTERS, NULL);
+    connectionBg->box.pos = OP_BUTTON_CENTERS[3];
+    connectionBg->box.size = MOD_BUTTON_CENTERS[0].minus(OP_BUTTON_CENTERS[3]);
+    connectionBg->step();
+    rack::widget::Widget::DrawArgs args;
+    args.vg = vg;
+    args.clipBox = rack::math::Rect::inf();
+
+    results.push_back(runScenario("connection lines", vg, &recorder, frames, [&](NVGcontext* vg, long frame) {
+        connectionBg->w->draw(args);
+    }));
+
+    std::vector<TRingLight<DLXMultiLight>*> rings;
+    for (int i = 0; i < 4; i++) {
+        rings.push_back(createRingLightCentered<DLXMultiLight>(OP_BUTTON_CENTERS[i], NULL, 0));
+        rings.push_back(createRingLightCentered<DLXMultiLight>(MOD_BUTTON_CENTERS[i], NULL, 0));
+    }
+    std::vector<TLineLight<DLXMultiLight>*> lines;
+    for (int op = 0; op < 4; op++) {
+        for (int mod = 0; mod < 4; mod++)
+            lines.push_back(createLineLight<DLXMultiLight>(OP_BUTTON_CENTERS[op], MOD_BUTTON_CENTERS[mod], NULL, 0));
+    }
+    DLXKnobLight* knobLight = new DLXKnobLight;
+    knobLight->setSvg(loadPluginSvg("res/DonutRoundHugeBlackKnob.svg"));
+    DLXSvgBloomLight* bloomLight = new DLXSvgBloomLight;
+    bloomLight->setSvg(loadPluginSvg("res/DLX_1b_light_1.svg"));
+    bloomLight->setHaloSvg(loadPluginSvg("res/DLX_1b_light_1.svg"), 1);
+
+    for (bool lit : {false, true}) {
+        for (auto light : rings)
+            light->color = lit ? DLXPurple : nvgRGBA(0, 0, 0, 0);
+        for (auto light : lines)
+            light->color = lit ? DLXPurple : nvgRGBA(0, 0, 0, 0);
+        results.push_back(runScenario(lit ? "panel lights lit" : "panel lights unlit", vg, &recorder, frames, [&](NVGcontext* vg, long frame) {
+            for (auto light : rings) {
+                nvgSave(vg);
+                nvgTranslate(vg, light->box.pos.x, light->box.pos.y);
+                light->drawBackground(args);
+                light->drawLight(args);
+                light->drawHalo(args);
+                nvgRestore(vg);
+            }
+            for (auto light : lines) {
+                nvgSave(vg);
+                nvgTranslate(vg, light->box.pos.x, light->box.pos.y);
+                light->drawLight(args);
+                light->drawHalo(args);
+                nvgRestore(vg);
+            }
+            nvgSave(vg);
+            knobLight->drawLayer(args, 1);
+            nvgRestore(vg);
+            nvgSave(vg);
+            bloomLight->drawLayer(args, 1);
+            nvgRestore(vg);
+        }));
+    }
+
+    if (json)
+        printJson(results);
+    else
+        printCsv(results);
+
+    for (auto light : rings)
+        delete light;
+    for (auto light : lines)
+        delete light;
+    delete knobLight;
+    delete bloomLight;
+    delete connectionBg;
+    delete display;
+    delete module;
+    nvgDeleteInternal(vg);
+    delete context;
+    return 0;
+}
@@ -0,0 +1,652 @@
+// Headless offline renderer for Algomorph Advance and Algomorph Pocket, with golden-output regression checks.
+//
+// Build with `make render`, then run from the repository root:
+//      build/AlgomorphRender [--out DIR] [--update] bench/scenarios/*.json presets/Algomorph/*.vcvm
+// Each scenario is rendered faster than realtime, and every output port is written to DIR (default build/render)
+// as a 32-bit float WAV. Outputs are then compared against the golden renders named by the scenario;
+// --update overwrites the goldens instead. The exit code is nonzero if any comparison fails or a golden is missing.
+//
+// Goldens record the baseline's output, so they are only rendered from the commit a change is measured against, never
+// from the change itself. A refactor must pass against the existing goldens; --update is not a way to absorb an output
+// difference it introduces. An intended behavior change goes in a change of its own, which re-renders the goldens it
+// affects and says why.
+//
+// Scenario files are JSON:
+//  {
+//      "module": "AlgomorphLarge" | "AlgomorphSmall",
+//      "preset": "presets/Algomorph/Supermorph.vcvm",      // Optional, module data is loaded from the preset
+//      "sampleRate": 48000,
+//      "frames": 12000,
+//      "channels": 4,                                      // Polyphony of every connected input
+//      "seed": [1, 2],                                     // Optional, randomizes all three algorithms
+//      "settings": { "modeB": false, "ringMorph": false, "avgMode": true, "clickFilter": true,
+//                    "blockSize": 16,                      // Optional, Algomorph Advance only
+//                    "wideGroup": 0,                       // Optional, Algomorph Advance only, see below
+//                    "wideFrom": 240 },
+//      "params": [ { "id": 12, "value": 0.5 } ],           // Optional, raw param ids
+//      "morphSweep": [-1, 1],                              // Optional, ramps the Morph knob across the render
+//      "inputs": [ { "id": 0, "signal": "sine", "freq": 110, "amp": 5, "offset": 0 },
+//                  { "id": 4, "signal": "wav", "path": "bench/recordings/clock.wav" } ],
+//      "golden": "bench/golden/supermorph",
+//      "tolerance": 1e-5
+//  }
+// Presets (.vcvm) given alongside the scenarios are checked to save, and load back through both the compact state and
+// the legacy keys, without any change.
+//
+// Signals are "sine", "saw", "square", "noise" (deterministic) or "wav". WAV inputs loop, and their channels wrap.
+// With a block size, the render runs that many frames longer and is compared with its latency taken off, so a block
+// scenario can name the golden of its per-sample twin.
+// With a wide group, an Algomorph Wide is placed on the right and that group's operator inputs get the same signals as
+// Algomorph Advance's. Its modulator and sum outputs must then match Algomorph Advance's, WIDE_LATENCY samples later.
+// The group is routed with the state of the sample after its input, so they only match while that state holds still:
+// such a scenario keeps morph and the click filters still, and wideFrom skips the run gate opening at the start.
+
+#include "../src/AlgomorphLarge.hpp"
+#include "../src/AlgomorphSmall.hpp"
+#include "../src/AlgomorphWide.hpp"
+#include "../src/plugin.hpp"
+#include "BenchCommon.hpp"
+#include <rack.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+static constexpr int WIDE_LATENCY = 2;             // One sample each way through the expander messages
+static constexpr int WIDE_GROUP_OUTPUTS = 6;        // Modulator 1-4, carrier sum and modulator sum, as Advance's 0-5
+
+
+/// WAV I/O
+
+struct WavData {
+    int channels = 0;
+    int sampleRate = 48000;
+    std::vector<float> samples;     // Interleaved
+
+    int64_t frames() const {
+        return channels > 0 ? samples.size() / channels : 0;
+    }
+};
+
+static void writeU16(FILE* file, uint16_t v) {
+    std::fwrite(&v, sizeof(v), 1, file);
+}
+
+static void writeU32(FILE* file, uint32_t v) {
+    std::fwrite(&v, sizeof(v), 1, file);
+}
+
+static bool writeWav(const std::string& path, const WavData& wav) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    uint32_t dataSize = wav.samples.size() * sizeof(float);
+    std::fwrite("RIFF", 1, 4, file);
+    writeU32(file, 36 + dataSize);
+    std::fwrite("WAVE", 1, 4, file);
+    std::fwrite("fmt ", 1, 4, file);
+    writeU32(file, 16);
+    writeU16(file, 3);      // IEEE float
+    writeU16(file, wav.channels);
+    writeU32(file, wav.sampleRate);
+    writeU32(file, wav.sampleRate * wav.channels * sizeof(float));
+    writeU16(file, wav.channels * sizeof(float));
+    writeU16(file, 32);
+    std::fwrite("data", 1, 4, file);
+    writeU32(file, dataSize);
+    std::fwrite(wav.samples.data(), sizeof(float), wav.samples.size(), file);
+    std::fclose(file);
+    return true;
+}
+
+// Reads 32-bit float and 16-bit PCM WAVs, which covers our own renders and most recordings
+static bool readWav(const std::string& path, WavData& wav) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    char id[4];
+    uint32_t size;
+    if (std::fread(id, 1, 4, file) != 4 || std::memcmp(id, "RIFF", 4) || std::fread(&size, 4, 1, file) != 1
+        || std::fread(id, 1, 4, file) != 4 || std::memcmp(id, "WAVE", 4)) {
+        std::fclose(file);
+        return false;
+    }
+
+    uint16_t format = 0, bits = 0;
+    bool ok = false;
+    while (std::fread(id, 1, 4, file) == 4 && std::fread(&size, 4, 1, file) == 1) {
+        if (!std::memcmp(id, "fmt ", 4)) {
+            uint16_t channels;
+            uint32_t sampleRate, byteRate;
+            uint16_t blockAlign;
+            std::fread(&format, 2, 1, file);
+            std::fread(&channels, 2, 1, file);
+            std::fread(&sampleRate, 4, 1, file);
+            std::fread(&byteRate, 4, 1, file);
+            std::fread(&blockAlign, 2, 1, file);
+            std::fread(&bits, 2, 1, file);
+            std::fseek(file, size - 16 + (size & 1), SEEK_CUR);
+            wav.channels = channels;
+            wav.sampleRate = sampleRate;
+        }
+        else if (!std::memcmp(id, "data", 4)) {
+            if (format == 3 && bits == 32) {
+                wav.samples.resize(size / sizeof(float));
+                ok = std::fread(wav.samples.data(), sizeof(float), wav.samples.size(), file) == wav.samples.size();
+            }
+            else if (format == 1 && bits == 16) {
+                std::vector<int16_t> pcm(size / sizeof(int16_t));
+                ok = std::fread(pcm.data(), sizeof(int16_t), pcm.size(), file) == pcm.size();
+                wav.samples.resize(pcm.size());
+                for (size_t i = 0; i < pcm.size(); i++)
+                    wav.samples[i] = pcm[i] / 32768.f;
+            }
+            break;
+        }
+        else
+            std::fseek(file, size + (size & 1), SEEK_CUR);
+    }
+    std::fclose(file);
+    return ok && wav.channels > 0;
+}
+
+
+/// Scenarios
+
+struct SignalSource {
+    int id = 0;
+    std::string signal = "sine";
+    float freq = 110.f;
+    float amp = 5.f;
+    float offset = 0.f;
+    WavData wav;
+    uint32_t noiseState = 0x9e3779b9;
+
+    // Recorded inputs are in audio units (+/-1), so they are scaled by amp like everything else
+    float sample(int64_t frame, int c, float sampleRate) {
+        if (signal == "wav") {
+            int64_t wavFrame = frame % wav.frames();
+            return offset + amp * wav.samples[wavFrame * wav.channels + c % wav.channels];
+        }
+        if (signal == "noise") {
+            noiseState = noiseState * 1664525u + 1013904223u;
+            return offset + amp * ((noiseState >> 8) / 8388608.f - 1.f);
+        }
+        float phase = std::fmod(frame * freq / sampleRate + c / 16.f, 1.f);
+        if (signal == "saw")
+            return offset + amp * (2.f * phase - 1.f);
+        if (signal == "square")
+            return offset + amp * (phase < .5f ? 1.f : -1.f);
+        return offset + amp * sin2pi_pade_05_5_4(phase);
+    }
+};
+
+struct Scenario {
+    std::string name;
+    std::string module;
+    std::string preset;
+    float sampleRate = 48000.f;
+    int64_t frames = 48000;
+    int channels = 1;
+    bool seeded = false;
+    uint64_t seed[2] = {0, 0};
+    bool modeB = false;
+    bool ringMorph = false;
+    bool avgMode = true;
+    bool clickFilterEnabled = true;
+    int blockSize = 0;
+    int wideGroup = -1;
+    int64_t wideFrom = 0;                   // First frame compared with the wide group
+    std::vector<std::pair<int, float>> params;
+    bool morphSweep = false;
+    float morphStart = 0.f;
+    float morphEnd = 0.f;
+    std::vector<SignalSource> inputs;
+    std::string golden;
+    float tolerance = 1e-5f;
+};
+
+// Non-string values read as empty, so a malformed field fails validation instead of crashing
+static std::string stringValue(json_t* j) {
+    const char* str = json_string_value(j);
+    return str ? str : "";
+}
+
+static bool loadScenario(const std::string& path, Scenario& s) {
+    json_error_t error;
+    json_t* rootJ = json_load_file(path.c_str(), 0, &error);
+    if (!rootJ) {
+        std::fprintf(stderr, "%s:%d: %s\n", path.c_str(), error.line, error.text);
+        return false;
+    }
+
+    s.name = rack::system::getStem(path);
+    json_t* j;
+    if ((j = json_object_get(rootJ, "module")))
+        s.module = stringValue(j);
+    if ((j = json_object_get(rootJ, "preset")))
+        s.preset = stringValue(j);
+    if ((j = json_object_get(rootJ, "sampleRate")))
+        s.sampleRate = json_number_value(j);
+    if ((j = json_object_get(rootJ, "frames")))
+        s.frames = json_integer_value(j);
+    if ((j = json_object_get(rootJ, "channels")))
+        s.channels = rack::math::clamp((int) json_integer_value(j), 1, CHANNELS);
+    if ((j = json_object_get(rootJ, "seed"))) {
+        s.seeded = true;
+        s.seed[0] = json_integer_value(json_array_get(j, 0));
+        s.seed[1] = json_integer_value(json_array_get(j, 1));
+    }
+    if ((j = json_object_get(rootJ, "settings"))) {
+        json_t* v;
+        if ((v = json_object_get(j, "modeB")))
+            s.modeB = json_boolean_value(v);
+        if ((v = json_object_get(j, "ringMorph")))
+            s.ringMorph = json_boolean_value(v);
+        if ((v = json_object_get(j, "avgMode")))
+            s.avgMode = json_boolean_value(v);
+        if ((v = json_object_get(j, "clickFilter")))
+            s.clickFilterEnabled = json_boolean_value(v);
+        if ((v = json_object_get(j, "blockSize")))
+            s.blockSize = json_integer_value(v);
+        if ((v = json_object_get(j, "wideGroup")))
+            s.wideGroup = json_integer_value(v);
+        if ((v = json_object_get(j, "wideFrom")))
+            s.wideFrom = json_integer_value(v);
+    }
+    if ((j = json_object_get(rootJ, "params"))) {
+        size_t i;
+        json_t* paramJ;
+        json_array_foreach(j, i, paramJ) {
+            s.params.push_back({ (int) json_integer_value(json_object_get(paramJ, "id")),
+                                 (float) json_number_value(json_object_get(paramJ, "value")) });
+        }
+    }
+    if ((j = json_object_get(rootJ, "morphSweep"))) {
+        s.morphSweep = true;
+        s.morphStart = json_number_value(json_array_get(j, 0));
+        s.morphEnd = json_number_value(json_array_get(j, 1));
+    }
+    if ((j = json_object_get(rootJ, "inputs"))) {
+        size_t i;
+        json_t* inputJ;
+        json_array_foreach(j, i, inputJ) {
+            SignalSource source;
+            json_t* v;
+            if ((v = json_object_get(inputJ, "id")))
+                source.id = json_integer_value(v);
+            if ((v = json_object_get(inputJ, "signal")))
+                source.signal = stringValue(v);
+            if ((v = json_object_get(inputJ, "freq")))
+                source.freq = json_number_value(v);
+            if ((v = json_object_get(inputJ, "amp")))
+                source.amp = json_number_value(v);
+            if ((v = json_object_get(inputJ, "offset")))
+                source.offset = json_number_value(v);
+            if (source.signal == "wav") {
+                const char* wavPath = json_string_value(json_object_get(inputJ, "path"));
+                if (!wavPath) {
+                    std::fprintf(stderr, "%s: wav input %d has no \"path\"\n", path.c_str(), source.id);
+                    json_decref(rootJ);
+                    return false;
+                }
+                if (!readWav(wavPath, source.wav) || source.wav.frames() == 0) {
+                    std::fprintf(stderr, "%s: could not read %s\n", path.c_str(), wavPath);
+                    json_decref(rootJ);
+                    return false;
+                }
+            }
+            source.noiseState += source.id;
+            s.inputs.push_back(source);
+        }
+    }
+    if ((j = json_object_get(rootJ, "golden")))
+        s.golden = stringValue(j);
+    else
+        s.golden = "bench/golden/" + s.name;
+    if ((j = json_object_get(rootJ, "tolerance")))
+        s.tolerance = json_number_value(j);
+
+    json_decref(rootJ);
+    if (s.blockSize != 0) {
+        if (s.module != "AlgomorphLarge" || std::find(std::begin(BLOCK_SIZES), std::end(BLOCK_SIZES), s.blockSize) == std::end(BLOCK_SIZES))
+            return false;
+    }
+    // Algomorph Wide routes every sample, so it can't be lined up with a block's latency
+    if (s.wideGroup != -1) {
+        if (s.module != "AlgomorphLarge" || s.wideGroup < 0 || s.wideGroup >= WIDE_GROUPS || s.blockSize != 0
+            || s.wideFrom < 0 || s.wideFrom >= s.frames)
+            return false;
+    }
+    return s.module == "AlgomorphLarge" || s.module == "AlgomorphSmall";
+}
+
+static bool loadPreset(rack::engine::Module* module, const std::string& path) {
+    json_error_t error;
+    json_t* rootJ = json_load_file(path.c_str(), 0, &error);
+    if (!rootJ) {
+        std::fprintf(stderr, "%s:%d: %s\n", path.c_str(), error.line, error.text);
+        return false;
+    }
+    json_t* paramsJ = json_object_get(rootJ, "params");
+    if (paramsJ)
+        module->paramsFromJson(paramsJ);
+    json_t* dataJ = json_object_get(rootJ, "data");
+    if (dataJ)
+        module->dataFromJson(dataJ);
+    json_decref(rootJ);
+    return true;
+}
+
+
+/// Patch state round trip
+
+// Loads a preset and saves it, then loads that save back twice: through its compact "State" and through the legacy
+// keys alone. Both must save exactly what the first save did.
+template < typename MODULE >
+static bool checkRoundTrip(const std::string& path, std::string& failure) {
+    MODULE* module = new MODULE;
+    bool loaded = loadPreset(module, path);
+    json_t* savedJ = loaded ? module->dataToJson() : NULL;
+    delete module;
+    if (!savedJ) {
+        failure = "preset not loaded";
+        return false;
+    }
+    if (!json_is_string(json_object_get(savedJ, "State"))) {
+        failure = "no State saved";
+        json_decref(savedJ);
+        return false;
+    }
+
+    json_t* legacyJ = json_deep_copy(savedJ);
+    json_object_del(legacyJ, "State");
+    const char* routes[] = {"State", "legacy keys"};
+    json_t* loadJ[] = {savedJ, legacyJ};
+    bool ok = true;
+    for (int i = 0; i < 2 && ok; i++) {
+        module = new MODULE;
+        module->dataFromJson(loadJ[i]);
+        json_t* resavedJ = module->dataToJson();
+        delete module;
+        if (!json_equal(savedJ, resavedJ)) {
+            failure = std::string("reloaded through ") + routes[i] + ", saves differently";
+            ok = false;
+        }
+        json_decref(resavedJ);
+    }
+    json_decref(legacyJ);
+    json_decref(savedJ);
+    return ok;
+}
+
+static bool checkPresetRoundTrip(const std::string& path, std::string& failure) {
+    json_error_t error;
+    json_t* rootJ = json_load_file(path.c_str(), 0, &error);
+    if (!rootJ) {
+        failure = error.text;
+        return false;
+    }
+    std::string model = json_string_value(json_object_get(rootJ, "model")) ? json_string_value(json_object_get(rootJ, "model")) : "";
+    json_decref(rootJ);
+    if (model == modelAlgomorphLarge->slug)
+        return checkRoundTrip<AlgomorphLarge>(path, failure);
+    if (model == modelAlgomorphSmall->slug)
+        return checkRoundTrip<AlgomorphSmall>(path, failure);
+    failure = "unknown model \"" + model + "\"";
+    return false;
+}
+
+
+/// Rendering
+
+// Only Algomorph Advance has block processing, and loadScenario() rejects block sizes for the others
+static void setBlockSize(AlgomorphLarge* module, int blockSize) {
+    module->blockSize = blockSize;
+}
+
+static void setBlockSize(AlgomorphSmall* module, int blockSize) {}
+
+// Likewise Algomorph Wide
+static AlgomorphWide* attachWide(AlgomorphLarge* module) {
+    AlgomorphWide* wide = new AlgomorphWide;
+    module->model = modelAlgomorphLarge;
+    wide->model = modelAlgomorphWide;
+    placeSideBySide(module, wide);
+    return wide;
+}
+
+static AlgomorphWide* attachWide(AlgomorphSmall* module) {
+    return NULL;
+}
+
+static int wideOutputId(int group, int output) {
+    if (output < 4)
+        return AlgomorphWide::MODULATOR_OUTPUTS + group * 4 + output;
+    return (output == 4 ? AlgomorphWide::CARRIER_SUM_OUTPUTS : AlgomorphWide::MODULATOR_SUM_OUTPUTS) + group;
+}
+
+// wideRenders get the wide group's outputs, already WIDE_LATENCY samples earlier
+template < typename MODULE >
+static bool render(Scenario& s, std::vector<WavData>& renders, std::vector<WavData>& wideRenders, double& seconds) {
+    MODULE* module = new MODULE;
+
+    if (!s.preset.empty() && !loadPreset(module, s.preset)) {
+        delete module;
+        return false;
+    }
+    module->modeB = s.modeB;
+    module->ringMorph = s.ringMorph;
+    module->avgMode = s.avgMode;
+    module->clickFilterEnabled = s.clickFilterEnabled;
+    setBlockSize(module, s.blockSize);
+    if (s.seeded) {
+        seedRandom(s.seed[0], s.seed[1]);
+        for (int scene = 0; scene < 3; scene++)
+            module->randomizeAlgorithm(scene);
+        module->graphDirty = true;
+    }
+    for (const std::pair<int, float>& p : s.params)
+        module->params[p.first].setValue(p.second);
+
+    // Port::setChannels() is ignored on unconnected ports, so patch them the way the engine does when a cable is added
+    for (SignalSource& source : s.inputs)
+        module->inputs[source.id].channels = s.channels;
+    for (int output = 0; output < MODULE::NUM_OUTPUTS; output++)
+        module->outputs[output].channels = 1;
+
+    renders.assign(MODULE::NUM_OUTPUTS, WavData());
+    for (WavData& wav : renders) {
+        wav.channels = s.channels;
+        wav.sampleRate = s.sampleRate;
+        wav.samples.assign(s.frames * s.channels, 0.f);
+    }
+
+    AlgomorphWide* wide = s.wideGroup >= 0 ? attachWide(module) : NULL;
+    int wideLatency = wide ? WIDE_LATENCY : 0;
+    if (wide) {
+        for (SignalSource& source : s.inputs) {
+            int op = source.id - MODULE::OPERATOR_INPUTS;
+            if (op >= 0 && op < 4)
+                wide->inputs[AlgomorphWide::OPERATOR_INPUTS + s.wideGroup * 4 + op].channels = s.channels;
+        }
+        for (int output = 0; output < AlgomorphWide::NUM_OUTPUTS; output++)
+            wide->outputs[output].channels = 1;
+        wideRenders.assign(WIDE_GROUP_OUTPUTS, renders[0]);
+    }
+
+    rack::engine::Module::ProcessArgs args;
+    args.sampleRate = s.sampleRate;
+    args.sampleTime = 1.f / s.sampleRate;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t frame = 0; frame < s.frames + s.blockSize + wideLatency; frame++) {
+        if (s.morphSweep)
+            module->params[MODULE::MORPH_KNOB].setValue(rack::math::crossfade(s.morphStart, s.morphEnd, (float) frame / s.frames));
+        for (SignalSource& source : s.inputs) {
+            for (int c = 0; c < s.channels; c++)
+                module->inputs[source.id].setVoltage(source.sample(frame, c, s.sampleRate), c);
+            // The same voltages, so noise isn't drawn twice
+            int op = source.id - MODULE::OPERATOR_INPUTS;
+            if (wide && op >= 0 && op < 4)
+                wide->inputs[AlgomorphWide::OPERATOR_INPUTS + s.wideGroup * 4 + op].writeVoltages(module->inputs[source.id].getVoltages());
+        }
+        args.frame = frame;
+        module->process(args);
+        if (wide) {
+            wide->process(args);
+            flipExpanderMessages(module);
+            flipExpanderMessages(wide);
+            int64_t wideFrame = frame - wideLatency;
+            for (int output = 0; wideFrame >= 0 && output < WIDE_GROUP_OUTPUTS; output++) {
+                for (int c = 0; c < s.channels; c++)
+                    wideRenders[output].samples[wideFrame * s.channels + c] = wide->outputs[wideOutputId(s.wideGroup, output)].getVoltage(c);
+            }
+        }
+        int64_t outFrame = frame - s.blockSize;
+        if (outFrame < 0 || outFrame >= s.frames)
+            continue;
+        for (int output = 0; output < MODULE::NUM_OUTPUTS; output++) {
+            for (int c = 0; c < s.channels; c++)
+                renders[output].samples[outFrame * s.channels + c] = module->outputs[output].getVoltage(c);
+        }
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    delete wide;
+    delete module;
+    return true;
+}
+
+static std::string outputFileName(const Scenario& s, int output) {
+    return s.name + "_out" + std::to_string(output) + ".wav";
+}
+
+// Returns the largest absolute difference, or INFINITY if the shapes differ
+static float compareWav(const WavData& a, const WavData& b, int64_t& worstFrame) {
+    worstFrame = -1;
+    if (a.channels != b.channels || a.samples.size() != b.samples.size())
+        return INFINITY;
+    float worst = 0.f;
+    for (size_t i = 0; i < a.samples.size(); i++) {
+        float diff = std::fabs(a.samples[i] - b.samples[i]);
+        if (!(diff <= worst)) {
+            worst = diff;
+            worstFrame = i / a.channels;
+        }
+    }
+    return worst;
+}
+
+int main(int argc, char* argv[]) {
+    std::string outDir = "build/render";
+    bool update = false;
+    std::vector<std::string> scenarioPaths;
+    std::vector<std::string> presetPaths;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--out") && i + 1 < argc)
+            outDir = argv[++i];
+        else if (!std::strcmp(argv[i], "--update"))
+            update = true;
+        else if (rack::string::endsWith(argv[i], ".vcvm"))
+            presetPaths.push_back(argv[i]);
+        else if (argv[i][0] != '-')
+            scenarioPaths.push_back(argv[i]);
+        else {
+            std::fprintf(stderr, "Usage: %s [--out DIR] [--update] SCENARIO.json... [PRESET.vcvm...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (scenarioPaths.empty() && presetPaths.empty()) {
+        std::fprintf(stderr, "Usage: %s [--out DIR] [--update] SCENARIO.json... [PRESET.vcvm...]\n", argv[0]);
+        return 1;
+    }
+
+    rack::Context* context = createHeadlessContext(48000.f);
+    rack::system::createDirectories(outDir);
+
+    int failures = 0;
+    for (const std::string& path : scenarioPaths) {
+        Scenario s;
+        if (!loadScenario(path, s)) {
+            std::printf("%s: ERROR (invalid scenario)\n", path.c_str());
+            failures++;
+            continue;
+        }
+
+        context->engine->setSampleRate(s.sampleRate);
+        std::vector<WavData> renders;
+        std::vector<WavData> wideRenders;
+        double seconds = 0.0;
+        bool rendered = s.module == "AlgomorphLarge" ? render<AlgomorphLarge>(s, renders, wideRenders, seconds) : render<AlgomorphSmall>(s, renders, wideRenders, seconds);
+        if (!rendered) {
+            std::printf("%s: ERROR (render failed)\n", s.name.c_str());
+            failures++;
+            continue;
+        }
+        double realtime = (s.frames / s.sampleRate) / std::max(seconds, 1e-9);
+        std::printf("%s: %lld frames x %d channels in %.3f s (%.1fx realtime)\n", s.name.c_str(), (long long) s.frames, s.channels, seconds, realtime);
+
+        if (update)
+            rack::system::createDirectories(s.golden);
+        for (int output = 0; output < (int) renders.size(); output++) {
+            std::string fileName = outputFileName(s, output);
+            writeWav(rack::system::join(outDir, fileName), renders[output]);
+
+            // Goldens are named after their directory, so scenarios can share them
+            std::string goldenPath = rack::system::join(s.golden, rack::system::getFilename(s.golden) + "_out" + std::to_string(output) + ".wav");
+            if (update) {
+                writeWav(goldenPath, renders[output]);
+                std::printf("    out%d: UPDATED\n", output);
+                continue;
+            }
+            WavData golden;
+            if (!readWav(goldenPath, golden)) {
+                std::printf("    out%d: MISSING %s\n", output, goldenPath.c_str());
+                failures++;
+                continue;
+            }
+            int64_t worstFrame;
+            float worst = compareWav(renders[output], golden, worstFrame);
+            if (worst <= s.tolerance)
+                std::printf("    out%d: PASS (max diff %g)\n", output, worst);
+            else {
+                std::printf("    out%d: FAIL (max diff %g at frame %lld, tolerance %g)\n", output, worst, (long long) worstFrame, s.tolerance);
+                failures++;
+            }
+        }
+
+        // Checked against this render rather than a golden
+        for (int output = 0; output < (int) wideRenders.size(); output++) {
+            WavData settled = renders[output];
+            settled.samples.erase(settled.samples.begin(), settled.samples.begin() + s.wideFrom * s.channels);
+            wideRenders[output].samples.erase(wideRenders[output].samples.begin(), wideRenders[output].samples.begin() + s.wideFrom * s.channels);
+            int64_t worstFrame;
+            float worst = compareWav(settled, wideRenders[output], worstFrame);
+            worstFrame += s.wideFrom;
+            if (worst <= s.tolerance)
+                std::printf("    wide out%d: PASS (max diff %g)\n", output, worst);
+            else {
+                std::printf("    wide out%d: FAIL (max diff %g at frame %lld, tolerance %g)\n", output, worst, (long long) worstFrame, s.tolerance);
+                failures++;
+            }
+        }
+    }
+
+    for (const std::string& path : presetPaths) {
+        std::string failure;
+        if (checkPresetRoundTrip(path, failure))
+            std::printf("%s: round trip PASS\n", path.c_str());
+        else {
+            std::printf("%s: round trip FAIL (%s)\n", path.c_str(), failure.c_str());
+            failures++;
+        }
+    }
+
+    delete context;
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,587 @@
+// Real-time-safety checker for Algomorph Advance and Algomorph Pocket.
+//
+// Build and run with `make rtcheck` (RACK_DIR must point at a Rack SDK, as for the plugin itself), or run
+//      build/AlgomorphRtCheck [--verbose]
+// directly. Every call to process() is armed: any heap allocation, deallocation or mutex lock made from inside it
+// is reported with a backtrace, and the program exits with status 1. Setup between process() calls (mode changes,
+// randomization, undo history) runs unarmed, as it would on the UI thread.
+// Algomorph Advance is also checked in block mode, with an Algomorph Wide or Algomorph AUX beside it, leading a
+// linked follower, and switching scene bank slots by CV. The neighbouring modules' process() is armed too.
+//
+// operator new/delete are replaced on every platform. On Linux (glibc) the malloc family and pthread_mutex_lock
+// are interposed as well, which also catches C allocations and std::mutex made from inside libRack.
+
+#include "../src/AlgomorphAux.hpp"
+#include "../src/AlgomorphLarge.hpp"
+#include "../src/AlgomorphSmall.hpp"
+#include "../src/AlgomorphWide.hpp"
+#include "../src/plugin.hpp"
+#include "BenchCommon.hpp"
+#include <rack.hpp>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+    #define RTCHECK_INTERPOSE 1
+    #include <dlfcn.h>
+    #include <execinfo.h>
+    #include <malloc.h>
+    #include <pthread.h>
+    #include <unistd.h>
+#else
+    #define RTCHECK_INTERPOSE 0
+#endif
+
+
+static constexpr float RTCHECK_SAMPLE_RATE = 48000.f;
+static constexpr int RTCHECK_MAX_REPORTS = 256;
+static constexpr int RTCHECK_MAX_FRAMES = 32;
+
+// Checker state. Only `armed` is thread-local: violations on any other thread are not our concern.
+static thread_local bool armed = false;
+static thread_local bool inHook = false;
+static std::atomic<long> violations{0};
+static bool verbose = false;
+static const char* currentScenario = "";
+
+// Reported call sites, so a violation made on every sample is only printed once
+static uint64_t reportedSites[RTCHECK_MAX_REPORTS] = {0};
+static int numReportedSites = 0;
+
+static void reportViolation(const char* what, size_t size) {
+    if (!armed || inHook)
+        return;
+    inHook = true;
+    bool wasArmed = armed;
+    armed = false;
+    violations++;
+
+#if RTCHECK_INTERPOSE
+    void* frames[RTCHECK_MAX_FRAMES];
+    int numFrames = backtrace(frames, RTCHECK_MAX_FRAMES);
+    uint64_t site = 1469598103934665603ULL;
+    for (int i = 0; i < numFrames; i++)
+        site = (site ^ (uint64_t) (uintptr_t) frames[i]) * 1099511628211ULL;
+    bool known = false;
+    for (int i = 0; i < numReportedSites; i++)
+        known |= reportedSites[i] == site;
+    if (!known || verbose) {
+        if (!known && numReportedSites < RTCHECK_MAX_REPORTS)
+            reportedSites[numReportedSites++] = site;
+        std::fprintf(stderr, "\n[%s] %s (%zu bytes) in process():\n", currentScenario, what, size);
+        std::fflush(stderr);
+        // Writes straight to the fd, without allocating
+        backtrace_symbols_fd(frames, numFrames, STDERR_FILENO);
+    }
+#else
+    if (verbose || violations == 1)
+        std::fprintf(stderr, "\n[%s] %s (%zu bytes) in process()\n", currentScenario, what, size);
+#endif
+
+    armed = wasArmed;
+    inHook = false;
+}
+
+
+// Allocation hooks
+
+#if RTCHECK_INTERPOSE
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t n, size_t size);
+    void* __libc_realloc(void* p, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* p);
+
+    void* malloc(size_t size) {
+        reportViolation("malloc", size);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t n, size_t size) {
+        reportViolation("calloc", n * size);
+        return __libc_calloc(n, size);
+    }
+
+    void* realloc(void* p, size_t size) {
+        reportViolation("realloc", size);
+        return __libc_realloc(p, size);
+    }
+
+    void* memalign(size_t alignment, size_t size) {
+        reportViolation("memalign", size);
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) {
+        reportViolation("aligned_alloc", size);
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** p, size_t alignment, size_t size) {
+        reportViolation("posix_memalign", size);
+        *p = __libc_memalign(alignment, size);
+        return *p ? 0 : ENOMEM;
+    }
+
+    void free(void* p) {
+        if (p)
+            reportViolation("free", 0);
+        __libc_free(p);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex) {
+        typedef int (*LockFunction)(pthread_mutex_t*);
+        static LockFunction realLock = NULL;
+        if (!realLock) {
+            bool wasArmed = armed;
+            armed = false;
+            realLock = (LockFunction) dlsym(RTLD_NEXT, "pthread_mutex_lock");
+            armed = wasArmed;
+        }
+        reportViolation("pthread_mutex_lock", 0);
+        return realLock(mutex);
+    }
+}
+
+// The malloc hooks already see everything operator new does
+static void* checkedNew(size_t size, const char* what) {
+    (void) what;
+    return std::malloc(size ? size : 1);
+}
+
+static void checkedDelete(void* p) {
+    std::free(p);
+}
+#else
+static void* checkedNew(size_t size, const char* what) {
+    reportViolation(what, size);
+    return std::malloc(size ? size : 1);
+}
+
+static void checkedDelete(void* p) {
+    if (p)
+        reportViolation("operator delete", 0);
+    std::free(p);
+}
+#endif
+
+void* operator new(size_t size) {
+    void* p = checkedNew(size, "operator new");
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    void* p = checkedNew(size, "operator new[]");
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return checkedNew(size, "operator new");
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return checkedNew(size, "operator new[]");
+}
+
+void operator delete(void* p) noexcept { checkedDelete(p); }
+void operator delete[](void* p) noexcept { checkedDelete(p); }
+void operator delete(void* p, size_t) noexcept { checkedDelete(p); }
+void operator delete[](void* p, size_t) noexcept { checkedDelete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { checkedDelete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { checkedDelete(p); }
+
+
+// Driving the modules
+
+struct RtSignal {
+    float freq = 0.f;           // 0 for a constant
+    float amp = 0.f;
+    float offset = 0.f;
+    bool pulse = false;         // Square between offset and offset + amp, for clock/reset/run inputs
+};
+
+// Port::setChannels() is ignored on unconnected ports, so patch them the way the engine does when a cable is added
+template < typename MODULE >
+static void connect(MODULE* module, int inputId, int channels) {
+    module->inputs[inputId].channels = channels;
+}
+
+template < typename MODULE >
+static void connectOutputs(MODULE* module) {
+    for (int i = 0; i < MODULE::NUM_OUTPUTS; i++)
+        module->outputs[i].channels = 1;
+}
+
+static float signalValue(const RtSignal& s, int64_t frame, int c) {
+    if (s.freq <= 0.f)
+        return s.offset;
+    float phase = std::fmod((frame + 31 * c) * s.freq / RTCHECK_SAMPLE_RATE, 1.f);
+    if (s.pulse)
+        return s.offset + (phase < .5f ? s.amp : 0.f);
+    return s.offset + s.amp * sin2pi_pade_05_5_4(phase);
+}
+
+struct RtInputSignal {
+    rack::engine::Module* module;
+    int inputId;
+    RtSignal signal;
+};
+
+template < typename MODULE >
+struct RtDriver {
+    MODULE* module;
+    std::vector<rack::engine::Module*> rackModules;     // Processed in this order every frame, the module first
+    int64_t frame = 0;
+    std::vector<RtInputSignal> signals;
+
+    RtDriver(MODULE* module) {
+        this->module = module;
+        connectOutputs(module);
+        rackModules.push_back(module);
+    }
+
+    // A neighbour of the checked module. Place them side by side first
+    void add(rack::engine::Module* other) {
+        for (rack::engine::Output& output : other->outputs)
+            output.channels = 1;
+        rackModules.push_back(other);
+    }
+
+    void setSignal(rack::engine::Module* target, int inputId, const RtSignal& s) {
+        for (RtInputSignal& p : signals) {
+            if (p.module == target && p.inputId == inputId) {
+                p.signal = s;
+                return;
+            }
+        }
+        signals.push_back({target, inputId, s});
+    }
+
+    void setSignal(int inputId, const RtSignal& s) {
+        setSignal(module, inputId, s);
+    }
+
+    void run(int64_t frames) {
+        rack::engine::Module::ProcessArgs args;
+        args.sampleRate = RTCHECK_SAMPLE_RATE;
+        args.sampleTime = 1.f / RTCHECK_SAMPLE_RATE;
+        for (int64_t i = 0; i < frames; i++, frame++) {
+            for (const RtInputSignal& p : signals) {
+                rack::engine::Input& input = p.module->inputs[p.inputId];
+                for (int c = 0; c < input.getChannels(); c++)
+                    input.setVoltage(signalValue(p.signal, frame, c), c);
+            }
+            args.frame = frame;
+            // Pretend the panel is on screen, so the light and display paths are checked too
+            module->drawn = true;
+            armed = true;
+            for (rack::engine::Module* m : rackModules)
+                m->process(args);
+            armed = false;
+            for (rack::engine::Module* m : rackModules)
+                flipExpanderMessages(m);
+        }
+        // The undo history is the UI thread's business, so drain it unarmed, as the module widget would
+        while (!module->historyRequests.empty())
+            module->historyRequests.shift();
+    }
+
+    // Buttons are polled at the CV rate, so hold each press long enough to be seen
+    void press(int paramId) {
+        module->params[paramId].setValue(1.f);
+        run(64);
+        module->params[paramId].setValue(0.f);
+        run(64);
+    }
+
+    void sweep(int paramId, float from, float to, int64_t frames) {
+        for (int64_t i = 0; i < frames; i += 32) {
+            module->params[paramId].setValue(from + (to - from) * i / frames);
+            run(32);
+        }
+    }
+};
+
+template < typename MODULE >
+static void setFlags(MODULE* module, int flags) {
+    module->modeB = flags & 1;
+    module->ringMorph = flags & 2;
+    module->clickFilterEnabled = flags & 4;
+    module->avgMode = flags & 8;
+    module->debug = flags & 16;
+}
+
+// Scene, edit, operator and modulator buttons: scene changes, config mode, every kind of routing toggle
+template < typename MODULE >
+static void pressButtons(RtDriver<MODULE>& d) {
+    for (int scene = 0; scene < 3; scene++)
+        d.press(MODULE::SCENE_BUTTONS + scene);
+    d.press(MODULE::SCENE_BUTTONS + 1);
+    d.press(MODULE::EDIT_BUTTON);
+    for (int op = 0; op < 4; op++) {
+        d.press(MODULE::OPERATOR_BUTTONS + op);
+        for (int mod = 0; mod < 4; mod++)
+            d.press(MODULE::MODULATOR_BUTTONS + mod);
+    }
+    d.press(MODULE::OPERATOR_BUTTONS + 0);
+    d.press(MODULE::OPERATOR_BUTTONS + 0);
+    for (int mod = 0; mod < 4; mod++)
+        d.press(MODULE::MODULATOR_BUTTONS + mod);
+    d.press(MODULE::SCENE_BUTTONS + 2);
+    d.press(MODULE::EDIT_BUTTON);
+    // Forced carrier toggles from outside config mode enter it
+    d.press(MODULE::MODULATOR_BUTTONS + 3);
+    d.press(MODULE::EDIT_BUTTON);
+    d.press(MODULE::SCREEN_BUTTON);
+}
+
+// What sits around Algomorph Advance
+enum RtSetups {
+    ALONE,
+    BLOCK,              // Block mode, with a block size picked by the flags
+    WIDE,               // An Algomorph Wide on the right, with every voice group patched
+    AUX_LANES,          // An Algomorph AUX on the left, its lanes switching modes as process() runs
+    LEADER,             // A linked follower on the right
+    BANK_SLOT,          // A scene bank, switched by the bank slot CV
+    NUM_RT_SETUPS
+};
+
+static const char* RtSetupNames[NUM_RT_SETUPS] = {"alone", "block", "wide", "aux lanes", "leader", "bank slot"};
+
+// A scene bank in memory, so the check never opens the user's bank file. Every third slot is empty
+static BankSlot rtBank[BANK_SLOTS];
+
+static void fillBank(AlgomorphLarge* module) {
+    for (int slot = 0; slot < BANK_SLOTS; slot++) {
+        rtBank[slot] = BankSlot();
+        if (slot % 3 == 0)
+            continue;
+        for (int scene = 0; scene < 3; scene++) {
+            rtBank[slot].algoName[scene] = (module->algoName[scene].to_ulong() + slot * 0x9e37) & 0xFFF;
+            rtBank[slot].horizontalMarks[scene] = (slot >> scene) & 0xF;
+            rtBank[slot].forcedCarriers[scene] = (slot >> (scene + 4)) & 0xF;
+        }
+        rtBank[slot].flags = BankSlot::WRITTEN | (slot & 8 ? BankSlot::MODE_B : 0) | (slot & 16 ? BankSlot::RING_MORPH : 0);
+    }
+}
+
+static void checkLarge(int channels, int flags, int setup) {
+    AlgomorphLarge* module = new AlgomorphLarge;
+    module->model = modelAlgomorphLarge;
+    seedRandom(0x416c676f, 0x6d6f7270 + flags);
+    for (int scene = 0; scene < 3; scene++)
+        module->randomizeAlgorithm(scene);
+    setFlags(module, flags);
+    module->graphDirty = true;
+
+    RtDriver<AlgomorphLarge> d(module);
+    for (int i = 0; i < 4; i++) {
+        connect(module, AlgomorphLarge::OPERATOR_INPUTS + i, channels);
+        d.setSignal(AlgomorphLarge::OPERATOR_INPUTS + i, {110.f * (i + 1), 5.f, 0.f, false});
+    }
+
+    AlgomorphWide* wide = NULL;
+    AlgomorphAux* aux = NULL;
+    AlgomorphLarge* follower = NULL;
+    if (setup == BLOCK)
+        module->blockSize = BLOCK_SIZES[1 + flags % 4];
+    else if (setup == WIDE) {
+        wide = new AlgomorphWide;
+        wide->model = modelAlgomorphWide;
+        placeSideBySide(module, wide);
+        d.add(wide);
+        for (int i = 0; i < WIDE_GROUPS * 4; i++) {
+            connect(wide, AlgomorphWide::OPERATOR_INPUTS + i, channels);
+            d.setSignal(wide, AlgomorphWide::OPERATOR_INPUTS + i, {55.f * (i + 1), 5.f, 0.f, false});
+        }
+    }
+    else if (setup == AUX_LANES) {
+        aux = new AlgomorphAux;
+        aux->model = modelAlgomorphAux;
+        placeSideBySide(aux, module);
+        d.add(aux);
+        for (int lane = 0; lane < NUM_AUX_LANES; lane++) {
+            aux->laneMode[lane] = lane;
+            connect(aux, AlgomorphAux::AUX_INPUTS + lane, lane % 2 ? channels : 1);
+            d.setSignal(aux, AlgomorphAux::AUX_INPUTS + lane, {3.f * (lane + 1), 5.f, 0.f, lane < 3});
+        }
+    }
+    else if (setup == LEADER) {
+        follower = new AlgomorphLarge;
+        follower->model = modelAlgomorphLarge;
+        follower->followLeader = true;
+        setFlags(follower, flags);
+        placeSideBySide(module, follower);
+        d.add(follower);
+        for (int i = 0; i < 4; i++) {
+            connect(follower, AlgomorphLarge::OPERATOR_INPUTS + i, channels);
+            d.setSignal(follower, AlgomorphLarge::OPERATOR_INPUTS + i, {165.f * (i + 1), 5.f, 0.f, false});
+        }
+    }
+    else if (setup == BANK_SLOT) {
+        fillBank(module);
+        sceneBank.slots = rtBank;
+        module->bankSlot = BANK_SLOTS / 2;
+    }
+
+    d.sweep(AlgomorphLarge::MORPH_KNOB, -1.f, 1.f, 4096);
+    pressButtons(d);
+
+    // Every aux mode on every aux input, with a pulse that clocks, resets and gates, then unplugged again
+    for (int auxIndex = 0; auxIndex < AlgomorphLarge::NUM_AUX_INPUTS; auxIndex++) {
+        for (int mode = 0; mode < AuxInputModes::NUM_MODES; mode++) {
+            module->auxInput[auxIndex]->clearAuxModes();
+            module->auxInput[auxIndex]->setMode(mode);
+            connect(module, AlgomorphLarge::AUX_INPUTS + auxIndex, channels);
+            d.setSignal(AlgomorphLarge::AUX_INPUTS + auxIndex, {60.f, 10.f, -2.f, true});
+            d.run(2048);
+            d.setSignal(AlgomorphLarge::AUX_INPUTS + auxIndex, {0.7f, 5.f, 0.f, false});
+            d.run(1024);
+            connect(module, AlgomorphLarge::AUX_INPUTS + auxIndex, 0);
+            d.run(256);
+        }
+        module->auxInput[auxIndex]->clearAuxModes();
+    }
+
+    // Several modes stacked on one input
+    module->auxInput[0]->allowMultipleModes = true;
+    module->auxInput[0]->setMode(AuxInputModes::TRIPLE_MORPH);
+    module->auxInput[0]->setMode(AuxInputModes::CLOCK);
+    module->auxInput[0]->setMode(AuxInputModes::WILDCARD_SUM);
+    connect(module, AlgomorphLarge::AUX_INPUTS + 0, channels);
+    d.setSignal(AlgomorphLarge::AUX_INPUTS + 0, {40.f, 8.f, -4.f, true});
+    d.run(4096);
+    connect(module, AlgomorphLarge::AUX_INPUTS + 0, 0);
+
+    // Endless morph knob, wrapping through every scene several times
+    module->knobMode = AuxKnobModes::ENDLESS_MORPH;
+    d.sweep(AlgomorphLarge::AUX_KNOBS + AuxKnobModes::ENDLESS_MORPH, 0.f, 20.f, 8192);
+    d.sweep(AlgomorphLarge::AUX_KNOBS + AuxKnobModes::ENDLESS_MORPH, 20.f, -20.f, 8192);
+
+    if (aux) {
+        // The lanes' modes are set and unset by process() itself, every one on every lane, then all unassigned
+        aux->compensate = true;
+        for (int mode = 0; mode < AuxInputModes::NUM_MODES; mode++) {
+            for (int lane = 0; lane < NUM_AUX_LANES; lane++)
+                aux->laneMode[lane] = (mode + lane) % AuxInputModes::NUM_MODES;
+            d.run(1024);
+        }
+        for (int lane = 0; lane < NUM_AUX_LANES; lane++)
+            aux->laneMode[lane] = -1;
+        d.run(256);
+    }
+    if (setup == BANK_SLOT) {
+        // A slow sweep through filled and empty slots, then back to the patch's own scenes
+        module->auxInput[0]->clearAuxModes();
+        module->auxInput[0]->setMode(AuxInputModes::BANK_SLOT);
+        connect(module, AlgomorphLarge::AUX_INPUTS + 0, channels);
+        d.setSignal(AlgomorphLarge::AUX_INPUTS + 0, {2.f, 5.f, 0.f, false});
+        d.run(16384);
+        connect(module, AlgomorphLarge::AUX_INPUTS + 0, 0);
+        d.run(256);
+        module->auxInput[0]->clearAuxModes();
+    }
+
+    // Randomization happens on the UI thread; only what follows is checked
+    module->randomizeAlgorithm(1);
+    module->graphDirty = true;
+    pressButtons(d);
+
+    sceneBank.slots = NULL;
+    delete wide;
+    delete aux;
+    delete follower;
+    delete module;
+}
+
+static void checkSmall(int channels, int flags) {
+    AlgomorphSmall* module = new AlgomorphSmall;
+    seedRandom(0x416c676f, 0x6d6f7270 + flags);
+    for (int scene = 0; scene < 3; scene++)
+        module->randomizeAlgorithm(scene);
+    setFlags(module, flags);
+    module->graphDirty = true;
+
+    RtDriver<AlgomorphSmall> d(module);
+    for (int i = 0; i < 4; i++) {
+        connect(module, AlgomorphSmall::OPERATOR_INPUTS + i, channels);
+        d.setSignal(AlgomorphSmall::OPERATOR_INPUTS + i, {110.f * (i + 1), 5.f, 0.f, false});
+    }
+
+    d.sweep(AlgomorphSmall::MORPH_KNOB, -1.f, 1.f, 4096);
+    pressButtons(d);
+
+    connect(module, AlgomorphSmall::WILDCARD_INPUT, channels);
+    d.setSignal(AlgomorphSmall::WILDCARD_INPUT, {220.f, 5.f, 0.f, false});
+    for (int i = 0; i < 2; i++) {
+        connect(module, AlgomorphSmall::MORPH_INPUTS + i, channels);
+        d.setSignal(AlgomorphSmall::MORPH_INPUTS + i, {0.5f + i, 5.f, 0.f, false});
+    }
+    module->params[AlgomorphSmall::MORPH_ATTEN_KNOB].setValue(3.f);
+    d.run(8192);
+    for (int i = 0; i < 2; i++)
+        connect(module, AlgomorphSmall::MORPH_INPUTS + i, 0);
+    connect(module, AlgomorphSmall::WILDCARD_INPUT, 0);
+    d.run(256);
+
+    module->randomizeAlgorithm(1);
+    module->graphDirty = true;
+    pressButtons(d);
+
+    delete module;
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--verbose"))
+            verbose = true;
+        else {
+            std::fprintf(stderr, "Usage: %s [--verbose]\n", argv[0]);
+            return 1;
+        }
+    }
+
+#if RTCHECK_INTERPOSE
+    // backtrace() loads libgcc on first use, which allocates
+    void* warm[1];
+    backtrace(warm, 1);
+#endif
+
+    rack::Context* context = createHeadlessContext(RTCHECK_SAMPLE_RATE);
+
+    int runs = 0;
+    for (int channels : {1, 16}) {
+        for (int flags = 0; flags < 32; flags++) {
+            for (int setup = 0; setup < NUM_RT_SETUPS; setup++) {
+                // The debug timing is the same beside other modules, so only the module alone checks it
+                if (setup != ALONE && (flags & 16))
+                    continue;
+                std::string name = rack::string::f("AlgomorphLarge %s ch=%d flags=%d", RtSetupNames[setup], channels, flags);
+                currentScenario = name.c_str();
+                checkLarge(channels, flags, setup);
+                runs++;
+            }
+
+            std::string name = rack::string::f("AlgomorphSmall ch=%d flags=%d", channels, flags);
+            currentScenario = name.c_str();
+            checkSmall(channels, flags);
+            runs++;
+        }
+    }
+
+    std::printf("%d runs, %ld real-time violations at %d call sites\n", runs, violations.load(), numReportedSites);
+
+    delete context;
+    return violations > 0 ? 1 : 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <rack.hpp>
+#include <utility>
+
+
+// Sets up the part of the APP surface that Algomorph's process() touches: an Engine for the sample rate,
+// and a history::State for button-driven undo actions. No window, no widgets, no plugin loading.
+inline rack::Context* createHeadlessContext(float sampleRate) {
+    rack::random::init();
+    rack::Context* context = new rack::Context;
+    rack::contextSet(context);
+    context->engine = new rack::engine::Engine;
+    context->engine->setSampleRate(sampleRate);
+    context->history = new rack::history::State;
+    return context;
+}
+
+// Seeds Rack's thread-local generator, so algorithm randomization is repeatable between runs
+inline void seedRandom(uint64_t s0, uint64_t s1) {
+    rack::random::local().seed(s0, s1);
+}
+
+// Places two modules side by side, as the engine does when they touch. A module made with new has no model, and
+// expanders check their neighbour's, so set each module's model first.
+inline void placeSideBySide(rack::engine::Module* left, rack::engine::Module* right) {
+    left->rightExpander.module = right;
+    left->rightExpander.moduleId = right->id;
+    right->leftExpander.module = left;
+    right->leftExpander.moduleId = left->id;
+}
+
+// The engine's flip at the end of a frame, once every module has been processed
+inline void flipExpanderMessages(rack::engine::Module* module) {
+    for (rack::engine::Module::Expander* expander : {&module->leftExpander, &module->rightExpander}) {
+        if (expander->messageFlipRequested) {
+            std::swap(expander->producerMessage, expander->consumerMessage);
+            expander->messageFlipRequested = false;
+        }
+    }
+}
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+# Writes Rack-ready copies of the Inkscape panel sources in res-src/ to res/.
+# Rack parses panels with NanoSVG, which skips editor data, clip paths, <use> and everything in <defs> but gradients.
+# Dropping those, hidden layers and unreferenced ids, and merging runs of plain stroked paths into one path, leaves the
+# panel as Rack draws it while giving it far less to parse. Edit the sources, then run `make panels`.
+
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+PANELS = ["AlgomorphLarge", "AlgomorphLarge_ModuleBrowser", "AlgomorphSmall"]
+
+SVG = "http://www.w3.org/2000/svg"
+XLINK = "http://www.w3.org/1999/xlink"
+EDITOR_NAMESPACES = (
+    "http://www.inkscape.org/namespaces/inkscape",
+    "http://sodipodi.sourceforge.net/DTD/sodipodi-0.dtd",
+    "http://www.w3.org/1999/02/22-rdf-syntax-ns#",
+    "http://creativecommons.org/ns#",
+    "http://purl.org/dc/elements/1.1/",
+)
+DROPPED_TAGS = {"metadata", "title", "desc", "use", "text", "flowRoot"}
+DROPPED_ATTRIBUTES = {"clip-path", "mask", "aria-label", "{http://www.w3.org/XML/1998/namespace}space"}
+DEFS_KEPT_TAGS = {"linearGradient", "radialGradient"}
+
+ET.register_namespace("", SVG)
+ET.register_namespace("xlink", XLINK)
+
+
+def namespace(tag):
+    return tag[1:].split("}")[0] if tag.startswith("{") else ""
+
+
+def local(tag):
+    return tag.split("}")[-1]
+
+
+def style_of(e):
+    style = {}
+    for declaration in e.get("style", "").split(";"):
+        if ":" in declaration:
+            key, value = declaration.split(":", 1)
+            style[key.strip()] = value.strip()
+    return style
+
+
+def hidden(e):
+    return e.get("display") == "none" or style_of(e).get("display") == "none"
+
+
+def prune(e):
+    for child in list(e):
+        tag = local(child.tag)
+        if (namespace(child.tag) in EDITOR_NAMESPACES or tag in DROPPED_TAGS or hidden(child)
+                or (local(e.tag) == "defs" and tag not in DEFS_KEPT_TAGS)):
+            e.remove(child)
+        else:
+            prune(child)
+    for key in list(e.attrib):
+        if namespace(key) in EDITOR_NAMESPACES or key in DROPPED_ATTRIBUTES:
+            del e.attrib[key]
+
+
+def referenced_ids(root):
+    ids = set()
+    for e in root.iter():
+        for key, value in e.attrib.items():
+            ids.update(re.findall(r"url\(#([^)]+)\)", value))
+            if local(key) == "href" and value.startswith("#"):
+                ids.add(value[1:])
+    return ids
+
+
+def strip_ids(root):
+    ids = referenced_ids(root)
+    for e in root.iter():
+        if e is not root and "id" in e.attrib and e.get("id") not in ids:
+            del e.attrib["id"]
+    for defs in root.iter("{%s}defs" % SVG):
+        for gradient in list(defs):
+            if "id" not in gradient.attrib:
+                defs.remove(gradient)
+
+
+NUMBER = r"[-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?"
+
+
+# A path's leading relative moveto is absolute, and so are its coordinates once it follows another path's data
+def absolute_start(d):
+    match = re.match(r"\s*m\s*(%s)[\s,]*(%s)[\s,]*(.*)$" % (NUMBER, NUMBER), d, re.S)
+    if not match:
+        return d
+    x, y, rest = match.groups()
+    if re.match(NUMBER, rest):
+        rest = "l " + rest
+    return ("M %s,%s %s" % (x, y, rest)).rstrip()
+
+
+# Separate stroked paths draw the same as one path of their subpaths as long as nothing is filled, nothing is
+# translucent and no gradient depends on the bounds, so runs of identical siblings like that become one path
+def mergeable(e):
+    if local(e.tag) != "path" or "id" in e.attrib:
+        return False
+    style = style_of(e)
+    fill = e.get("fill", style.get("fill"))
+    stroke = e.get("stroke", style.get("stroke", "none"))
+    for key in ("opacity", "stroke-opacity"):
+        value = e.get(key, style.get(key, "1"))
+        if float(value) != 1.0:
+            return False
+    return fill == "none" and stroke != "none" and not stroke.startswith("url(")
+
+
+def merge_paths(e):
+    merged = []
+    for child in list(e):
+        merge_paths(child)
+        if merged and mergeable(child) and mergeable(merged[-1]):
+            previous = merged[-1]
+            if {k: v for k, v in previous.attrib.items() if k != "d"} == {k: v for k, v in child.attrib.items() if k != "d"}:
+                previous.set("d", previous.get("d") + " " + absolute_start(child.get("d")))
+                e.remove(child)
+                continue
+        merged.append(child)
+
+
+def strip_whitespace(e):
+    e.text = None if e.text is None or not e.text.strip() else e.text
+    e.tail = None
+    for child in e:
+        strip_whitespace(child)
+
+
+def simplify(source, destination):
+    tree = ET.parse(source)
+    root = tree.getroot()
+    prune(root)
+    strip_ids(root)
+    merge_paths(root)
+    strip_whitespace(root)
+    tree.write(destination, encoding="UTF-8", xml_declaration=True)
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    res = os.path.join(here, os.pardir, "res")
+    for name in PANELS:
+        source = os.path.join(here, name + ".svg")
+        destination = os.path.join(res, name + ".svg")
+        simplify(source, destination)
+        print("%s: %d -> %d bytes" % (name, os.path.getsize(source), os.path.getsize(destination)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
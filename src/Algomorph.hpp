@@ -1,13 +1,43 @@
 #pragma once
 #include "Components.hpp" // For RingIndicatorRotor
+#include "DebugStats.hpp"
+#include "LightEngine.hpp"
+#include "TelemetryRecorder.hpp"
+#include "VuMeter.hpp"
 #include "plugin.hpp" // For constants
+#include <atomic>
 #include <bitset>
+#include <cstdint>
 #include <rack.hpp>
 using rack::event::Action;
 using rack::history::ModuleAction;
 using rack::ui::Menu;
 
 
+// An undo step raised by a button press in process(). process() must not allocate, so it queues one of these
+// and the module widget creates and pushes the actual history action on the UI thread.
+struct HistoryRequest {
+    static const int SCENE_CHANGE = 0;
+    static const int HORIZONTAL = 1;
+    static const int DIAGONAL = 2;
+    static const int FORCED_CARRIER = 3;
+
+    int type = SCENE_CHANGE;
+    int scene = 0;
+    int op = 0;
+    int mod = 0;
+    int oldScene = 0;
+    int newScene = 0;
+};
+
+// A packed scene from an undo or redo. The routing bitsets are only written by process(), so the history action
+// queues one of these for each scene it changes, and process() stores it.
+struct SceneRequest {
+    int scene = 0;
+    uint64_t expected = 0;          // The scene as the action expects to find it
+    uint64_t packed = 0;            // The scene it leaves
+};
+
 template < int OPS = 4, int SCENES = 3 >
 struct Algomorph : rack::engine::Module {
     float morph[CHANNELS] = {0.f};                                      // Range -1.f -> 1.f
@@ -15,13 +45,20 @@ struct Algomorph : rack::engine::Module {
     rack::dsp::RingBuffer<float, 4> displayMorph;
 
     int modulators[SCENES] = {0};                                       // Number of connected modulators for each scene
+    int carrierCount[SCENES] = {0};                                     // carriers[scene].count(), kept by updateSceneCounts()
+    float modulatorReciprocal[SCENES] = {0.f};                          // 1 / modulators[scene], 0 without modulators
     float totalCarSumConnection[CHANNELS] = {0.f};                      // Total of all fractional connections to the carrier sum output (0..4)
+    float carSumNorm[CHANNELS] = {0.f};                                 // Average mode factors, set by updateSumNorms(). The carrier sum
+    float modSumNorm[CHANNELS] = {0.f};                                 // is further divided by totalCarSumConnection
     int channels = 1;                                                   // Max channels of operator inputs
 
     int baseScene = -1;                                                 // Center the Morph knob on saved algorithm 0, 1, or 2
     int centerMorphScene[CHANNELS]    = { baseScene };
     int forwardMorphScene[CHANNELS]   = { (baseScene + 1) % 3 };
     int backwardMorphScene[CHANNELS]  = { (baseScene + 2) % 3 };
+    float centerMorphWeight[CHANNELS]   = {1.f};                        // Morph as weights over the three scenes. The backward
+    float forwardMorphWeight[CHANNELS]  = {0.f};                        // weight is ring morph's share, which is subtracted, and
+    float backwardMorphWeight[CHANNELS] = {0.f};                        // 0 without ring morph
     rack::dsp::RingBuffer<int, 4> displayScene;
     rack::dsp::RingBuffer<int, 4> displayMorphScene;
 
@@ -43,23 +80,30 @@ struct Algomorph : rack::engine::Module {
     rack::dsp::BooleanTrigger editTrigger;
     rack::dsp::BooleanTrigger operatorTrigger[OPS];
     rack::dsp::BooleanTrigger modulatorTrigger[OPS];
+    rack::dsp::RingBuffer<HistoryRequest, 32> historyRequests;         // Drained by AlgomorphWidget::pushHistoryRequests()
+    rack::dsp::RingBuffer<SceneRequest, 32> sceneRequests;             // The other way, drained by processSceneRequests()
 
     // [op][mod][channel]
     rack::dsp::SlewLimiter modClickFilters[OPS][OPS][CHANNELS];
     rack::dsp::SlewLimiter modRingClickFilters[OPS][OPS][CHANNELS];
-    float modClickGain[OPS][OPS][CHANNELS] = {{{0.f}}};
+    float modClickGain[OPS][OPS][CHANNELS] = {{{0.f}}};                 // Routing gain, less the ring gain
     float modRingClickGain[OPS][OPS][CHANNELS] = {{{0.f}}};
 
     // [op][channel]
     rack::dsp::SlewLimiter sumClickFilters[OPS][CHANNELS];
     rack::dsp::SlewLimiter sumRingClickFilters[OPS][CHANNELS];
-    float sumClickGain[OPS][CHANNELS] = {{0.f}};
+    float sumClickGain[OPS][CHANNELS] = {{0.f}};                        // Routing gain, less the ring gain
     float sumRingClickGain[OPS][CHANNELS] = {{0.f}};
 
     rack::dsp::ClockDivider clickFilterDivider;
 
     rack::dsp::ClockDivider lightDivider;
-    float sceneBrightnesses[SCENES][OPS*(OPS-1)][3] = {{{}}};       // [scene][light][color]
+    LightEngine lightEngine;
+    VuMeter vuMeter;                            // Only accumulated while vuLights is set and the panel is visible
+    std::atomic<bool> drawn{false};             // Set by AlgomorphWidget::draw(), cleared on each light tick
+    float hiddenTime = VISIBILITY_TIMEOUT;
+    bool visible = false;                       // Lights and display are only updated while the panel is being drawn
+    bool panelQuiet = false;                    // Lights and display turned off, e.g. by a linked follower
     float blinkTimer = BLINK_INTERVAL;
     bool blinkStatus = true;
     RingIndicatorRotor rotor;
@@ -70,6 +114,8 @@ struct Algomorph : rack::engine::Module {
 
     bool graphDirty = true;
     bool debug = false;
+    DebugStats debugStats;                      // Only updated while debug is set
+    std::atomic<TelemetryRecorder*> telemetry{NULL};    // Allocated by getTelemetry() on first use, lives until the module is deleted
 
     int graphAddressTranslation[0xFFFF];        // Graph ID conversion
                                                 // The algorithm graph data are stored with IDs in 12-bit space:
@@ -94,10 +140,14 @@ struct Algomorph : rack::engine::Module {
     bool exitConfigOnConnect = false;
     bool glowingInk = false;
     bool vuLights = true;
+    int displayFrameRate = DEF_DISPLAY_FRAME_RATE;     // Display re-render cap, 0 is unlimited
     bool modeB = false;
     float clickFilterSlew = DEF_CLICK_FILTER_SLEW;
 
     Algomorph() {
+        pluginSettings.load();
+        backgroundWorker.acquire();
+
         for (int op = 0; op < OPS; op++) {
             for (int c = 0; c < CHANNELS; c++) {
                 sumClickFilters[op][c].setRiseFall(DEF_CLICK_FILTER_SLEW, DEF_CLICK_FILTER_SLEW);
@@ -137,6 +187,11 @@ struct Algomorph : rack::engine::Module {
         Algomorph<OPS, SCENES>::onReset();
     };
 
+    ~Algomorph() {
+        delete telemetry.load();
+        backgroundWorker.release();
+    };
+
     void onReset() override {
         configMode = false;
         configOp = -1;
@@ -166,6 +221,7 @@ struct Algomorph : rack::engine::Module {
 
         glowingInk = pluginSettings.glowingInkDefault;
         vuLights = pluginSettings.vuLightsDefault;
+        displayFrameRate = DEF_DISPLAY_FRAME_RATE;
 
         blinkStatus = true;
         blinkTimer = BLINK_INTERVAL;
@@ -176,6 +232,261 @@ struct Algomorph : rack::engine::Module {
         }
     };
 
+    void requestHistory(int type, int scene, int op, int mod = 0) {
+        HistoryRequest r;
+        r.type = type;
+        r.scene = scene;
+        r.op = op;
+        r.mod = mod;
+        if (!historyRequests.full())
+            historyRequests.push(r);
+    };
+
+    void requestSceneChangeHistory(int oldScene, int newScene) {
+        HistoryRequest r;
+        r.type = HistoryRequest::SCENE_CHANGE;
+        r.oldScene = oldScene;
+        r.newScene = newScene;
+        if (!historyRequests.full())
+            historyRequests.push(r);
+    };
+
+    // Call on each light tick. Returns whether the panel has been drawn recently, and resyncs the lights and display
+    // in one go when it comes back into view.
+    bool updateVisibility(float deltaTime) {
+        if (drawn.exchange(false))
+            hiddenTime = 0.f;
+        else if (hiddenTime < VISIBILITY_TIMEOUT)
+            hiddenTime += deltaTime;
+        bool wasVisible = visible;
+        visible = hiddenTime < VISIBILITY_TIMEOUT;
+        if (visible && !wasVisible) {
+            lightEngine.resync();
+            vuMeter.reset();
+            graphDirty = true;
+        }
+        return visible;
+    };
+
+    // Turning the panel quiet blanks lights and display once, turning it back on resyncs them like updateVisibility()
+    void setPanelQuiet(bool quiet) {
+        if (quiet == panelQuiet)
+            return;
+        panelQuiet = quiet;
+        if (quiet) {
+            for (rack::engine::Light& light : this->lights)
+                light.setBrightness(0.f);
+        }
+        else {
+            lightEngine.resync();
+            vuMeter.reset();
+        }
+        graphDirty = true;
+    };
+
+    // Call once per sample for each metered port, while vuLights is set and the panel is visible
+    void accumulateVu(rack::engine::Port& port, int source) {
+        if (port.isConnected())
+            vuMeter.accumulate(source, port.getVoltages(), port.getChannels());
+    };
+
+    // Call on each light tick. `indicatedScene` is the scene marked by the purple scene indicator.
+    void processLights(float deltaTime, int indicatedScene, float screenButton, int ringLightId) {
+        float vu[LightVuSources::NUM_SOURCES];
+        if (vuLights)
+            vuMeter.read(vu);
+        else {
+            vu[LightVuSources::NONE] = 0.f;
+            for (int i = 1; i < LightVuSources::NUM_SOURCES; i++)
+                vu[i] = 1.f;
+        }
+
+        LightState state;
+        state.configMode = configMode;
+        state.modeB = modeB;
+        state.configScene = configScene;
+        state.configOp = configOp;
+        state.blinkStatus = blinkStatus;
+        state.indicatedScene = indicatedScene;
+        state.centerScene = centerMorphScene[0];
+        state.forwardScene = forwardMorphScene[0];
+        state.screenButton = screenButton;
+        for (int scene = 0; scene < SCENES && scene < 3; scene++) {
+            state.algoName[scene] = algoName[scene].to_ulong();
+            state.horizontalMarks[scene] = horizontalMarks[scene].to_ulong();
+            state.forcedCarriers[scene] = forcedCarriers[scene].to_ulong();
+        }
+
+        if (lightEngine.setState(state)) {
+            lightEngine.clear();
+            if (configMode)
+                updateConfigLightTable(indicatedScene, screenButton);
+            else {
+                updateSceneLightTable(0, centerMorphScene[0], indicatedScene, screenButton);
+                updateSceneLightTable(1, forwardMorphScene[0], indicatedScene, screenButton);
+            }
+        }
+
+        lightEngine.process(vu, configMode ? 0.f : relativeMorphMagnitude[0], deltaTime, &this->lights[0], ringLightId);
+    };
+
+    // Display state without morph, highlight configScene
+    void updateConfigLightTable(int indicatedScene, float screenButton) {
+        LightEngine& e = lightEngine;
+        //Set yellow backlight component, purple is off
+        e.follow(0, LightSlots::DISPLAY_BACKLIGHT + 1, LightVuSources::CARRIER_SUM_OUTPUT, 1.f / 2048.f, .005f / 3.f);
+        e.set(0, LightSlots::EDIT_LIGHT, 1.f);
+        //Set yellow scene light components depending on config scene
+        for (int i = 0; i < 3; i++) {
+            e.set(0, LightSlots::SCENE_LIGHTS + i * 3 + 1, configScene == i ? 1.f : 0.f);
+            e.set(0, LightSlots::SCENE_INDICATORS + i * 3 + 1, configScene == i ? INDICATOR_BRIGHTNESS : 0.f);
+        }
+        //Set op/mod lights
+        for (int i = 0; i < 4; i++) {
+            bool selected = configOp == i;
+            float selectedYellow = selected ? blinkStatus : 0.f;
+            bool blinkedOff = selected && blinkStatus;
+            bool forced = forcedCarriers[configScene].test(i);
+            if (horizontalMarks[configScene].test(i)) {
+                if (modeB) {
+                    // In (config + alter ego) mode, when a selected operator is a forced-carrier,
+                    // the purple indicator should blink on/off whenever the yellow selection indicator blinks off/on,
+                    // regardless of whether it is horizontally marked.
+                    if (forced) {
+                        e.set(0, LightSlots::CARRIER_INDICATORS + i * 3, blinkedOff ? 0.f : INDICATOR_BRIGHTNESS);
+                        e.set(0, LightSlots::CARRIER_INDICATORS + i * 3 + 1, selectedYellow);
+                    }
+                    e.set(0, LightSlots::OPERATOR_LIGHTS + i * 3, blinkedOff ? 0.f : DEF_RED_BRIGHTNESS);
+                    e.set(0, LightSlots::OPERATOR_LIGHTS + i * 3 + 1, selectedYellow);
+                }
+                else {
+                    // In config mode, when a selected operator is both a forced-carrier and disabled,
+                    // the red indicator should blink on/off whenever the yellow selection indicator blinks off/on.
+                    if (forced) {
+                        e.set(0, LightSlots::CARRIER_INDICATORS + i * 3 + 1, selectedYellow);
+                        e.set(0, LightSlots::CARRIER_INDICATORS + i * 3 + 2, blinkedOff ? 0.f : DEF_RED_BRIGHTNESS);
+                    }
+                    e.set(0, LightSlots::OPERATOR_LIGHTS + i * 3 + 1, selectedYellow);
+                    e.set(0, LightSlots::OPERATOR_LIGHTS + i * 3 + 2, blinkedOff ? 0.f : DEF_RED_BRIGHTNESS);
+                }
+            }
+            else {
+                // In config mode, if a non-horizontal-marked operator is a forced-carrier,
+                // the purple indicator should blink on/off whenever the yellow selection indicator blinks off/on.
+                if (forced) {
+                    e.set(0, LightSlots::CARRIER_INDICATORS + i * 3, blinkedOff ? 0.f : INDICATOR_BRIGHTNESS);
+                    e.set(0, LightSlots::CARRIER_INDICATORS + i * 3 + 1, selectedYellow);
+                }
+                e.follow(0, LightSlots::OPERATOR_LIGHTS + i * 3, LightVuSources::OPERATOR_INPUTS + i, blinkedOff ? 0.f : 1.f);
+                e.set(0, LightSlots::OPERATOR_LIGHTS + i * 3 + 1, selectedYellow);
+            }
+            //Set mod lights
+            bool marked;
+            if (i != configOp)
+                marked = configOp > -1 && algoName[configScene].test(configOp * 3 + absToRel[configOp][i]);
+            else
+                marked = horizontalMarks[configScene].test(configOp);
+            bool markedOff = marked && blinkStatus && !(i == configOp && modeB);
+            e.follow(0, LightSlots::MODULATOR_LIGHTS + i * 3, LightVuSources::MODULATOR_OUTPUTS + i, markedOff ? 0.f : 1.f);
+            e.set(0, LightSlots::MODULATOR_LIGHTS + i * 3 + 1, marked ? blinkStatus : 0.f);
+        }
+        //Set connection lights
+        for (int i = 0; i < 12; i++) {
+            bool connected = algoName[configScene].test(i);
+            if (modeB)
+                e.set(0, LightSlots::CONNECTION_LIGHTS + i * 3 + 1, connected ? 0.4f : 0.f);
+            else {
+                bool disabled = horizontalMarks[configScene].test(i / 3);
+                e.set(0, LightSlots::CONNECTION_LIGHTS + i * 3 + 1, !disabled && connected ? 0.4f : 0.f);
+                //Set diagonal disable lights
+                e.set(0, LightSlots::D_DISABLE_LIGHTS + i, disabled && connected ? DEF_RED_BRIGHTNESS : 0.f);
+            }
+        }
+        //Set horizontal lights
+        for (int i = 0; i < 4; i++) {
+            if (modeB)
+                e.set(0, LightSlots::H_CONNECTION_LIGHTS + i * 3 + 1, horizontalMarks[configScene].test(i) ? 0.4f : 0.f);
+            else
+                e.set(0, LightSlots::H_CONNECTION_LIGHTS + i * 3 + 2, horizontalMarks[configScene].test(i) ? DEF_RED_BRIGHTNESS : 0.f);
+        }
+        //Set screen button ring light if pressed
+        e.set(0, LightSlots::SCREEN_BUTTON_RING_LIGHT + 1, screenButton);
+    };
+
+    // One end of the morph: `table` 0 is crossfaded into `table` 1 by relativeMorphMagnitude
+    void updateSceneLightTable(int table, int scene, int indicatedScene, float screenButton) {
+        LightEngine& e = lightEngine;
+        //Set purple backlight component, yellow is off
+        e.follow(table, LightSlots::DISPLAY_BACKLIGHT, LightVuSources::CARRIER_SUM_OUTPUT, 1.f / 1024.f, 0.0975f);
+        //Set scene lights: this scene's purple component, and the base scene indicator
+        e.set(table, LightSlots::SCENE_LIGHTS + scene * 3, 1.f);
+        e.set(table, LightSlots::SCENE_INDICATORS + indicatedScene * 3, INDICATOR_BRIGHTNESS);
+        //Set op/mod lights and carrier indicators
+        for (int i = 0; i < 4; i++) {
+            bool disabled = !modeB && horizontalMarks[scene].test(i);
+            if (disabled)
+                e.set(table, LightSlots::OPERATOR_LIGHTS + i * 3 + 2, DEF_RED_BRIGHTNESS);
+            else
+                e.follow(table, LightSlots::OPERATOR_LIGHTS + i * 3, LightVuSources::OPERATOR_INPUTS + i);
+            e.follow(table, LightSlots::MODULATOR_LIGHTS + i * 3, LightVuSources::MODULATOR_OUTPUTS + i);
+            if (forcedCarriers[scene].test(i))
+                e.set(table, LightSlots::CARRIER_INDICATORS + i * 3 + (disabled ? 2 : 0), INDICATOR_BRIGHTNESS);
+        }
+        //Set connection lights
+        if (modeB) {
+            for (int i = 0; i < 4; i++)
+                e.follow(table, LightSlots::H_CONNECTION_LIGHTS + i * 3, LightVuSources::MODULATOR_OUTPUTS + i, horizontalMarks[scene].test(i));
+            for (int i = 0; i < 12; i++)
+                e.follow(table, LightSlots::CONNECTION_LIGHTS + i * 3, LightVuSources::MODULATOR_OUTPUTS + i / 3, algoName[scene].test(i));
+        }
+        else {
+            for (int i = 0; i < 4; i++) {
+                for (int j = 0; j < 3; j++)
+                    e.follow(table, LightSlots::CONNECTION_LIGHTS + i * 9 + j * 3, LightVuSources::OPERATOR_INPUTS + i, algoName[scene].test(i * 3 + j) && !horizontalMarks[scene].test(i));
+                //Set horizontal disable lights
+                e.set(table, LightSlots::H_CONNECTION_LIGHTS + i * 3 + 2, horizontalMarks[scene].test(i) ? DEF_RED_BRIGHTNESS : 0.f);
+            }
+        }
+        //Set screen button ring light if pressed
+        e.set(table, LightSlots::SCREEN_BUTTON_RING_LIGHT, screenButton);
+    };
+
+    // UI thread. The recorder's ring is large, so it is only allocated once telemetry is used, then published to the
+    // audio thread.
+    TelemetryRecorder* getTelemetry() {
+        TelemetryRecorder* recorder = telemetry.load(std::memory_order_relaxed);
+        if (!recorder) {
+            recorder = new TelemetryRecorder;
+            telemetry.store(recorder, std::memory_order_release);
+        }
+        return recorder;
+    };
+
+    // Called at the end of process(). Copies state into the recorder's preallocated ring, never allocates.
+    void recordTelemetry(int64_t frame) {
+        TelemetryRecorder* telemetry = this->telemetry.load(std::memory_order_acquire);
+        if (!telemetry || !telemetry->shouldRecord())
+            return;
+
+        constexpr int ops = OPS < TelemetryFrame::OPS ? OPS : TelemetryFrame::OPS;
+        for (int c = 0; c < channels; c++) {
+            TelemetryFrame f;
+            f.frame = frame;
+            f.channel = c;
+            f.morph = morph[c];
+            f.relativeMorphMagnitude = relativeMorphMagnitude[c];
+            f.centerMorphScene = centerMorphScene[c];
+            f.forwardMorphScene = forwardMorphScene[c];
+            f.backwardMorphScene = backwardMorphScene[c];
+            for (int op = 0; op < ops; op++) {
+                f.sumClickGain[op] = sumClickGain[op][c];
+                for (int mod = 0; mod < ops; mod++)
+                    f.modClickGain[op][mod] = modClickGain[op][mod][c];
+            }
+            telemetry->push(f);
+        }
+    };
+
     void randomizeAlgorithm(int scene) {
         bool noCarrier = true;
         algoName[scene].reset();    //Initialize
@@ -269,76 +580,106 @@ struct Algomorph : rack::engine::Module {
             carriers[scene].set(op, !modeB);
             opsDisabled[scene].set(op, modeB);
         }
+        updateSceneCounts(scene);
         updateDisplayAlgo(scene);
         graphDirty = true;
     };
 
-    float routeHorizontal(float sampleTime, float inputVoltage, int op, int c) {
-        float connectionA = horizontalMarks[centerMorphScene[c]].test(op) * (1.f - relativeMorphMagnitude[c]);
-        float connectionB = horizontalMarks[forwardMorphScene[c]].test(op) * (relativeMorphMagnitude[c]);
-        float morphedConnection = connectionA + connectionB;
-        modClickGain[op][op][c] = clickFilterEnabled ? modClickFilters[op][op][c].process(sampleTime, morphedConnection) : morphedConnection;
-        return inputVoltage * modClickGain[op][op][c];
+    // Called once per sample before routing, after relativeMorphMagnitude and ringMorph are settled
+    void updateMorphWeights(int channels) {
+        for (int c = 0; c < channels; c++) {
+            centerMorphWeight[c] = 1.f - relativeMorphMagnitude[c];
+            forwardMorphWeight[c] = relativeMorphMagnitude[c];
+            backwardMorphWeight[c] = ringMorph ? relativeMorphMagnitude[c] : 0.f;
+        }
+    };
+
+    // Average mode: the morph-weighted share of each sum, from counts kept at edit time
+    void updateSumNorms(int channels) {
+        for (int c = 0; c < channels; c++) {
+            int center = centerMorphScene[c];
+            int forward = forwardMorphScene[c];
+            float rel = relativeMorphMagnitude[c];
+            if (carrierCount[center] > 0 && carrierCount[forward] > 0)
+                carSumNorm[c] = 1.f;
+            else if (carrierCount[center] == 0)
+                carSumNorm[c] = rel;
+            else
+                carSumNorm[c] = 1.f - rel;
+            if (modulators[center] && modulators[forward])
+                modSumNorm[c] = 1.f / rack::math::crossfade((float) modulators[center], (float) modulators[forward], rel);
+            else
+                modSumNorm[c] = rack::math::crossfade(modulatorReciprocal[center], modulatorReciprocal[forward], rel);
+        }
     };
 
-    float routeHorizontalRing(float sampleTime, float inputVoltage, int op, int c) {
-        float connection = horizontalMarks[backwardMorphScene[c]].test(op) * relativeMorphMagnitude[c];
-        modRingClickGain[op][op][c] = clickFilterEnabled ? modRingClickFilters[op][op][c].process(sampleTime, connection) : connection;
-        return -inputVoltage * modRingClickGain[op][op][c];
+    // Whether a scene connects an operator. Outside mode B, a horizontal mark takes the operator off its diagonals and
+    // the sum
+    bool horizontalConnection(int scene, int op) {
+        return horizontalMarks[scene].test(op);
     };
 
-    float routeDiagonal(float sampleTime, float inputVoltage, int op, int mod, int c) {
-        float connectionA = algoName[centerMorphScene[c]].test(op * (OPS - 1) + mod)   * (1.f - relativeMorphMagnitude[c])  * !horizontalMarks[centerMorphScene[c]].test(op);
-        float connectionB = algoName[forwardMorphScene[c]].test(op * (OPS - 1) + mod)  * relativeMorphMagnitude[c]          * !horizontalMarks[forwardMorphScene[c]].test(op);
-        float morphedConnection = connectionA + connectionB;
-        modClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, morphedConnection) : morphedConnection;
-        return inputVoltage * modClickGain[op][relToAbs[op][mod]][c];
+    bool diagonalConnection(int scene, int op, int mod) {
+        return algoName[scene].test(op * (OPS - 1) + mod) && (modeB || !horizontalMarks[scene].test(op));
     };
 
-    float routeDiagonalB(float sampleTime, float inputVoltage, int op, int mod, int c) {
-        float connectionA = algoName[centerMorphScene[c]].test(op * (OPS - 1) + mod)   * (1.f - relativeMorphMagnitude[c]);
-        float connectionB = algoName[forwardMorphScene[c]].test(op * (OPS - 1) + mod)  * relativeMorphMagnitude[c];
-        float morphedConnection = connectionA + connectionB;
-        modClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, morphedConnection) : morphedConnection;
-        return inputVoltage * modClickGain[op][relToAbs[op][mod]][c];
+    bool sumConnection(int scene, int op) {
+        return carriers[scene].test(op) && (modeB || !horizontalMarks[scene].test(op));
     };
 
-    float routeDiagonalRing(float sampleTime, float inputVoltage, int op, int mod, int c) {
-        float connection = algoName[backwardMorphScene[c]].test(op * (OPS - 1) + mod) * relativeMorphMagnitude[c] * !horizontalMarks[backwardMorphScene[c]].test(op);
-        modRingClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modRingClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, connection) : connection; 
-        return -inputVoltage * modRingClickGain[op][relToAbs[op][mod]][c];
+    // Gain targets of each connection, before the click filters: the morph from the center to the forward scene, and
+    // the backward scene's share that ring morph subtracts. Shared by every routing path
+    float horizontalTarget(int op, int c) {
+        return  horizontalConnection(centerMorphScene[c], op)     * centerMorphWeight[c]
+            +   horizontalConnection(forwardMorphScene[c], op)    * forwardMorphWeight[c];
     };
 
-    float routeDiagonalRingB(float sampleTime, float inputVoltage, int op, int mod, int c) {
-        float connection = algoName[backwardMorphScene[c]].test(op * (OPS - 1) + mod) * relativeMorphMagnitude[c];
-        modRingClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modRingClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, connection) : connection; 
-        return -inputVoltage * modRingClickGain[op][relToAbs[op][mod]][c];
+    float horizontalRingTarget(int op, int c) {
+        return horizontalConnection(backwardMorphScene[c], op) * backwardMorphWeight[c];
     };
 
-    float routeSum(float sampleTime, float inputVoltage, int op, int c) {
-        float connection    =   carriers[centerMorphScene[c]].test(op)     * (1.f - relativeMorphMagnitude[c])  * !horizontalMarks[centerMorphScene[c]].test(op)
-                            +   carriers[forwardMorphScene[c]].test(op)    * relativeMorphMagnitude[c]          * !horizontalMarks[forwardMorphScene[c]].test(op);
-        sumClickGain[op][c] = clickFilterEnabled ? sumClickFilters[op][c].process(sampleTime, connection) : connection;
-        return inputVoltage * sumClickGain[op][c];
+    float diagonalTarget(int op, int mod, int c) {
+        return  diagonalConnection(centerMorphScene[c], op, mod)      * centerMorphWeight[c]
+            +   diagonalConnection(forwardMorphScene[c], op, mod)     * forwardMorphWeight[c];
     };
 
-    float routeSumB(float sampleTime, float inputVoltage, int op, int c) {
-        float connection    =   carriers[centerMorphScene[c]].test(op)     * (1.f - relativeMorphMagnitude[c])
-                            +   carriers[forwardMorphScene[c]].test(op)    * relativeMorphMagnitude[c];
-        sumClickGain[op][c] = clickFilterEnabled ? sumClickFilters[op][c].process(sampleTime, connection) : connection;
-        return inputVoltage * sumClickGain[op][c];
+    float diagonalRingTarget(int op, int mod, int c) {
+        return diagonalConnection(backwardMorphScene[c], op, mod) * backwardMorphWeight[c];
     };
 
-    float routeSumRing(float sampleTime, float inputVoltage, int op, int c) {
-        float connection = carriers[backwardMorphScene[c]].test(op) * relativeMorphMagnitude[c] * !horizontalMarks[backwardMorphScene[c]].test(op);
-        sumRingClickGain[op][c] = clickFilterEnabled ? sumRingClickFilters[op][c].process(sampleTime, connection) : connection;
-        return -inputVoltage * sumRingClickGain[op][c];
+    float sumTarget(int op, int c) {
+        return  sumConnection(centerMorphScene[c], op)     * centerMorphWeight[c]
+            +   sumConnection(forwardMorphScene[c], op)    * forwardMorphWeight[c];
     };
 
-    float routeSumRingB(float sampleTime, float inputVoltage, int op, int c) {
-        float connection = carriers[backwardMorphScene[c]].test(op) * relativeMorphMagnitude[c];
-        sumRingClickGain[op][c] = clickFilterEnabled ? sumRingClickFilters[op][c].process(sampleTime, connection) : connection;
-        return -inputVoltage * sumRingClickGain[op][c];
+    float sumRingTarget(int op, int c) {
+        return sumConnection(backwardMorphScene[c], op) * backwardMorphWeight[c];
+    };
+
+    // Steps a connection's click filters one sample towards its targets and returns its routing gain. The ring filters
+    // only run with ring morph
+    float stepModGain(float sampleTime, int op, int mod, float target, float ringTarget, int c) {
+        float gain = clickFilterEnabled ? modClickFilters[op][mod][c].process(sampleTime, target) : target;
+        float ringGain = 0.f;
+        if (ringMorph)
+            ringGain = clickFilterEnabled ? modRingClickFilters[op][mod][c].process(sampleTime, ringTarget) : ringTarget;
+        modRingClickGain[op][mod][c] = ringGain;
+        modClickGain[op][mod][c] = gain - ringGain;
+        return modClickGain[op][mod][c];
+    };
+
+    // Also counts the connection for average mode. Ring morph counts the gain without its ring share, from this sample
+    // and the last
+    float stepSumGain(float sampleTime, int op, float target, float ringTarget, int c) {
+        float lastGain = sumClickGain[op][c] + sumRingClickGain[op][c];
+        float gain = clickFilterEnabled ? sumClickFilters[op][c].process(sampleTime, target) : target;
+        float ringGain = 0.f;
+        if (ringMorph)
+            ringGain = clickFilterEnabled ? sumRingClickFilters[op][c].process(sampleTime, ringTarget) : ringTarget;
+        totalCarSumConnection[c] += ringMorph ? lastGain + gain : gain;
+        sumRingClickGain[op][c] = ringGain;
+        sumClickGain[op][c] = gain - ringGain;
+        return sumClickGain[op][c];
     };
 
     void toggleHorizontalDestination(int scene, int op) {
@@ -359,6 +700,7 @@ struct Algomorph : rack::engine::Module {
             else
                 modulators[scene]--;
         }
+        updateSceneCounts(scene);
         displayHorizontalMarks[scene].push(horizontalMarks[scene]);
         displayForcedCarriers[scene].push(forcedCarriers[scene]);
     };
@@ -383,6 +725,7 @@ struct Algomorph : rack::engine::Module {
             modulators[scene]++;
         else
             modulators[scene]--;
+        updateSceneCounts(scene);
     };
 
     bool isCarrier(int scene, int op) {
@@ -404,6 +747,7 @@ struct Algomorph : rack::engine::Module {
     void updateCarriers(int scene) {
         for (int op = 0; op < OPS; op++)
             carriers[scene].set(op, isCarrier(scene, op));
+        updateSceneCounts(scene);
         displayForcedCarriers[scene].push(forcedCarriers[scene]);
     };
 
@@ -417,6 +761,13 @@ struct Algomorph : rack::engine::Module {
                 }
             }
         }
+        updateSceneCounts(scene);
+    };
+
+    // Average mode reads these every sample, so every edit to carriers or modulators ends here
+    void updateSceneCounts(int scene) {
+        carrierCount[scene] = carriers[scene].count();
+        modulatorReciprocal[scene] = modulators[scene] > 0 ? 1.f / modulators[scene] : 0.f;
     };
 
     bool isDisabled(int scene, int op) {
@@ -455,14 +806,15 @@ struct Algomorph : rack::engine::Module {
         }
     };
 
-    void updateDisplayAlgo(int scene) {
-        tempDisplayAlgoName = algoName[scene];
+    // The algorithm as the display draws it: disabled operators lose their destinations, and unmodulated ones are hidden
+    std::bitset<OPS*OPS> getDisplayAlgoName(int scene) {
+        std::bitset<OPS*OPS> displayName = algoName[scene];
         // Set display algorithm
         for (int op = 0; op < OPS; op++) {
             if (opsDisabled[scene].test(op)) {
                 // Set all destinations to false
                 for (int mod = 0; mod < OPS - 1; mod++)
-                    tempDisplayAlgoName.set(op * (OPS - 1) + mod, false);
+                    displayName.set(op * (OPS - 1) + mod, false);
                 // Check if any operators are modulating this operator
                 bool fullDisable = true;
                 for (int i = 0; i < 4; i++) {     
@@ -470,23 +822,28 @@ struct Algomorph : rack::engine::Module {
                         fullDisable = false;
                 }
                 if (fullDisable) {
-                    tempDisplayAlgoName.set(12 + op, true);
+                    displayName.set(12 + op, true);
                 }
                 else
-                    tempDisplayAlgoName.set(12 + op, false);
+                    displayName.set(12 + op, false);
             }
             else {
                 // Enable destinations in the display and handle the consequences
                 for (int mod = 0; mod < 3; mod++) {
                     if (algoName[scene].test(op * (OPS - 1) + mod)) {
-                        tempDisplayAlgoName.set(op * (OPS - 1) + mod, true);
+                        displayName.set(op * (OPS - 1) + mod, true);
                         // the consequences
                         if (opsDisabled[scene].test(relToAbs[op][mod]))
-                            tempDisplayAlgoName.set(12 + relToAbs[op][mod], false);
+                            displayName.set(12 + relToAbs[op][mod], false);
                     }
                 }  
             }
         }
+        return displayName;
+    };
+
+    void updateDisplayAlgo(int scene) {
+        tempDisplayAlgoName = getDisplayAlgoName(scene);
         displayAlgoName[scene].push(tempDisplayAlgoName);
         displayHorizontalMarks[scene].push(horizontalMarks[scene]);
         displayForcedCarriers[scene].push(forcedCarriers[scene]);
@@ -520,6 +877,8 @@ struct Algomorph : rack::engine::Module {
                     carriers[scene].set(op, isCarrier(scene, op));
             }
         }
+        for (int scene = 0; scene < SCENES; scene++)
+            updateSceneCounts(scene);
     };
 
     void toggleForcedCarrier(int scene, int op) {
@@ -533,13 +892,127 @@ struct Algomorph : rack::engine::Module {
             if (mismatch)
                 toggleDisabled(scene, op);
         }
+        updateSceneCounts(scene);
+        displayForcedCarriers[scene].push(forcedCarriers[scene]);
+    };
+
+    // One scene's routing state, derived bits included, for the undo history. From the low bits:
+    // algoName (OPS * OPS), horizontalMarks, forcedCarriers, carriers, opsDisabled (OPS each), modulators (8)
+    uint64_t packScene(int scene) {
+        static_assert(OPS * OPS + 4 * OPS + 8 <= 64, "A packed scene must fit in 64 bits");
+        uint64_t packed = algoName[scene].to_ullong();
+        int shift = OPS * OPS;
+        packed |= (uint64_t) horizontalMarks[scene].to_ullong() << shift;
+        shift += OPS;
+        packed |= (uint64_t) forcedCarriers[scene].to_ullong() << shift;
+        shift += OPS;
+        packed |= (uint64_t) carriers[scene].to_ullong() << shift;
+        shift += OPS;
+        packed |= (uint64_t) opsDisabled[scene].to_ullong() << shift;
+        shift += OPS;
+        packed |= (uint64_t) (modulators[scene] & 0xFF) << shift;
+        return packed;
+    };
+
+    // Stores a packed scene as is, like a linked follower takes its leader's scenes, without deriving anything again
+    void unpackScene(int scene, uint64_t packed) {
+        const uint64_t opMask = (1ull << OPS) - 1;
+        algoName[scene] = packed & ((1ull << (OPS * OPS)) - 1);
+        int shift = OPS * OPS;
+        horizontalMarks[scene] = (packed >> shift) & opMask;
+        shift += OPS;
+        forcedCarriers[scene] = (packed >> shift) & opMask;
+        shift += OPS;
+        carriers[scene] = (packed >> shift) & opMask;
+        shift += OPS;
+        opsDisabled[scene] = (packed >> shift) & opMask;
+        shift += OPS;
+        modulators[scene] = (packed >> shift) & 0xFF;
+        updateSceneCounts(scene);
         displayForcedCarriers[scene].push(forcedCarriers[scene]);
+        updateDisplayAlgo(scene);
+    };
+
+    // Stores only the edited fields of a packed scene, and derives the rest from them as loading a patch does
+    void deriveScene(int scene, uint64_t packed) {
+        const uint64_t opMask = (1ull << OPS) - 1;
+        algoName[scene] = packed & ((1ull << (OPS * OPS)) - 1);
+        horizontalMarks[scene] = (packed >> (OPS * OPS)) & opMask;
+        forcedCarriers[scene] = (packed >> (OPS * OPS + OPS)) & opMask;
+        updateOpsDisabled(scene);
+        updateCarriers(scene);
+        updateModulators(scene);
+        updateDisplayAlgo(scene);
+    };
+
+    // Call from process(). A scene is stored as is only if it's still the one the undo step recorded. If something
+    // else has changed it since, e.g. a mode B toggle, the step's edit is applied to what's there instead.
+    void processSceneRequests() {
+        const uint64_t editedMask = (1ull << (OPS * OPS + 2 * OPS)) - 1;
+        while (!sceneRequests.empty()) {
+            SceneRequest r = sceneRequests.shift();
+            uint64_t current = packScene(r.scene);
+            if (current == r.expected)
+                unpackScene(r.scene, r.packed);
+            else
+                deriveScene(r.scene, current ^ ((r.expected ^ r.packed) & editedMask));
+            graphDirty = true;
+        }
     };
 };
 
 
 /// Undo/Redo History
 
+// Records each packed scene before and after the edit: capture() before, commit() after. Undo and redo hand the
+// scenes to process() rather than writing them, and a scene is only restored as is if it's still as the step left it.
+// Unchanged scenes are skipped.
+template < int OPS = 4, int SCENES = 3 >
+struct SceneDeltaAction : ModuleAction {
+	uint64_t before[SCENES] = {0};
+	uint64_t after[SCENES] = {0};
+	bool modeBChanged = false;
+	bool ringMorphChanged = false;
+
+	void capture(Algomorph<OPS, SCENES>* m) {
+		for (int scene = 0; scene < SCENES; scene++)
+			before[scene] = m->packScene(scene);
+		modeBChanged = m->modeB;
+		ringMorphChanged = m->ringMorph;
+	};
+	void commit(Algomorph<OPS, SCENES>* m) {
+		for (int scene = 0; scene < SCENES; scene++)
+			after[scene] = m->packScene(scene);
+		modeBChanged ^= m->modeB;
+		ringMorphChanged ^= m->ringMorph;
+	};
+	void apply(const uint64_t* from, const uint64_t* to) {
+		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
+		assert(mw);
+		Algomorph<OPS, SCENES>* m = dynamic_cast<Algomorph<OPS, SCENES>*>(mw->module);
+		assert(m);
+		if (modeBChanged)
+			m->modeB ^= true;
+		if (ringMorphChanged)
+			m->ringMorph ^= true;
+		for (int scene = 0; scene < SCENES; scene++) {
+			if (from[scene] == to[scene] || m->sceneRequests.full())
+				continue;
+			SceneRequest r;
+			r.scene = scene;
+			r.expected = from[scene];
+			r.packed = to[scene];
+			m->sceneRequests.push(r);
+		}
+	};
+	void undo() override {
+		apply(after, before);
+	};
+	void redo() override {
+		apply(before, after);
+	};
+};
+
 template < int OPS = 4, int SCENES = 3 >
 struct AlgorithmDiagonalChangeAction : ModuleAction {
     int scene, op, mod;
@@ -649,29 +1122,9 @@ struct AlgorithmSceneChangeAction : ModuleAction {
 };
 
 template < int OPS = 4, int SCENES = 3 >
-struct ToggleModeBAction : ModuleAction {
+struct ToggleModeBAction : SceneDeltaAction<OPS, SCENES> {
 	ToggleModeBAction() {
-		name = "Delexander Algomorph toggle mode B";
-	};
-	void undo() override {
-		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
-		assert(mw);
-		Algomorph<OPS, SCENES>* m = dynamic_cast<Algomorph<OPS, SCENES>*>(mw->module);
-		assert(m);
-		
-		m->toggleModeB();
-
-		m->graphDirty = true;
-	};
-	void redo() override {
-		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
-		assert(mw);
-		Algomorph<OPS, SCENES>* m = dynamic_cast<Algomorph<OPS, SCENES>*>(mw->module);
-		assert(m);
-		
-		m->toggleModeB();
-
-		m->graphDirty = true;
+		this->name = "Delexander Algomorph toggle mode B";
 	};
 };
 
@@ -847,137 +1300,30 @@ struct SetClickFilterAction : ModuleAction {
 };
 
 template < int OPS = 4, int SCENES = 3 >
-struct RandomizeCurrentAlgorithmAction : ModuleAction {
-	int oldAlgoName, oldHorizontalMarks, oldOpsDisabled, oldForcedCarriers;
-	int newAlgoName, newHorizontalMarks, newOpsDisabled, newForcedCarriers;
-	int scene;
-
+struct RandomizeCurrentAlgorithmAction : SceneDeltaAction<OPS, SCENES> {
 	RandomizeCurrentAlgorithmAction() {
-		name = "Delexander Algomorph randomize current algorithm";
-	};
-    void undo() override {
-		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
-		assert(mw);
-		Algomorph<OPS, SCENES>* m = dynamic_cast<Algomorph<OPS, SCENES>*>(mw->module);
-		assert(m);
-		m->algoName[scene] = oldAlgoName;
-		m->horizontalMarks[scene] = oldHorizontalMarks;
-		m->opsDisabled[scene] = oldOpsDisabled;
-		m->forcedCarriers[scene] = oldForcedCarriers;
-		m->updateDisplayAlgo(scene);
-	};
-    void redo() override {
-		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
-		assert(mw);
-		Algomorph<OPS, SCENES>* m = dynamic_cast<Algomorph<OPS, SCENES>*>(mw->module);
-		assert(m);
-		m->algoName[scene] = newAlgoName;
-		m->horizontalMarks[scene] = newHorizontalMarks;
-		m->opsDisabled[scene] = newOpsDisabled;
-		m->forcedCarriers[scene] = newForcedCarriers;
-		m->updateDisplayAlgo(scene);
+		this->name = "Delexander Algomorph randomize current algorithm";
 	};
 };
 
 template < int OPS = 4, int SCENES = 3 >
-struct RandomizeAllAlgorithmsAction : ModuleAction {
-	int oldAlgorithm[3], oldHorizontalMarks[3], oldOpsDisabled[3], oldForcedCarriers[3];
-	int newAlgorithm[3], newHorizontalMarks[3], newOpsDisabled[3], newForcedCarriers[3];
-
+struct RandomizeAllAlgorithmsAction : SceneDeltaAction<OPS, SCENES> {
 	RandomizeAllAlgorithmsAction() {
-		name = "Delexander Algomorph randomize all algorithms";
-	};
-	void undo() override {
-		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
-		assert(mw);
-		Algomorph<OPS, SCENES>* m = dynamic_cast<Algomorph<OPS, SCENES>*>(mw->module);
-		assert(m);
-		for (int scene = 0; scene < 3; scene++) {
-			m->algoName[scene] = oldAlgorithm[scene];
-			m->horizontalMarks[scene] = oldHorizontalMarks[scene];
-			m->opsDisabled[scene] = oldOpsDisabled[scene];
-			m->forcedCarriers[scene] = oldForcedCarriers[scene];
-			m->updateDisplayAlgo(scene);
-		}
-	};
-	void redo() override {
-		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
-		assert(mw);
-		Algomorph<OPS, SCENES>* m = dynamic_cast<Algomorph<OPS, SCENES>*>(mw->module);
-		assert(m);
-		for (int scene = 0; scene < 3; scene++) {
-			m->algoName[scene] = newAlgorithm[scene];
-			m->horizontalMarks[scene] = newHorizontalMarks[scene];
-			m->opsDisabled[scene] = newOpsDisabled[scene];
-			m->forcedCarriers[scene] = newForcedCarriers[scene];
-			m->updateDisplayAlgo(scene);
-		}
+		this->name = "Delexander Algomorph randomize all algorithms";
 	};
 };
 
 template < int OPS = 4, int SCENES = 3 >
-struct InitializeCurrentAlgorithmAction : ModuleAction {
-	int oldAlgoName, oldHorizontalMarks, oldOpsDisabled, oldForcedCarriers, scene;
-
+struct InitializeCurrentAlgorithmAction : SceneDeltaAction<OPS, SCENES> {
 	InitializeCurrentAlgorithmAction() {
-		name = "Delexander Algomorph initialize current algorithm";
-	};
-	void undo() override {
-		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
-		assert(mw);
-		Algomorph<OPS, SCENES>* m = dynamic_cast<Algomorph<OPS, SCENES>*>(mw->module);
-		assert(m);
-		m->algoName[scene] = oldAlgoName;
-		m->horizontalMarks[scene] = oldHorizontalMarks;
-		m->opsDisabled[scene] = oldOpsDisabled;
-		m->forcedCarriers[scene] = oldForcedCarriers;
-		m->updateDisplayAlgo(scene);
-	};
-	void redo() override {
-		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
-		assert(mw);
-		Algomorph<OPS, SCENES>* m = dynamic_cast<Algomorph<OPS, SCENES>*>(mw->module);
-		assert(m);
-		m->algoName[scene].reset();
-		m->horizontalMarks[scene].reset();
-		m->opsDisabled[scene].reset();
-		m->forcedCarriers[scene].reset();
-		m->updateDisplayAlgo(scene);
+		this->name = "Delexander Algomorph initialize current algorithm";
 	};
 };
 
 template < int OPS = 4, int SCENES = 3 >
-struct InitializeAllAlgorithmsAction : ModuleAction {
-	int oldAlgorithm[3], oldHorizontalMarks[3], oldOpsDisabled[3], oldForcedCarriers[3];
-
+struct InitializeAllAlgorithmsAction : SceneDeltaAction<OPS, SCENES> {
 	InitializeAllAlgorithmsAction() {
-		name = "Delexander Algomorph initialize all algorithms";
-	};
-	void undo() override {
-		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
-		assert(mw);
-		Algomorph<OPS, SCENES>* m = dynamic_cast<Algomorph<OPS, SCENES>*>(mw->module);
-		assert(m);
-		for (int i = 0; i < 3; i++) {
-			m->algoName[i] = oldAlgorithm[i];
-			m->horizontalMarks[i] = oldHorizontalMarks[i];
-			m->opsDisabled[i] = oldOpsDisabled[i];
-			m->forcedCarriers[i] = oldForcedCarriers[i];
-			m->updateDisplayAlgo(i);
-		}
-	};
-	void redo() override {
-		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
-		assert(mw);
-		Algomorph<OPS, SCENES>* m = dynamic_cast<Algomorph<OPS, SCENES>*>(mw->module);
-		assert(m);
-		for (int i = 0; i < 3; i++) {
-			m->algoName[i].reset();
-			m->horizontalMarks[i].reset();
-			m->opsDisabled[i].reset();
-			m->forcedCarriers[i].reset();
-			m->updateDisplayAlgo(i);
-		}
+		this->name = "Delexander Algomorph initialize all algorithms";
 	};
 };
 
@@ -992,15 +1338,60 @@ struct AlgomorphMenuItem : rack::ui::MenuItem {
 
 template < int OPS = 4, int SCENES = 3 >
 struct AlgomorphWidget : rack::app::ModuleWidget {
+    // Lets the module skip light and display work while the panel is off-screen or the rack is zoomed far out
+    void draw(const DrawArgs& args) override {
+        if (module && APP->scene->rackScroll->getZoom() >= MIN_VISIBLE_ZOOM)
+            reinterpret_cast<Algomorph<OPS, SCENES>*>(module)->drawn = true;
+        ModuleWidget::draw(args);
+    };
+
+    // Call from step(), so undo steps raised by process() reach the history on the UI thread
+    void pushHistoryRequests(Algomorph<OPS, SCENES>* module) {
+        while (!module->historyRequests.empty()) {
+            HistoryRequest r = module->historyRequests.shift();
+            if (r.type == HistoryRequest::SCENE_CHANGE) {
+                AlgorithmSceneChangeAction<OPS, SCENES>* h = new AlgorithmSceneChangeAction<OPS, SCENES>;
+                h->moduleId = module->id;
+                h->oldScene = r.oldScene;
+                h->newScene = r.newScene;
+                APP->history->push(h);
+            }
+            else if (r.type == HistoryRequest::HORIZONTAL) {
+                AlgorithmHorizontalChangeAction<OPS, SCENES>* h = new AlgorithmHorizontalChangeAction<OPS, SCENES>;
+                h->moduleId = module->id;
+                h->scene = r.scene;
+                h->op = r.op;
+                APP->history->push(h);
+            }
+            else if (r.type == HistoryRequest::DIAGONAL) {
+                AlgorithmDiagonalChangeAction<OPS, SCENES>* h = new AlgorithmDiagonalChangeAction<OPS, SCENES>;
+                h->moduleId = module->id;
+                h->scene = r.scene;
+                h->op = r.op;
+                h->mod = r.mod;
+                APP->history->push(h);
+            }
+            else if (r.type == HistoryRequest::FORCED_CARRIER) {
+                AlgorithmForcedCarrierChangeAction<OPS, SCENES>* h = new AlgorithmForcedCarrierChangeAction<OPS, SCENES>;
+                h->moduleId = module->id;
+                h->scene = r.scene;
+                h->op = r.op;
+                APP->history->push(h);
+            }
+        }
+    };
+
     // Menu items
     struct ToggleModeBItem : AlgomorphMenuItem<OPS, SCENES> {
         void onAction(const Action &e) override {
             // History
             ToggleModeBAction<OPS, SCENES>* h = new ToggleModeBAction<OPS, SCENES>;
             h->moduleId = this->module->id;
+            h->capture(this->module);
 
             this->module->toggleModeB();
 
+            h->commit(this->module);
             APP->history->push(h);
 
             this->module->graphDirty = true;
@@ -1064,6 +1455,24 @@ struct AlgomorphWidget : rack::app::ModuleWidget {
             APP->history->push(h);
         };
     };
+    struct DisplayFrameRateItem : AlgomorphMenuItem<OPS, SCENES> {
+        int frameRate;
+        void onAction(const Action &e) override {
+            this->module->displayFrameRate = frameRate;
+        };
+    };
+    struct DisplayFrameRateMenuItem : AlgomorphMenuItem<OPS, SCENES> {
+        Menu* createChildMenu() override {
+            Menu* menu = new Menu;
+            for (int rate : DISPLAY_FRAME_RATES) {
+                DisplayFrameRateItem *frameRateItem = rack::createMenuItem<DisplayFrameRateItem>(rate > 0 ? rack::string::f("%d fps", rate) : "Unlimited", CHECKMARK(this->module->displayFrameRate == rate));
+                frameRateItem->module = this->module;
+                frameRateItem->frameRate = rate;
+                menu->addChild(frameRateItem);
+            }
+            return menu;
+        };
+    };
     struct GlowingInkItem : AlgomorphMenuItem<OPS, SCENES> {
         void onAction(const Action &e) override {
             // History
@@ -1077,9 +1486,91 @@ struct AlgomorphWidget : rack::app::ModuleWidget {
     };
     struct DebugItem : AlgomorphMenuItem<OPS, SCENES> {
         void onAction(const Action &e) override {
+            // Start from a clean slate before the audio thread resumes accumulating
+            if (!this->module->debug)
+                this->module->debugStats.reset();
             this->module->debug ^= true;
         };
     };
+    struct RecordTelemetryItem : AlgomorphMenuItem<OPS, SCENES> {
+        void onAction(const Action &e) override {
+            TelemetryRecorder* telemetry = this->module->getTelemetry();
+            if (telemetry->recording)
+                telemetry->stop();
+            else
+                telemetry->start(this->module->id);
+        };
+    };
+    struct TelemetryDecimationItem : AlgomorphMenuItem<OPS, SCENES> {
+        int decimation;
+        void onAction(const Action &e) override {
+            this->module->getTelemetry()->decimation = decimation;
+        };
+    };
+    struct TelemetryFormatItem : AlgomorphMenuItem<OPS, SCENES> {
+        int format;
+        void onAction(const Action &e) override {
+            this->module->getTelemetry()->format = format;
+        };
+    };
+    struct TelemetryMenuItem : AlgomorphMenuItem<OPS, SCENES> {
+        Menu* createChildMenu() override {
+            Menu* menu = new Menu;
+            TelemetryRecorder* telemetry = this->module->telemetry.load(std::memory_order_relaxed);
+            bool recording = telemetry && telemetry->recording;
+            int decimation = telemetry ? telemetry->decimation : DEF_TELEMETRY_DECIMATION;
+            int format = telemetry ? telemetry->format : TelemetryFormats::CSV;
+
+            RecordTelemetryItem *recordTelemetryItem = rack::createMenuItem<RecordTelemetryItem>("Record", CHECKMARK(recording));
+            recordTelemetryItem->module = this->module;
+            menu->addChild(recordTelemetryItem);
+            if (recording) {
+                menu->addChild(rack::construct<rack::ui::MenuLabel>(&rack::ui::MenuLabel::text, rack::system::getFilename(telemetry->path)));
+                menu->addChild(rack::construct<rack::ui::MenuLabel>(&rack::ui::MenuLabel::text, rack::string::f("%ld frames written, %ld dropped", telemetry->written.load(), telemetry->dropped.load())));
+            }
+            else if (telemetry && !telemetry->path.empty())
+                menu->addChild(rack::construct<rack::ui::MenuLabel>(&rack::ui::MenuLabel::text, "Last: " + rack::system::getFilename(telemetry->path)));
+
+            menu->addChild(new rack::ui::MenuSeparator());
+            menu->addChild(rack::construct<rack::ui::MenuLabel>(&rack::ui::MenuLabel::text, "Sample every"));
+            for (int d : TELEMETRY_DECIMATIONS) {
+                TelemetryDecimationItem *decimationItem = rack::createMenuItem<TelemetryDecimationItem>(rack::string::f("%d samples", d), CHECKMARK(decimation == d));
+                decimationItem->module = this->module;
+                decimationItem->decimation = d;
+                decimationItem->disabled = recording;
+                menu->addChild(decimationItem);
+            }
+
+            menu->addChild(new rack::ui::MenuSeparator());
+            menu->addChild(rack::construct<rack::ui::MenuLabel>(&rack::ui::MenuLabel::text, "Format"));
+            for (int i = 0; i < TelemetryFormats::NUM_FORMATS; i++) {
+                TelemetryFormatItem *formatItem = rack::createMenuItem<TelemetryFormatItem>(TelemetryFormatLabels[i], CHECKMARK(format == i));
+                formatItem->module = this->module;
+                formatItem->format = i;
+                formatItem->disabled = recording;
+                menu->addChild(formatItem);
+            }
+            return menu;
+        };
+    };
+    struct DebugStatsMenuItem : AlgomorphMenuItem<OPS, SCENES> {
+        Menu* createChildMenu() override {
+            Menu* menu = new Menu;
+            const DebugResults& stats = this->module->debugStats.read();
+            if (stats.windows == 0) {
+                menu->addChild(rack::construct<rack::ui::MenuLabel>(&rack::ui::MenuLabel::text, "Collecting…"));
+                return menu;
+            }
+            menu->addChild(rack::construct<rack::ui::MenuLabel>(&rack::ui::MenuLabel::text, rack::string::f("Total: %.0f ns/sample, peak %.0f ns (%.2f%% load)", stats.totalMeanNs, stats.totalPeakNs, stats.load * 100.f)));
+            for (int i = 0; i < DebugSections::NUM_SECTIONS; i++)
+                menu->addChild(rack::construct<rack::ui::MenuLabel>(&rack::ui::MenuLabel::text, rack::string::f("%s: %.0f ns/sample, peak %.0f ns", DebugSectionLabels[i].c_str(), stats.meanNs[i], stats.peakNs[i])));
+            menu->addChild(new rack::ui::MenuSeparator());
+            menu->addChild(rack::construct<rack::ui::MenuLabel>(&rack::ui::MenuLabel::text, rack::string::f("Morph wraps: %ld", stats.morphWraps)));
+            menu->addChild(rack::construct<rack::ui::MenuLabel>(&rack::ui::MenuLabel::text, rack::string::f("Scene changes: %ld", stats.sceneChanges)));
+            menu->addChild(rack::construct<rack::ui::MenuLabel>(&rack::ui::MenuLabel::text, rack::string::f("Click filter re-arms: %ld", stats.clickFilterRearms)));
+            return menu;
+        };
+    };
     struct SaveVisualSettingsItem : AlgomorphMenuItem<OPS, SCENES> {
         void onAction(const Action &e) override {
             // pluginSettings.glowingInkDefault = module->glowingInk;
@@ -0,0 +1,163 @@
+#include "AlgomorphAux.hpp"
+#include "AlgomorphLarge.hpp"
+#include "AuxSources.hpp"
+#include "Components.hpp"
+#include "plugin.hpp" // For constants
+#include <rack.hpp>
+#include <algorithm>
+using rack::construct;
+using rack::event::Action;
+using rack::ui::Menu;
+using rack::ui::MenuLabel;
+using rack::ui::MenuSeparator;
+using rack::RACK_GRID_WIDTH;
+
+
+static const float AuxLaneRows[NUM_AUX_LANES] = {24.f, 38.f, 52.f, 66.f, 80.f, 94.f};
+
+AlgomorphAux::AlgomorphAux() {
+    config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+
+    for (int lane = 0; lane < NUM_AUX_LANES; lane++)
+        configInput(AUX_INPUTS + lane, "");
+    configLight(LINK_LIGHT, "Linked to Algomorph Advance");
+
+    AlgomorphAux::onReset();
+}
+
+void AlgomorphAux::onReset() {
+    for (int lane = 0; lane < NUM_AUX_LANES; lane++) {
+        laneMode[lane] = -1;
+        updateLaneLabel(lane);
+    }
+    compensate = false;
+}
+
+void AlgomorphAux::process(const ProcessArgs& args) {
+    bool linked = rightExpander.module && rightExpander.module->model == modelAlgomorphLarge;
+    lights[LINK_LIGHT].setBrightness(linked);
+
+    if (!linked)
+        return;
+
+    // Voltages go straight into Algomorph Advance's buffer, ready for its next sample
+    AuxLaneMessage* out = &((LeftExpanderMessage*) rightExpander.module->leftExpander.producerMessage)->aux;
+    out->valid = true;
+    out->compensate = compensate;
+    for (int lane = 0; lane < NUM_AUX_LANES; lane++) {
+        int channels = inputs[AUX_INPUTS + lane].getChannels();
+        out->mode[lane] = laneMode[lane];
+        out->channels[lane] = channels;
+        if (channels == 1)
+            std::fill(out->voltage[lane], out->voltage[lane] + CHANNELS, inputs[AUX_INPUTS + lane].getVoltage());
+        else {
+            inputs[AUX_INPUTS + lane].readVoltages(out->voltage[lane]);
+            std::fill(out->voltage[lane] + channels, out->voltage[lane] + CHANNELS, 0.f);
+        }
+    }
+    rightExpander.module->leftExpander.requestMessageFlip();
+}
+
+// Lanes continue Algomorph Advance's AUX numbering
+void AlgomorphAux::updateLaneLabel(int lane) {
+    std::string name = "AUX " + std::to_string(AlgomorphLarge::NUM_AUX_INPUTS + lane + 1);
+    if (laneMode[lane] > -1) {
+        inputInfos[AUX_INPUTS + lane]->name = name + ": " + AuxInputModeLabels[laneMode[lane]];
+        inputInfos[AUX_INPUTS + lane]->description = AuxInputModeDescriptions[laneMode[lane]];
+    }
+    else {
+        inputInfos[AUX_INPUTS + lane]->name = name + ": Unassigned";
+        inputInfos[AUX_INPUTS + lane]->description = "No mode is assigned";
+    }
+}
+
+json_t* AlgomorphAux::dataToJson() {
+    json_t* rootJ = json_object();
+    json_t* laneModesJ = json_array();
+    for (int lane = 0; lane < NUM_AUX_LANES; lane++)
+        json_array_append_new(laneModesJ, json_integer(laneMode[lane]));
+    json_object_set_new(rootJ, "Lane Modes", laneModesJ);
+    json_object_set_new(rootJ, "Compensate Latency", json_boolean(compensate));
+    return rootJ;
+}
+
+void AlgomorphAux::dataFromJson(json_t* rootJ) {
+    json_t* laneModesJ = json_object_get(rootJ, "Lane Modes");
+    if (laneModesJ) {
+        json_t* laneModeJ; size_t lane;
+        json_array_foreach(laneModesJ, lane, laneModeJ) {
+            if (lane < NUM_AUX_LANES) {
+                int mode = json_integer_value(laneModeJ);
+                laneMode[lane] = mode >= 0 && mode < AuxInputModes::NUM_MODES ? mode : -1;
+                updateLaneLabel(lane);
+            }
+        }
+    }
+
+    auto compensate = json_object_get(rootJ, "Compensate Latency");
+    if (compensate)
+        this->compensate = json_boolean_value(compensate);
+}
+
+
+///// Panel Widget
+
+void AlgomorphAuxWidget::LaneModeItem::onAction(const Action &e) {
+    // History
+    AuxLaneModeAction<>* h = new AuxLaneModeAction<>();
+    h->moduleId = module->id;
+    h->lane = lane;
+    h->oldMode = module->laneMode[lane];
+    h->newMode = module->laneMode[lane] == mode ? -1 : mode;
+
+    module->laneMode[lane] = h->newMode;
+    module->updateLaneLabel(lane);
+
+    APP->history->push(h);
+}
+
+Menu* AlgomorphAuxWidget::LaneModeMenuItem::createChildMenu() {
+    Menu* menu = new Menu;
+    for (int mode = 0; mode < AuxInputModes::NUM_MODES; mode++)
+        menu->addChild(construct<LaneModeItem>(&MenuItem::text, AuxInputModeLabels[mode], &MenuItem::rightText, CHECKMARK(module->laneMode[lane] == mode), &LaneModeItem::module, module, &LaneModeItem::lane, lane, &LaneModeItem::mode, mode));
+    return menu;
+}
+
+void AlgomorphAuxWidget::CompensateItem::onAction(const Action &e) {
+    // History
+    ToggleAuxCompensateAction<>* h = new ToggleAuxCompensateAction<>();
+    h->moduleId = module->id;
+
+    module->compensate ^= true;
+
+    APP->history->push(h);
+}
+
+AlgomorphAuxWidget::AlgomorphAuxWidget(AlgomorphAux* module) {
+    setModule(module);
+    setPanel(APP->window->loadSvg(rack::asset::plugin(pluginInstance, "res/AlgomorphAux.svg")));
+
+    addChild(rack::createWidget<DLXGameBitBlack>(Vec(RACK_GRID_WIDTH, 0)));
+    addChild(rack::createWidget<DLXGameBitBlack>(Vec(RACK_GRID_WIDTH, 365)));
+
+    addChild(rack::createLightCentered<rack::componentlibrary::SmallLight<rack::componentlibrary::PurpleLight>>(mm2px(Vec(10.16, 8.f)), module, AlgomorphAux::LINK_LIGHT));
+
+    for (int lane = 0; lane < NUM_AUX_LANES; lane++)
+        addInput(rack::createInputCentered<DLXPJ301MPort>(mm2px(Vec(10.16, AuxLaneRows[lane])), module, AlgomorphAux::AUX_INPUTS + lane));
+}
+
+void AlgomorphAuxWidget::appendContextMenu(Menu* menu) {
+    AlgomorphAux* module = dynamic_cast<AlgomorphAux*>(this->module);
+
+    menu->addChild(new MenuSeparator());
+    menu->addChild(construct<MenuLabel>(&MenuLabel::text, "AUX Inputs"));
+    for (int lane = 0; lane < NUM_AUX_LANES; lane++)
+        menu->addChild(construct<LaneModeMenuItem>(&MenuItem::text, "AUX " + std::to_string(AlgomorphLarge::NUM_AUX_INPUTS + lane + 1) + "…", &MenuItem::rightText, (module->laneMode[lane] > -1 ? AuxInputModeLabels[module->laneMode[lane]] : std::string("None")) + " " + RIGHT_ARROW, &LaneModeMenuItem::module, module, &LaneModeMenuItem::lane, lane));
+
+    menu->addChild(new MenuSeparator());
+    CompensateItem *compensateItem = rack::createMenuItem<CompensateItem>("Delay Algomorph Advance's AUX inputs to match", CHECKMARK(module->compensate));
+    compensateItem->module = module;
+    menu->addChild(compensateItem);
+}
+
+Model* modelAlgomorphAux = createModel<AlgomorphAux, AlgomorphAuxWidget>("AlgomorphAux");
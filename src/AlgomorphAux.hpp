@@ -0,0 +1,119 @@
+#pragma once
+#include "plugin.hpp" // For constants
+#include <rack.hpp>
+using rack::history::ModuleAction;
+using rack::window::mm2px;
+
+
+// Algomorph AUX Structure
+// Expander for Algomorph Advance, placed to its left. Adds NUM_AUX_LANES more AUX inputs, one AUX mode per jack.
+// Each lane is fed to one of Algomorph Advance's AuxInputs past its own jacks, so lanes go through the same AUX mode
+// pipeline as the jacks: triggers, click filters, scaling and combining with other inputs in the same mode.
+// The expander writes its voltages into a buffer Algomorph Advance owns and Rack flips the pair between samples, so
+// lanes are read in place one sample late. With latency compensation on, Algomorph Advance delays its own AUX jacks
+// by the same sample. Without an expander, Algomorph Advance's AUX loops cover its own jacks only.
+
+static constexpr int NUM_AUX_LANES = 6;
+
+struct alignas(16) AuxLaneMessage {             // AUX to Advance, held by Advance's leftExpander
+    bool valid;                                 // Set by the first write, so a fresh buffer is never read
+    bool compensate;
+    int mode[NUM_AUX_LANES];                    // -1 when unassigned
+    int channels[NUM_AUX_LANES];                // 0 when unconnected
+    float voltage[NUM_AUX_LANES][CHANNELS];     // Spread like getPolyVoltage(), so a mono CV reaches every channel
+};
+
+struct AlgomorphAux : rack::engine::Module {
+    enum ParamIds {
+        NUM_PARAMS
+    };
+    enum InputIds {
+        ENUMS(AUX_INPUTS, NUM_AUX_LANES),
+        NUM_INPUTS
+    };
+    enum OutputIds {
+        NUM_OUTPUTS
+    };
+    enum LightIds {
+        LINK_LIGHT,
+        NUM_LIGHTS
+    };
+
+    int laneMode[NUM_AUX_LANES];
+    bool compensate = false;        // Delay Algomorph Advance's own AUX inputs to line up with the lanes
+
+    AlgomorphAux();
+    void onReset() override;
+    void process(const ProcessArgs& args) override;
+    void updateLaneLabel(int lane);
+    json_t* dataToJson() override;
+    void dataFromJson(json_t* rootJ) override;
+};
+
+struct AlgomorphAuxWidget : rack::app::ModuleWidget {
+    struct AlgomorphAuxMenuItem : rack::ui::MenuItem {
+        AlgomorphAux* module;
+        int lane = -1, mode = -1;
+    };
+    struct LaneModeItem : AlgomorphAuxMenuItem {
+        void onAction(const rack::event::Action &e) override;
+    };
+    struct LaneModeMenuItem : AlgomorphAuxMenuItem {
+        rack::ui::Menu* createChildMenu() override;
+    };
+    struct CompensateItem : AlgomorphAuxMenuItem {
+        void onAction(const rack::event::Action &e) override;
+    };
+
+    AlgomorphAuxWidget(AlgomorphAux* module);
+    void appendContextMenu(rack::ui::Menu* menu) override;
+};
+
+
+// Undo/Redo
+
+template < int OPS = 4, int SCENES = 3 >
+struct AuxLaneModeAction : ModuleAction {
+    int lane, oldMode, newMode;
+
+	AuxLaneModeAction() {
+		name = "Delexander Algomorph AUX lane mode";
+	};
+	void undo() override {
+		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
+		assert(mw);
+		AlgomorphAux* m = dynamic_cast<AlgomorphAux*>(mw->module);
+		assert(m);
+		m->laneMode[lane] = oldMode;
+		m->updateLaneLabel(lane);
+	};
+	void redo() override {
+		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
+		assert(mw);
+		AlgomorphAux* m = dynamic_cast<AlgomorphAux*>(mw->module);
+		assert(m);
+		m->laneMode[lane] = newMode;
+		m->updateLaneLabel(lane);
+	};
+};
+
+template < int OPS = 4, int SCENES = 3 >
+struct ToggleAuxCompensateAction : ModuleAction {
+	ToggleAuxCompensateAction() {
+		name = "Delexander Algomorph toggle AUX latency compensation";
+	};
+	void undo() override {
+		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
+		assert(mw);
+		AlgomorphAux* m = dynamic_cast<AlgomorphAux*>(mw->module);
+		assert(m);
+		m->compensate ^= true;
+	};
+	void redo() override {
+		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
+		assert(mw);
+		AlgomorphAux* m = dynamic_cast<AlgomorphAux*>(mw->module);
+		assert(m);
+		m->compensate ^= true;
+	};
+};
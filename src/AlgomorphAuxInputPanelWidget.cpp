@@ -44,6 +44,8 @@ AlgomorphAuxInputPanelWidget::AlgomorphAuxInputPanelWidget(rack::engine::Module*
 
 void AlgomorphAuxInputPanelWidget::step() {
     if (module && reinterpret_cast<AlgomorphLarge*>(module)->auxPanelDirty) {
+        for (int i = 0; i < AlgomorphLarge::NUM_AUX_INPUTS; i++)
+            reinterpret_cast<AlgomorphLarge*>(module)->auxInput[i]->refreshLabel();
         FramebufferWidget::dirty = true;
         w->box.size = box.size;
         reinterpret_cast<AlgomorphLarge*>(module)->auxPanelDirty = false;
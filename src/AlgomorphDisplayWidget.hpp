@@ -2,7 +2,11 @@
 #include "plugin.hpp"
 #include "Algomorph.hpp"
 #include "AlgomorphDisplayWidget.hpp"
+#include "GraphLayout.hpp"
+#include "HaloCache.hpp"
+#include "MorphTween.hpp"
 #include <rack.hpp>
+#include <cstring>
 using rack::math::crossfade;
 
 
@@ -11,7 +15,8 @@ struct AlgomorphDisplayWidget : rack::widget::FramebufferWidget {
     struct AlgoDrawWidget : rack::app::LightWidget {
         Algomorph<OPS, SCENES>* module;
         alGraph graphs[SCENES];
-        int translatedAlgoName[SCENES] = {0};
+        int translatedAlgoName[SCENES] = {0};    // Graph id, or GraphLayoutCache key for computed layouts
+        int displayName[SCENES];                 // Last 16-bit display algorithm received
         std::bitset<OPS> horizontalMarks[SCENES] = {0};
         std::bitset<OPS> forcedCarriers[SCENES] = {0};
         int scene = std::floor((OPS + 1)/ 2.f);
@@ -24,6 +29,28 @@ struct AlgomorphDisplayWidget : rack::widget::FramebufferWidget {
 
         float xOrigin = box.size.x / 2.f;
         float yOrigin = box.size.y / 2.f;
+
+        // Everything the rendered graph depends on. Compared as raw memory, so keep every field 4 bytes wide.
+        struct DisplayState {
+            int32_t configMode = -1;
+            int32_t modeB = 0;
+            int32_t scene = 0;
+            int32_t morphScene = 0;
+            float morph = 0.f;
+            int32_t algoName[SCENES] = {0};
+            uint32_t horizontalMarks[SCENES] = {0};
+            uint32_t forcedCarriers[SCENES] = {0};
+            float rotorPhase = 0.f;
+            float width = 0.f;
+            float height = 0.f;
+        };
+
+        DisplayState state;
+        MorphTween tween;
+        HaloCache graphCache;               // The graph, rendered at most displayFrameRate times a second
+        int revision = 0;
+        double lastRenderTime = 0.0;
+        bool forceRender = true;            // Render the next change immediately, regardless of frame rate
    
         const NVGcolor NODE_FILL_COLOR = DLXMediumDarkPurple;
         const NVGcolor FEEDBACK_NODE_COLOR = DLXPurple;
@@ -47,220 +74,110 @@ struct AlgomorphDisplayWidget : rack::widget::FramebufferWidget {
         AlgoDrawWidget(Algomorph<OPS, SCENES>* module) {
             this->module = module;
             fontPath = "res/MiriamLibre-Regular.ttf";
+            for (int i = 0; i < SCENES; i++)
+                displayName[i] = -1;
+
+            // Computed layouts the scenes will need are built in the background before the first draw
+            if (module) {
+                for (int i = 0; i < SCENES; i++) {
+                    int name = module->getDisplayAlgoName(i).to_ulong();
+                    if (module->graphAddressTranslation[name] == -1)
+                        GraphLayoutCache::shared().warm(name, module->forcedCarriers[i].to_ulong());
+                }
+            }
         };
 
-        void drawNodes(NVGcontext* ctx, alGraph source, alGraph destination, float morph) {
-            if (source.numNodes >= destination.numNodes)
-                renderNodes(ctx, source, destination, morph, false);
-            else
-                renderNodes(ctx, destination, source, morph, true);
+        // Lines up the current scene pair if it changed, then moves every point to the current morph
+        void updateTween() {
+            Vec origin = Vec(xOrigin, yOrigin);
+            if (tween.needsBuild(scene, morphScene, origin))
+                tween.build(graphs[scene], graphs[morphScene], scene, morphScene, origin);
+            tween.lerp(morph);
         };
 
-        void renderNodes(NVGcontext* ctx, alGraph mostNodes, alGraph leastNodes, float morph, bool flipped) {
+        void drawNodes(NVGcontext* ctx) {
             for (int op = 0; op < OPS; op++) {
-                Node nodes[2];
-                float nodeX[2] = {0.f};
-                float nodeY[2] = {0.f};
-                float nodeAlpha[2] = {0.f};
-                float textAlpha[2] = {0.f};
+                if (!tween.nodeDrawn[op])
+                    continue;
+
+                float alpha = crossfade(tween.nodeAlpha[op][0], tween.nodeAlpha[op][1], morph);
                 nodeFillColor = NODE_FILL_COLOR;
                 feedbackFillColor = FEEDBACK_NODE_COLOR;
                 nodeStrokeColor = NODE_STROKE_COLOR;
                 textColor = TEXT_COLOR;
-                bool draw = true;
+                nodeFillColor.a = alpha * NODE_FILL_COLOR.a;
+                nodeStrokeColor.a = alpha * NODE_FILL_COLOR.a;
+                textColor.a = alpha * TEXT_COLOR.a;
+                Vec p = tween.getPoint(op);
 
                 nvgBeginPath(ctx);
-                if (mostNodes.nodes[op].id == 404) {
-                    if (leastNodes.nodes[op].id == 404)
-                        draw = false;
-                    else {
-                        nodes[0] = leastNodes.nodes[op];
-                        nodes[1] = leastNodes.nodes[op];
-                        if (!flipped) {
-                            nodeAlpha[0] = 0.f;
-                            textAlpha[0] = 0.f;
-                            nodeAlpha[1] = NODE_FILL_COLOR.a;
-                            textAlpha[1] = TEXT_COLOR.a;
-                            nodeX[0] = xOrigin;
-                            nodeY[0] = yOrigin;
-                            nodeX[1] = nodes[1].coords.x;
-                            nodeY[1] = nodes[1].coords.y;
-                        }
-                        else {
-                            nodeAlpha[0] = NODE_FILL_COLOR.a;
-                            textAlpha[0] = TEXT_COLOR.a;
-                            nodeAlpha[1] = 0.f;
-                            textAlpha[1] = 0.f;
-                            nodeX[0] = nodes[0].coords.x;
-                            nodeY[0] = nodes[0].coords.y;
-                            nodeX[1] = xOrigin;
-                            nodeY[1] = yOrigin;
-                        }
-                    }
-                }
-                else if (leastNodes.nodes[op].id == 404) {
-                    nodes[0] = mostNodes.nodes[op];
-                    nodes[1] = mostNodes.nodes[op];
-                    if (!flipped) {
-                        nodeAlpha[0] = NODE_FILL_COLOR.a;
-                        textAlpha[0] = TEXT_COLOR.a;
-                        nodeAlpha[1] = 0.f;
-                        textAlpha[1] = 0.f;
-                        nodeX[0] = nodes[0].coords.x;
-                        nodeY[0] = nodes[0].coords.y;
-                        nodeX[1] = xOrigin;
-                        nodeY[1] = yOrigin;
-                    }
-                    else {
-                        nodeAlpha[0] = 0.f;
-                        textAlpha[0] = 0.f;
-                        nodeAlpha[1] = NODE_FILL_COLOR.a;
-                        textAlpha[1] = TEXT_COLOR.a;
-                        nodeX[0] = xOrigin;
-                        nodeY[0] = yOrigin;
-                        nodeX[1] = nodes[0].coords.x;
-                        nodeY[1] = nodes[0].coords.y;
-                    }
+                nvgCircle(ctx, p.x, p.y, radius);
+                if (module->modeB && (horizontalMarks[scene].test(op) || horizontalMarks[morphScene].test(op))) {
+                    feedbackFillColor.a = alpha * NODE_FILL_COLOR.a;
+                    NVGcolor sceneColor = horizontalMarks[scene].test(op) ? feedbackFillColor : nodeFillColor;
+                    NVGcolor morphColor = horizontalMarks[morphScene].test(op) ? feedbackFillColor : nodeFillColor;
+                    NVGcolor fillColor = crossfadeColor(sceneColor, morphColor, morph);
+                    nvgFillColor(ctx, fillColor);
                 }
-                else {
-                    if (!flipped) {
-                        nodes[0] = mostNodes.nodes[op];
-                        nodes[1] = leastNodes.nodes[op];
-                    }
-                    else {
-                        nodes[0] = leastNodes.nodes[op];
-                        nodes[1] = mostNodes.nodes[op];
-                    }
-                    nodeAlpha[0] = NODE_FILL_COLOR.a;
-                    textAlpha[0] = TEXT_COLOR.a;
-                    nodeAlpha[1] = NODE_FILL_COLOR.a;
-                    textAlpha[1] = TEXT_COLOR.a;
-                    nodeX[0] = nodes[0].coords.x;
-                    nodeX[1] = nodes[1].coords.x;
-                    nodeY[0] = nodes[0].coords.y;
-                    nodeY[1] = nodes[1].coords.y;
-                }
-                if (draw) {
-                    nodeFillColor.a = crossfade(nodeAlpha[0], nodeAlpha[1], morph);
-                    nodeStrokeColor.a = crossfade(nodeAlpha[0], nodeAlpha[1], morph);
-                    textColor.a = crossfade(textAlpha[0], textAlpha[1], morph);
-
-                    nvgCircle(ctx,  crossfade(nodeX[0], nodeX[1], morph),
-                                    crossfade(nodeY[0], nodeY[1], morph),
-                                    radius);
-                    if (module->modeB && (horizontalMarks[scene].test(op) || horizontalMarks[morphScene].test(op))) {
-                        feedbackFillColor.a = crossfade(nodeAlpha[0], nodeAlpha[1], morph);
-                        NVGcolor sceneColor = horizontalMarks[scene].test(op) ? feedbackFillColor : nodeFillColor;
-                        NVGcolor morphColor = horizontalMarks[morphScene].test(op) ? feedbackFillColor : nodeFillColor;
-                        NVGcolor fillColor = crossfadeColor(sceneColor, morphColor, morph);
-                        nvgFillColor(ctx, fillColor);
-                    }
-                    else
-                        nvgFillColor(ctx, nodeFillColor);
-                    nvgFill(ctx);
-                    nvgStrokeColor(ctx, nodeStrokeColor);
-                    nvgStrokeWidth(ctx, nodeStroke);
-                    nvgStroke(ctx);
-
-                    bool sceneCarrierValue = forcedCarriers[scene].test(op) && !graphs[scene].mystery;
-                    bool morphCarrierValue = forcedCarriers[morphScene].test(op) && !graphs[morphScene].mystery;
-                    if (sceneCarrierValue || morphCarrierValue)  {
-                        float xOffset = module->rotor.getXoffset(radius);
-                        float yOffset = module->rotor.getYoffset(radius);
-                        nvgBeginPath(ctx);
-                        nvgCircle(ctx,  crossfade(nodeX[0] + xOffset, nodeX[1] + xOffset, morph),
-                                        crossfade(nodeY[0] + yOffset, nodeY[1] + yOffset, morph),
-                                        radius / 10.f);
-                        NVGcolor carrierColor = color::alpha(DLXExtraLightPurple, crossfade(sceneCarrierValue, morphCarrierValue, morph));
-                        nvgFillColor(ctx, carrierColor);
-                        nvgFill(ctx);
-                    }
+                else
+                    nvgFillColor(ctx, nodeFillColor);
+                nvgFill(ctx);
+                nvgStrokeColor(ctx, nodeStrokeColor);
+                nvgStrokeWidth(ctx, nodeStroke);
+                nvgStroke(ctx);
 
+                bool sceneCarrierValue = forcedCarriers[scene].test(op) && !graphs[scene].mystery;
+                bool morphCarrierValue = forcedCarriers[morphScene].test(op) && !graphs[morphScene].mystery;
+                if (sceneCarrierValue || morphCarrierValue)  {
+                    float xOffset = module->rotor.getXoffset(radius);
+                    float yOffset = module->rotor.getYoffset(radius);
                     nvgBeginPath(ctx);
-                    nvgFontSize(ctx, 11.f);
-                    nvgFontFaceId(ctx, font->handle);
-                    nvgFillColor(ctx, textColor);
-                    std::string s = std::to_string(op + 1);
-                    char const *id = s.c_str();
-                    nvgTextBounds(ctx, nodes[0].coords.x, nodes[0].coords.y, id, id + 1, textBounds);
-                    float xOffset = (textBounds[2] - textBounds[0]) / 2.f;
-                    float yOffset = (textBounds[3] - textBounds[1]) / 3.25f;
-                    nvgText(ctx,    crossfade(nodeX[0], nodeX[1], morph) - xOffset,
-                                    crossfade(nodeY[0], nodeY[1], morph) + yOffset,
-                                    id, id + 1);
+                    nvgCircle(ctx, p.x + xOffset, p.y + yOffset, radius / 10.f);
+                    NVGcolor carrierColor = color::alpha(DLXExtraLightPurple, crossfade(sceneCarrierValue, morphCarrierValue, morph));
+                    nvgFillColor(ctx, carrierColor);
+                    nvgFill(ctx);
                 }
+
+                nvgBeginPath(ctx);
+                nvgFontSize(ctx, 11.f);
+                nvgFontFaceId(ctx, font->handle);
+                nvgFillColor(ctx, textColor);
+                std::string s = std::to_string(op + 1);
+                char const *id = s.c_str();
+                nvgTextBounds(ctx, tween.nodeCoords[op].x, tween.nodeCoords[op].y, id, id + 1, textBounds);
+                float xOffset = (textBounds[2] - textBounds[0]) / 2.f;
+                float yOffset = (textBounds[3] - textBounds[1]) / 3.25f;
+                nvgText(ctx, p.x - xOffset, p.y + yOffset, id, id + 1);
             }
         };
 
-        void drawEdges(NVGcontext* ctx, alGraph source, alGraph destination, float morph) {
-            if (source >= destination)
-                renderEdges(ctx, source, destination, morph, false);
-            else
-                renderEdges(ctx, destination, source, morph, true);
-        };
+        void drawEdges(NVGcontext* ctx) {
+            for (int i = 0; i < tween.numEdges; i++) {
+                edgeColor = EDGE_COLOR;
+                edgeColor.a = crossfade(tween.edgeAlpha[i][0], tween.edgeAlpha[i][1], morph) * EDGE_COLOR.a;
 
-        void renderEdges(NVGcontext* ctx, alGraph mostEdges, alGraph leastEdges, float morph, bool flipped) {
-            for (int i = 0; i < mostEdges.numEdges; i++) {
-                Edge edge[2];
-                Arrow arrow[2];
                 nvgBeginPath(ctx);
-                if (leastEdges.numEdges == 0) {
-                    if (!flipped) {
-                        edge[0] = mostEdges.edges[i];
-                        edge[1] = leastEdges.edges[i];
-                        nvgMoveTo(ctx, crossfade(edge[0].moveCoords.x, xOrigin, morph), crossfade(edge[0].moveCoords.y, yOrigin, morph));
-                        edgeColor.a = crossfade(EDGE_COLOR.a, 0x00, morph);
-                    }
-                    else {
-                        edge[0] = leastEdges.edges[i];
-                        edge[1] = mostEdges.edges[i];
-                        nvgMoveTo(ctx, crossfade(xOrigin, edge[1].moveCoords.x, morph), crossfade(yOrigin, edge[1].moveCoords.y, morph));
-                        edgeColor.a = crossfade(0x00, EDGE_COLOR.a, morph);
-                    }
-                    arrow[0] = mostEdges.arrows[i];
-                    arrow[1] = leastEdges.arrows[i];
-                }
-                else if (i < leastEdges.numEdges) {
-                    if (!flipped) {
-                        edge[0] = mostEdges.edges[i];
-                        edge[1] = leastEdges.edges[i];
-                    }
-                    else {
-                        edge[0] = leastEdges.edges[i];
-                        edge[1] = mostEdges.edges[i];
-                    }
-                    nvgMoveTo(ctx, crossfade(edge[0].moveCoords.x, edge[1].moveCoords.x, morph), crossfade(edge[0].moveCoords.y, edge[1].moveCoords.y, morph));
-                    edgeColor = EDGE_COLOR;
-                    arrow[0] = mostEdges.arrows[i];
-                    arrow[1] = leastEdges.arrows[i];
-                }
-                else {
-                    if (!flipped) {
-                        edge[0] = mostEdges.edges[i];
-                        edge[1] = leastEdges.edges[std::max(0, leastEdges.numEdges - 1)];
-                    }
-                    else {
-                        edge[0] = leastEdges.edges[std::max(0, leastEdges.numEdges - 1)];
-                        edge[1] = mostEdges.edges[i];
-                    }
-                    nvgMoveTo(ctx, crossfade(edge[0].moveCoords.x, edge[1].moveCoords.x, morph), crossfade(edge[0].moveCoords.y, edge[1].moveCoords.y, morph));
-                    edgeColor = EDGE_COLOR;
-                    arrow[0] = mostEdges.arrows[i];
-                    arrow[1] = leastEdges.arrows[std::max(0, leastEdges.numEdges - 1)];
-                }
-                if (edge[0] >= edge[1]) {
-                    reticulateEdge(ctx, edge[0], edge[1], morph, false);
+                int k = tween.edgeStart[i];
+                Vec p = tween.getPoint(k++);
+                nvgMoveTo(ctx, p.x, p.y);
+                for (int j = 0; j < tween.edgeSegments[i]; j++) {
+                    Vec c1 = tween.getPoint(k++);
+                    Vec c2 = tween.getPoint(k++);
+                    p = tween.getPoint(k++);
+                    nvgBezierTo(ctx, c1.x, c1.y, c2.x, c2.y, p.x, p.y);
                 }
-                else {
-                    reticulateEdge(ctx, edge[1], edge[0], morph, true);
-                }
-
                 nvgStrokeColor(ctx, edgeColor);
                 nvgStrokeWidth(ctx, edgeStroke);
                 nvgStroke(ctx);
 
                 nvgBeginPath(ctx);
-                reticulateArrow(ctx, arrow[0], arrow[1], morph, flipped);
+                k = tween.arrowStart[i];
+                p = tween.getPoint(k++);
+                nvgMoveTo(ctx, p.x, p.y);
+                for (int j = 0; j < MorphTween::ARROW_POINTS - 1; j++) {
+                    p = tween.getPoint(k++);
+                    nvgLineTo(ctx, p.x, p.y);
+                }
                 nvgFillColor(ctx, edgeColor);
                 nvgFill(ctx);
                 nvgStrokeColor(ctx, edgeColor);
@@ -269,255 +186,282 @@ struct AlgomorphDisplayWidget : rack::widget::FramebufferWidget {
             }
         };
 
-        void reticulateEdge(NVGcontext* ctx, Edge mostCurved, Edge leastCurved, float morph, bool flipped) {
-            for (int j = 0; j < mostCurved.curveLength; j++) {
-                if (leastCurved.curveLength == 0) {
-                    if (!flipped)
-                        nvgBezierTo(ctx, crossfade(mostCurved.curve[j][0].x, xOrigin, morph), crossfade(mostCurved.curve[j][0].y, yOrigin, morph), crossfade(mostCurved.curve[j][1].x, xOrigin, morph), crossfade(mostCurved.curve[j][1].y, yOrigin, morph), crossfade(mostCurved.curve[j][2].x, xOrigin, morph), crossfade(mostCurved.curve[j][2].y, yOrigin, morph));
-                    else
-                        nvgBezierTo(ctx, crossfade(xOrigin, mostCurved.curve[j][0].x, morph), crossfade(yOrigin, mostCurved.curve[j][0].y, morph), crossfade(xOrigin, mostCurved.curve[j][1].x, morph), crossfade(yOrigin, mostCurved.curve[j][1].y, morph), crossfade(xOrigin, mostCurved.curve[j][2].x, morph), crossfade(yOrigin, mostCurved.curve[j][2].y, morph));
+        DisplayState getState() {
+            DisplayState newState;
+            newState.configMode = module->configMode;
+            newState.modeB = module->modeB;
+            newState.scene = scene;
+            newState.morphScene = morphScene;
+            newState.morph = morph;
+            for (int i = 0; i < SCENES; i++) {
+                newState.algoName[i] = translatedAlgoName[i];
+                newState.horizontalMarks[i] = horizontalMarks[i].to_ulong();
+                newState.forcedCarriers[i] = forcedCarriers[i].to_ulong();
+            }
+            // The forced carrier indicators orbit, so the rotor only matters while one is shown
+            if (forcedCarriers[scene].any() || (!module->configMode && forcedCarriers[morphScene].any()))
+                newState.rotorPhase = std::round(module->rotor.phase * DISPLAY_QUANTIZE_STEPS) / DISPLAY_QUANTIZE_STEPS;
+            newState.width = box.size.x;
+            newState.height = box.size.y;
+            return newState;
+        };
+
+        void drawGraph(NVGcontext* vg) {
+            nvgBeginPath(vg);
+            nvgRoundedRect(vg, box.getTopLeft().x, box.getTopLeft().y, box.size.x, box.size.y, 3.675f);
+            nvgStrokeWidth(vg, borderStroke);
+            nvgStroke(vg);
+
+            if (module->configMode) {   //Display state without morph
+                if (graphs[scene].numNodes > 0) {
+                    // Draw nodes
+                    if (module->modeB && horizontalMarks[scene].any()){
+                        for (int op = 0; op < OPS; op++) {
+                            if (graphs[scene].nodes[op].id != 404) {
+                                nvgBeginPath(vg);
+                                nvgCircle(vg, graphs[scene].nodes[op].coords.x, graphs[scene].nodes[op].coords.y, radius);
+                                if (horizontalMarks[scene].test(op))
+                                    nvgFillColor(vg, feedbackFillColor);
+                                else
+                                    nvgFillColor(vg, nodeFillColor);
+                                nvgFill(vg);
+                                nvgStrokeColor(vg, nodeStrokeColor);
+                                nvgStrokeWidth(vg, nodeStroke);
+                                nvgStroke(vg);
+                            }
+                        }
+                    }
+                    else {
+                        nvgBeginPath(vg);
+                        for (int op = 0; op < OPS; op++) {
+                            if (graphs[scene].nodes[op].id != 404)
+                                nvgCircle(vg, graphs[scene].nodes[op].coords.x, graphs[scene].nodes[op].coords.y, radius);
+                        }
+                        nvgFillColor(vg, nodeFillColor);
+                        nvgFill(vg);
+                        nvgStrokeColor(vg, nodeStrokeColor);
+                        nvgStrokeWidth(vg, nodeStroke);
+                        nvgStroke(vg);
+                    }
+
+                    if (forcedCarriers[scene].any()) {
+                        float xOffset = module->rotor.getXoffset(radius);
+                        float yOffset = module->rotor.getYoffset(radius);
+                        nvgBeginPath(vg);
+                        for (int op = 0; op < 4; op++) {
+                            if (forcedCarriers[scene].test(op)) {
+                                nvgCircle(vg,  graphs[scene].nodes[op].coords.x + xOffset,
+                                                graphs[scene].nodes[op].coords.y + yOffset,
+                                                radius / 10.f);
+                            }
+                        }
+                        nvgFillColor(vg, DLXExtraLightPurple);
+                        nvgFill(vg);
+                    }
+
+                    // Draw numbers
+                    nvgBeginPath(vg);
+                    nvgFontSize(vg, 11.f);
+                    nvgFontFaceId(vg, font->handle);
+                    nvgFillColor(vg, textColor);
+                    for (int op = 0; op < 4; op++) {
+                        if (graphs[scene].nodes[op].id != 404) {
+                            std::string s = std::to_string(op + 1);
+                            char const *id = s.c_str();
+                            nvgTextBounds(vg, graphs[scene].nodes[op].coords.x, graphs[scene].nodes[op].coords.y, id, id + 1, textBounds);
+                            float xOffset = (textBounds[2] - textBounds[0]) / 2.f;
+                            float yOffset = (textBounds[3] - textBounds[1]) / 3.25f;
+                            nvgText(vg, graphs[scene].nodes[op].coords.x - xOffset, graphs[scene].nodes[op].coords.y + yOffset, id, id + 1);
+                        }
+                    }
                 }
-                else if (j < leastCurved.curveLength) {
-                    if (!flipped)
-                        nvgBezierTo(ctx, crossfade(mostCurved.curve[j][0].x, leastCurved.curve[j][0].x, morph), crossfade(mostCurved.curve[j][0].y, leastCurved.curve[j][0].y, morph), crossfade(mostCurved.curve[j][1].x, leastCurved.curve[j][1].x, morph), crossfade(mostCurved.curve[j][1].y, leastCurved.curve[j][1].y, morph), crossfade(mostCurved.curve[j][2].x, leastCurved.curve[j][2].x, morph), crossfade(mostCurved.curve[j][2].y, leastCurved.curve[j][2].y, morph));
-                    else
-                        nvgBezierTo(ctx, crossfade(leastCurved.curve[j][0].x, mostCurved.curve[j][0].x, morph), crossfade(leastCurved.curve[j][0].y, mostCurved.curve[j][0].y, morph), crossfade(leastCurved.curve[j][1].x, mostCurved.curve[j][1].x, morph), crossfade(leastCurved.curve[j][1].y, mostCurved.curve[j][1].y, morph), crossfade(leastCurved.curve[j][2].x, mostCurved.curve[j][2].x, morph), crossfade(leastCurved.curve[j][2].y, mostCurved.curve[j][2].y, morph));
+            }
+            else {
+                // Draw nodes and numbers
+                updateTween();
+                drawNodes(vg);
+            }
+
+            // Draw error display
+            if (module->configMode) {
+                if (graphs[scene].mystery) {
+                    // Draw question mark
+                    nvgBeginPath(vg);
+                    nvgFontSize(vg, 92.f);
+                    nvgFontFaceId(vg, font->handle);
+                    textColor = TEXT_COLOR;
+                    nvgFillColor(vg, textColor);
+                    std::string s = "?";
+                    char const *id = s.c_str();
+                    nvgTextBounds(vg, xOrigin, yOrigin, id, id + 1, textBounds);
+                    float xOffset = (textBounds[2] - textBounds[0]) / 2.f + 1.f;
+                    float yOffset = (textBounds[3] - textBounds[1]) / 3.925f + 1.f;
+                    nvgText(vg, xOrigin - xOffset, yOrigin + yOffset, id, id + 1);
+
+                    // Draw message
+                    nvgBeginPath(vg);
+                    nvgFontSize(vg, 11.f);
+                    nvgFontFaceId(vg, font->handle);
+                    textColor = TEXT_COLOR;
+                    nvgFillColor(vg, textColor);
+                    s = "cannot visualize";
+                    id = s.c_str();
+                    nvgTextBounds(vg, xOrigin, yOrigin, id, id + s.length(), textBounds);
+                    xOffset = (textBounds[2] - textBounds[0]) / 2.f - 0.5f;
+                    yOffset = (textBounds[3] - textBounds[1]) * 1.315f;
+                    nvgText(vg, xOrigin - xOffset, yOffset, id, id + s.length());
+                    s = "no natural carrier";
+                    id = s.c_str();
+                    nvgTextBounds(vg, xOrigin, yOrigin, id, id + s.length(), textBounds);
+                    xOffset = (textBounds[2] - textBounds[0]) / 2.f - 0.5f;
+                    yOffset = (textBounds[3] - textBounds[1]) / 1.345f;
+                    nvgText(vg, xOrigin - xOffset, this->getBox().getBottom() - yOffset, id, id + s.length());
                 }
-                else {
-                    if (!flipped)
-                        nvgBezierTo(ctx, crossfade(mostCurved.curve[j][0].x, leastCurved.curve[leastCurved.curveLength - 1][0].x, morph), crossfade(mostCurved.curve[j][0].y, leastCurved.curve[leastCurved.curveLength - 1][0].y, morph), crossfade(mostCurved.curve[j][1].x, leastCurved.curve[leastCurved.curveLength - 1][1].x, morph), crossfade(mostCurved.curve[j][1].y, leastCurved.curve[leastCurved.curveLength - 1][1].y, morph), crossfade(mostCurved.curve[j][2].x, leastCurved.curve[leastCurved.curveLength - 1][2].x, morph), crossfade(mostCurved.curve[j][2].y, leastCurved.curve[leastCurved.curveLength - 1][2].y, morph));
+            }
+            else {
+                if (graphs[scene].mystery || graphs[morphScene].mystery) {
+                    nvgBeginPath(vg);
+                    nvgFontSize(vg, 92.f);
+                    nvgFontFaceId(vg, font->handle);
+                    if (graphs[scene].mystery && graphs[morphScene].mystery)
+                        textColor = TEXT_COLOR;
+                    else if (graphs[scene].mystery)
+                        textColor.a = crossfade(TEXT_COLOR.a, 0x00, morph);
                     else
-                        nvgBezierTo(ctx, crossfade(leastCurved.curve[leastCurved.curveLength - 1][0].x, mostCurved.curve[j][0].x, morph), crossfade(leastCurved.curve[leastCurved.curveLength - 1][0].y, mostCurved.curve[j][0].y, morph), crossfade(leastCurved.curve[leastCurved.curveLength - 1][1].x, mostCurved.curve[j][1].x, morph), crossfade(leastCurved.curve[leastCurved.curveLength - 1][1].y, mostCurved.curve[j][1].y, morph), crossfade(leastCurved.curve[leastCurved.curveLength - 1][2].x, mostCurved.curve[j][2].x, morph), crossfade(leastCurved.curve[leastCurved.curveLength - 1][2].y, mostCurved.curve[j][2].y, morph));
+                        textColor.a = crossfade(0x00, TEXT_COLOR.a, morph);
+                    nvgFillColor(vg, textColor);
+                    std::string s = "?";
+                    char const *id = s.c_str();
+                    nvgTextBounds(vg, xOrigin, yOrigin, id, id + 1, textBounds);
+                    float xOffset = (textBounds[2] - textBounds[0]) / 2.f + 1.f;
+                    float yOffset = (textBounds[3] - textBounds[1]) / 3.925f + 1.f;
+                    nvgText(vg, xOrigin - xOffset, yOrigin + yOffset, id, id + 1);
                 }
             }
-        };
 
-        void reticulateArrow(NVGcontext* ctx, Arrow mostGregarious, Arrow leastGregarious, float morph, bool flipped) {
-            if (leastGregarious.moveCoords.x == 0) {
-                if (!flipped)
-                    nvgMoveTo(ctx, crossfade(mostGregarious.moveCoords.x, xOrigin, morph), crossfade(mostGregarious.moveCoords.y, yOrigin, morph));
-                else
-                    nvgMoveTo(ctx, crossfade(xOrigin, mostGregarious.moveCoords.x, morph), crossfade(yOrigin, mostGregarious.moveCoords.y, morph));
-                for (int j = 0; j < 9; j++) {
-                    if (!flipped)
-                        nvgLineTo(ctx, crossfade(mostGregarious.lines[j].x, xOrigin, morph), crossfade(mostGregarious.lines[j].y, yOrigin, morph));
-                    else
-                        nvgLineTo(ctx, crossfade(xOrigin, mostGregarious.lines[j].x, morph), crossfade(yOrigin, mostGregarious.lines[j].y, morph));
+            // Draw edges +/ arrows
+            if (module->configMode) {
+                // Draw edges
+                nvgBeginPath(vg);
+                for (int i = 0; i < graphs[scene].numEdges; i++) {
+                    Edge edge = graphs[scene].edges[i];
+                    nvgMoveTo(vg, edge.moveCoords.x, edge.moveCoords.y);
+                    for (int j = 0; j < edge.curveLength; j++) {
+                        nvgBezierTo(vg, edge.curve[j][0].x, edge.curve[j][0].y, edge.curve[j][1].x, edge.curve[j][1].y, edge.curve[j][2].x, edge.curve[j][2].y);
+                    }
+                }
+                edgeColor = EDGE_COLOR;
+                nvgStrokeColor(vg, edgeColor);
+                nvgStrokeWidth(vg, edgeStroke);
+                nvgStroke(vg);
+                // Draw arrows
+                for (int i = 0; i < graphs[scene].numEdges; i++) {
+                    nvgBeginPath(vg);
+                    nvgMoveTo(vg, graphs[scene].arrows[i].moveCoords.x, graphs[scene].arrows[i].moveCoords.y);
+                    for (int j = 0; j < 9; j++)
+                        nvgLineTo(vg, graphs[scene].arrows[i].lines[j].x, graphs[scene].arrows[i].lines[j].y);
+                    edgeColor = EDGE_COLOR;
+                    nvgFillColor(vg, edgeColor);
+                    nvgFill(vg);
+                    nvgStrokeColor(vg, edgeColor);
+                    nvgStrokeWidth(vg, arrowStroke1);
+                    nvgStroke(vg);
                 }
             }
             else {
-                if (!flipped)
-                    nvgMoveTo(ctx, crossfade(mostGregarious.moveCoords.x, leastGregarious.moveCoords.x, morph), crossfade(mostGregarious.moveCoords.y, leastGregarious.moveCoords.y, morph));
-                else
-                    nvgMoveTo(ctx, crossfade(leastGregarious.moveCoords.x, mostGregarious.moveCoords.x, morph), crossfade(leastGregarious.moveCoords.y, mostGregarious.moveCoords.y, morph));
-                for (int j = 0; j < 9; j++) {
-                    if (!flipped)
-                        nvgLineTo(ctx, crossfade(mostGregarious.lines[j].x, leastGregarious.lines[j].x, morph), crossfade(mostGregarious.lines[j].y, leastGregarious.lines[j].y, morph));
-                    else
-                        nvgLineTo(ctx, crossfade(leastGregarious.lines[j].x, mostGregarious.lines[j].x, morph), crossfade(leastGregarious.lines[j].y, mostGregarious.lines[j].y, morph));
-                }
+                // Draw edges AND arrows
+                drawEdges(vg);
             }
         };
 
-        void drawLayer(const Widget::DrawArgs& args, int layer) override {
-            if (!module) return;
+        // -1 is a mystery graph, which can't be visualized
+        void setGraph(int scene, int graphId) {
+            translatedAlgoName[scene] = graphId;
+            if (graphId != -1)
+                graphs[scene] = alGraph(graphId);
+            else {
+                graphs[scene] = alGraph(1979);
+                graphs[scene].mystery = true;
+            }
+            tween.invalidate();
+        };
 
-            if (layer == 1) {
-                font = APP->window->loadFont(rack::asset::plugin(pluginInstance, fontPath));
+        // For states GRAPH_DATA has no graph for
+        void setLayoutGraph(int scene, int algoName, int forcedCarriers) {
+            translatedAlgoName[scene] = GraphLayoutCache::getKey(algoName, forcedCarriers);
+            graphs[scene] = GraphLayoutCache::shared().get(algoName, forcedCarriers);
+            tween.invalidate();
+        };
 
-                //Origin must be updated
-                xOrigin = box.size.x / 2.f;
-                yOrigin = box.size.y / 2.f;
-
-                for (int scene = 0; scene < SCENES; scene++) {
-                    if (!module->displayAlgoName[scene].empty()) {
-                        translatedAlgoName[scene] = module->graphAddressTranslation[module->displayAlgoName[scene].shift().to_ullong()];
-                        if (translatedAlgoName[scene] != -1)
-                            graphs[scene] = alGraph(translatedAlgoName[scene]);
-                        else {
-                            graphs[scene] = alGraph(1979);
-                            graphs[scene].mystery = true;
-                        }
-                    }
-                    if (!module->displayHorizontalMarks[scene].empty())
-                        horizontalMarks[scene] = module->displayHorizontalMarks[scene].shift();
-                    if (!module->displayForcedCarriers[scene].empty())
-                        forcedCarriers[scene] = module->displayForcedCarriers[scene].shift();
+        // Takes the latest state from the module's display buffers
+        void updateDisplayState() {
+            //Origin must be updated
+            xOrigin = box.size.x / 2.f;
+            yOrigin = box.size.y / 2.f;
+
+            for (int scene = 0; scene < SCENES; scene++) {
+                bool newGraph = false;
+                if (!module->displayAlgoName[scene].empty()) {
+                    displayName[scene] = module->displayAlgoName[scene].shift().to_ulong();
+                    newGraph = true;
                 }
+                if (!module->displayHorizontalMarks[scene].empty())
+                    horizontalMarks[scene] = module->displayHorizontalMarks[scene].shift();
+                if (!module->displayForcedCarriers[scene].empty()) {
+                    forcedCarriers[scene] = module->displayForcedCarriers[scene].shift();
+                    // Computed layouts place forced carriers
+                    if (translatedAlgoName[scene] >= GraphLayoutCache::getKey(0, 0))
+                        newGraph = true;
+                }
+                if (newGraph && displayName[scene] != -1) {
+                    int graphId = module->graphAddressTranslation[displayName[scene]];
+                    if (graphId != -1)
+                        setGraph(scene, graphId);
+                    else
+                        setLayoutGraph(scene, displayName[scene], forcedCarriers[scene].to_ulong());
+                }
+            }
 
-                if (!module->displayScene.empty()) {
-                    scene = module->displayScene.shift();
-                    if (scene != -1) {
-                        if (!module->displayMorphScene.empty())
-                            morphScene = module->displayMorphScene.shift();
-                        if (!module->displayMorph.empty())
-                            morph = module->displayMorph.shift();
-                    }
+            if (!module->displayScene.empty()) {
+                scene = module->displayScene.shift();
+                if (scene != -1) {
+                    if (!module->displayMorphScene.empty())
+                        morphScene = module->displayMorphScene.shift();
+                    if (!module->displayMorph.empty())
+                        morph = module->displayMorph.shift();
                 }
-                nvgBeginPath(args.vg);
-                nvgRoundedRect(args.vg, box.getTopLeft().x, box.getTopLeft().y, box.size.x, box.size.y, 3.675f);
-                nvgStrokeWidth(args.vg, borderStroke);
-                nvgStroke(args.vg);
-
-                if (module->configMode) {   //Display state without morph
-                    if (graphs[scene].numNodes > 0) {
-                        // Draw nodes
-                        if (module->modeB && horizontalMarks[scene].any()){
-                            for (int op = 0; op < OPS; op++) {
-                                if (graphs[scene].nodes[op].id != 404) {
-                                    nvgBeginPath(args.vg);
-                                    nvgCircle(args.vg, graphs[scene].nodes[op].coords.x, graphs[scene].nodes[op].coords.y, radius);
-                                    if (horizontalMarks[scene].test(op))
-                                        nvgFillColor(args.vg, feedbackFillColor);
-                                    else
-                                        nvgFillColor(args.vg, nodeFillColor);
-                                    nvgFill(args.vg);
-                                    nvgStrokeColor(args.vg, nodeStrokeColor);
-                                    nvgStrokeWidth(args.vg, nodeStroke);
-                                    nvgStroke(args.vg);
-                                }
-                            }
-                        }
-                        else {
-                            nvgBeginPath(args.vg);
-                            for (int op = 0; op < OPS; op++) {
-                                if (graphs[scene].nodes[op].id != 404)
-                                    nvgCircle(args.vg, graphs[scene].nodes[op].coords.x, graphs[scene].nodes[op].coords.y, radius);
-                            }
-                            nvgFillColor(args.vg, nodeFillColor);
-                            nvgFill(args.vg);
-                            nvgStrokeColor(args.vg, nodeStrokeColor);
-                            nvgStrokeWidth(args.vg, nodeStroke);
-                            nvgStroke(args.vg);
-                        }
+            }
+            // Quantize so that morph changes too small to see don't count as new frames
+            morph = std::round(morph * DISPLAY_QUANTIZE_STEPS) / DISPLAY_QUANTIZE_STEPS;
+        };
 
-                        if (forcedCarriers[scene].any()) {
-                            float xOffset = module->rotor.getXoffset(radius);
-                            float yOffset = module->rotor.getYoffset(radius);
-                            nvgBeginPath(args.vg);
-                            for (int op = 0; op < 4; op++) {
-                                if (forcedCarriers[scene].test(op)) {
-                                    nvgCircle(args.vg,  graphs[scene].nodes[op].coords.x + xOffset,
-                                                    graphs[scene].nodes[op].coords.y + yOffset,
-                                                    radius / 10.f);
-                                }
-                            }
-                            nvgFillColor(args.vg, DLXExtraLightPurple);
-                            nvgFill(args.vg);
-                        }
+        void drawLayer(const Widget::DrawArgs& args, int layer) override {
+            if (!module) return;
 
-                        // Draw numbers
-                        nvgBeginPath(args.vg);
-                        nvgFontSize(args.vg, 11.f);
-                        nvgFontFaceId(args.vg, font->handle);
-                        nvgFillColor(args.vg, textColor);
-                        for (int op = 0; op < 4; op++) {
-                            if (graphs[scene].nodes[op].id != 404) {
-                                std::string s = std::to_string(op + 1);
-                                char const *id = s.c_str();
-                                nvgTextBounds(args.vg, graphs[scene].nodes[op].coords.x, graphs[scene].nodes[op].coords.y, id, id + 1, textBounds);
-                                float xOffset = (textBounds[2] - textBounds[0]) / 2.f;
-                                float yOffset = (textBounds[3] - textBounds[1]) / 3.25f;
-                                nvgText(args.vg, graphs[scene].nodes[op].coords.x - xOffset, graphs[scene].nodes[op].coords.y + yOffset, id, id + 1);
-                            }
-                        }
-                    }
-                }
-                else {
-                    // Draw nodes and numbers
-                    nvgBeginPath(args.vg);
-                    drawNodes(args.vg, graphs[scene], graphs[morphScene], morph);
-                }
+            if (layer == 1 && !module->panelQuiet) {
+                font = APP->window->loadFont(rack::asset::plugin(pluginInstance, fontPath));
 
-                // Draw error display
-                if (module->configMode) {
-                    if (graphs[scene].mystery) {
-                        // Draw question mark
-                        nvgBeginPath(args.vg);
-                        nvgFontSize(args.vg, 92.f);
-                        nvgFontFaceId(args.vg, font->handle);
-                        textColor = TEXT_COLOR;
-                        nvgFillColor(args.vg, textColor);
-                        std::string s = "?";
-                        char const *id = s.c_str();
-                        nvgTextBounds(args.vg, xOrigin, yOrigin, id, id + 1, textBounds);
-                        float xOffset = (textBounds[2] - textBounds[0]) / 2.f + 1.f;
-                        float yOffset = (textBounds[3] - textBounds[1]) / 3.925f + 1.f;
-                        nvgText(args.vg, xOrigin - xOffset, yOrigin + yOffset, id, id + 1);
-
-                        // Draw message
-                        nvgBeginPath(args.vg);
-                        nvgFontSize(args.vg, 11.f);
-                        nvgFontFaceId(args.vg, font->handle);
-                        textColor = TEXT_COLOR;
-                        nvgFillColor(args.vg, textColor);
-                        s = "cannot visualize";
-                        id = s.c_str();
-                        nvgTextBounds(args.vg, xOrigin, yOrigin, id, id + s.length(), textBounds);
-                        xOffset = (textBounds[2] - textBounds[0]) / 2.f - 0.5f;
-                        yOffset = (textBounds[3] - textBounds[1]) * 1.315f;
-                        nvgText(args.vg, xOrigin - xOffset, yOffset, id, id + s.length());
-                        s = "no natural carrier";
-                        id = s.c_str();
-                        nvgTextBounds(args.vg, xOrigin, yOrigin, id, id + s.length(), textBounds);
-                        xOffset = (textBounds[2] - textBounds[0]) / 2.f - 0.5f;
-                        yOffset = (textBounds[3] - textBounds[1]) / 1.345f;
-                        nvgText(args.vg, xOrigin - xOffset, this->getBox().getBottom() - yOffset, id, id + s.length());
-                    }
-                }
-                else {
-                    if (graphs[scene].mystery || graphs[morphScene].mystery) {
-                        nvgBeginPath(args.vg);
-                        nvgFontSize(args.vg, 92.f);
-                        nvgFontFaceId(args.vg, font->handle);
-                        if (graphs[scene].mystery && graphs[morphScene].mystery)
-                            textColor = TEXT_COLOR;
-                        else if (graphs[scene].mystery)
-                            textColor.a = crossfade(TEXT_COLOR.a, 0x00, morph);
-                        else
-                            textColor.a = crossfade(0x00, TEXT_COLOR.a, morph);
-                        nvgFillColor(args.vg, textColor);
-                        std::string s = "?";
-                        char const *id = s.c_str();
-                        nvgTextBounds(args.vg, xOrigin, yOrigin, id, id + 1, textBounds);
-                        float xOffset = (textBounds[2] - textBounds[0]) / 2.f + 1.f;
-                        float yOffset = (textBounds[3] - textBounds[1]) / 3.925f + 1.f;
-                        nvgText(args.vg, xOrigin - xOffset, yOrigin + yOffset, id, id + 1);
-                    }
-                }
+                updateDisplayState();
 
-                // Draw edges +/ arrows
-                if (module->configMode) {
-                    // Draw edges
-                    nvgBeginPath(args.vg);
-                    for (int i = 0; i < graphs[scene].numEdges; i++) {
-                        Edge edge = graphs[scene].edges[i];
-                        nvgMoveTo(args.vg, edge.moveCoords.x, edge.moveCoords.y);
-                        for (int j = 0; j < edge.curveLength; j++) {
-                            nvgBezierTo(args.vg, edge.curve[j][0].x, edge.curve[j][0].y, edge.curve[j][1].x, edge.curve[j][1].y, edge.curve[j][2].x, edge.curve[j][2].y);
-                        }
-                    }
-                    edgeColor = EDGE_COLOR;
-                    nvgStrokeColor(args.vg, edgeColor);
-                    nvgStrokeWidth(args.vg, edgeStroke);
-                    nvgStroke(args.vg);
-                    // Draw arrows
-                    for (int i = 0; i < graphs[scene].numEdges; i++) {
-                        nvgBeginPath(args.vg);
-                        nvgMoveTo(args.vg, graphs[scene].arrows[i].moveCoords.x, graphs[scene].arrows[i].moveCoords.y);
-                        for (int j = 0; j < 9; j++)
-                            nvgLineTo(args.vg, graphs[scene].arrows[i].lines[j].x, graphs[scene].arrows[i].lines[j].y);
-                        edgeColor = EDGE_COLOR;
-                        nvgFillColor(args.vg, edgeColor);
-                        nvgFill(args.vg);
-                        nvgStrokeColor(args.vg, edgeColor);
-                        nvgStrokeWidth(args.vg, arrowStroke1);
-                        nvgStroke(args.vg);
-                    }
+                // Screenshots and the Module Browser get drawn directly
+                if (args.fb) {
+                    drawGraph(args.vg);
                 }
                 else {
-                    // Draw edges AND arrows
-                    drawEdges(args.vg, graphs[scene], graphs[morphScene], morph);
+                    DisplayState newState = getState();
+                    double now = rack::system::getTime();
+                    int frameRate = module->displayFrameRate;
+                    bool due = forceRender || frameRate <= 0 || now - lastRenderTime >= 1.0 / frameRate;
+                    if (due && std::memcmp(&state, &newState, sizeof(DisplayState))) {
+                        state = newState;
+                        revision++;
+                        lastRenderTime = now;
+                        forceRender = false;
+                    }
+                    // Only re-renders when the revision or the zoom changed
+                    graphCache.drawHalo(args, box.zeroPos().grow(Vec(1.f, 1.f)), nvgRGB(0xff, 0xff, 0xff), revision, [this](NVGcontext* vg, NVGcolor tint) {
+                        drawGraph(vg);
+                    });
                 }
             }
 
@@ -538,6 +482,7 @@ struct AlgomorphDisplayWidget : rack::widget::FramebufferWidget {
         if (module && module->graphDirty) {
             FramebufferWidget::dirty = true;
             w->box.size = box.size;
+            w->forceRender = true;
             module->graphDirty = false;
         }
         FramebufferWidget::step();
@@ -3,6 +3,7 @@
 #include "AlgomorphAuxInputPanelWidget.hpp"
 #include "ConnectionBgWidget.hpp"
 #include "Components.hpp"
+#include "PatchState.hpp"
 #include "plugin.hpp" // For constants
 #include <rack.hpp>
 using rack::math::crossfade;
@@ -15,6 +16,18 @@ using rack::construct;
 using rack::RACK_GRID_WIDTH;
 
 
+// The light engine writes lights by slot, so the shared part of LightIds must keep its order
+static_assert(AlgomorphLarge::OPERATOR_LIGHTS == LightSlots::OPERATOR_LIGHTS && AlgomorphLarge::EDIT_LIGHT == LightSlots::EDIT_LIGHT, "LightIds out of sync with LightSlots");
+
+// A size that isn't one of BLOCK_SIZES routes per sample
+static int validBlockSize(int size) {
+    for (int valid : BLOCK_SIZES) {
+        if (size == valid)
+            return size;
+    }
+    return 0;
+}
+
 AlgomorphLarge::AlgomorphLarge() {
     config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
 
@@ -59,7 +72,7 @@ AlgomorphLarge::AlgomorphLarge() {
     configOutput(MODULATOR_SUM_OUTPUT, "Modulator Sum");
     configOutput(PHASE_OUTPUT, "Phase");
 
-    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+    for (int auxIndex = 0; auxIndex < NUM_AUX_SOURCES; auxIndex++)
         auxInput[auxIndex] = new AuxInput(auxIndex, this);
     
     for (int i = 0; i < NUM_AUX_INPUTS; i++)
@@ -67,6 +80,11 @@ AlgomorphLarge::AlgomorphLarge() {
 
     runClickFilter.setRiseFall(400.f, 400.f);
 
+    rightExpander.producerMessage = &wideInputMessages[0];
+    rightExpander.consumerMessage = &wideInputMessages[1];
+    leftExpander.producerMessage = &leftMessages[0];
+    leftExpander.consumerMessage = &leftMessages[1];
+
     for (int i = 0; i < 4; i++) {
         auxInput[i]->shadowClickFilter[i].setRiseFall(DEF_CLICK_FILTER_SLEW, DEF_CLICK_FILTER_SLEW);
         for (int c = 0; c < 16; c++) {
@@ -74,6 +92,14 @@ AlgomorphLarge::AlgomorphLarge() {
             auxInput[i]->wildcardSumClickFilter[c].setRiseFall(DEF_CLICK_FILTER_SLEW, DEF_CLICK_FILTER_SLEW);
         }
     }
+    for (int auxIndex = NUM_AUX_INPUTS; auxIndex < NUM_AUX_SOURCES; auxIndex++) {
+        for (int op = 0; op < 4; op++)
+            auxInput[auxIndex]->shadowClickFilter[op].setRiseFall(DEF_CLICK_FILTER_SLEW, DEF_CLICK_FILTER_SLEW);
+        for (int c = 0; c < 16; c++) {
+            auxInput[auxIndex]->wildcardModClickFilter[c].setRiseFall(DEF_CLICK_FILTER_SLEW, DEF_CLICK_FILTER_SLEW);
+            auxInput[auxIndex]->wildcardSumClickFilter[c].setRiseFall(DEF_CLICK_FILTER_SLEW, DEF_CLICK_FILTER_SLEW);
+        }
+    }
 
     AlgomorphLarge::onReset();
 }
@@ -89,6 +115,11 @@ void AlgomorphLarge::onReset() {
         auxInput[auxIndex]->resetVoltages();
         auxInput[auxIndex]->allowMultipleModes = pluginSettings.allowMultipleModes[auxIndex];
     }
+    //Lanes get their modes back from the expander on the next sample
+    for (int auxIndex = NUM_AUX_INPUTS; auxIndex < NUM_AUX_SOURCES; auxIndex++) {
+        auxInput[auxIndex]->clearAuxModes();
+        auxInput[auxIndex]->resetVoltages();
+    }
 
     for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
         for (int mode = 0; mode < AuxInputModes::NUM_MODES; mode++) {
@@ -104,13 +135,18 @@ void AlgomorphLarge::onReset() {
     resetScene = 1;
     ccwSceneSelection = true;
     wildModIsSummed =  false;
+    followLeader = false;
+    quietFollower = false;
+    bankSlot = 0;
+    cvBankSlot = NULL;
+    blockSize = 0;
 }
 
 void AlgomorphLarge::unsetAuxMode(int auxIndex, int mode) {
     auxInput[auxIndex]->unsetAuxMode(mode);
 
     auxModeFlags[mode] = false;
-    for (int i = 0; i < NUM_AUX_INPUTS; i++) {
+    for (int i = 0; i < NUM_AUX_SOURCES; i++) {
         if (i != auxIndex)
             if (auxInput[i]->modeIsActive[mode]) {
                 auxModeFlags[mode] = true;
@@ -122,6 +158,20 @@ void AlgomorphLarge::unsetAuxMode(int auxIndex, int mode) {
 }
 
 void AlgomorphLarge::process(const ProcessArgs& args) {
+    // Block size, whether a block can be routed in one go, and undone scenes only change between blocks
+    if (blockPos == 0) {
+        processSceneRequests();
+        if (activeBlockSize != blockSize) {
+            activeBlockSize = blockSize;
+            block.clearOutputs();
+        }
+        blockRouting = activeBlockSize > 0 && canRouteBlock();
+    }
+    if (blockRouting) {
+        processBlockFrame(args);
+        return;
+    }
+
     float in[16] = {0.f};                                   // Operator input channels
     float modOut[4][16] = {{0.f}};                          // Modulator outputs & channels
     float carSumOut[16] = {0.f};                            // Carrier sum output channels
@@ -129,38 +179,499 @@ void AlgomorphLarge::process(const ProcessArgs& args) {
     float phaseOut[16] = {0.f};                             // Phase output channels
     int sceneOffset[16] = {0};                              // Offset to the base scene
     bool processCV = cvDivider.process();
+    int64_t debugFrameStart = 0, debugSectionStart = 0;
+    if (debug)
+        debugFrameStart = debugSectionStart = debugStats.startFrame();
 
-    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
-        if (inputs[AUX_INPUTS + auxIndex].isConnected()) {
-            auxInput[auxIndex]->connected = true;
-            auxInput[auxIndex]->updateVoltage();
-        }
-        else {
-            if (auxInput[auxIndex]->connected) {
-                auxInput[auxIndex]->connected = false;
-                auxInput[auxIndex]->resetVoltages();
-                running = true;
-                rescaleVoltages(16);
-            }
-        }
+    // Algomorph AUX lanes, read in place from the expander's message
+    const AuxLaneMessage* auxLanes = NULL;
+    if (leftExpander.module && leftExpander.module->model == modelAlgomorphAux) {
+        auxLanes = &((const LeftExpanderMessage*) leftExpander.consumerMessage)->aux;
+        if (!auxLanes->valid)
+            auxLanes = NULL;
+    }
+    bool delayAuxInputs = auxLanes && auxLanes->compensate;
+
+    readAuxInputs(delayAuxInputs);
+    if (auxLanes || auxSources > NUM_AUX_INPUTS)
+        updateAuxLanes(auxLanes);
+
+    // Linked instances: a follower routes with the state of the Algomorph Advance on its left
+    const LinkMessage* link = NULL;
+    if (followLeader && leftExpander.module && leftExpander.module->model == modelAlgomorphLarge) {
+        link = &((const LeftExpanderMessage*) leftExpander.consumerMessage)->link;
+        if (!link->valid)
+            link = NULL;
+    }
+    setPanelQuiet(link && quietFollower);
+
+    // Algomorph Wide voice groups, routed with this module's per-channel state
+    AlgomorphWide* wide = NULL;
+    const WideInputMessage* wideIn = NULL;
+    if (rightExpander.module && rightExpander.module->model == modelAlgomorphWide) {
+        wide = (AlgomorphWide*) rightExpander.module;
+        wideIn = (const WideInputMessage*) rightExpander.consumerMessage;
     }
 
     this->channels = 1;
+    bool opConnected[4];
     for (int i = 0; i < 4; i++) {
         //Determine polyphony count
         if (this->channels < inputs[OPERATOR_INPUTS + i].getChannels()) 
             this->channels = inputs[OPERATOR_INPUTS + i].getChannels();
         if (this->channels < inputs[AUX_INPUTS + i].getChannels())
             this->channels = inputs[AUX_INPUTS + i].getChannels();
+        // An operator connected on any voice group keeps its routing gains running
+        opConnected[i] = inputs[OPERATOR_INPUTS + i].isConnected();
+        if (wide) {
+            for (int group = 0; group < WIDE_GROUPS; group++) {
+                this->channels = std::max(this->channels, wideIn->channels[group][i]);
+                opConnected[i] |= wideIn->channels[group][i] > 0;
+            }
+        }
     }
-    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+    if (auxLanes) {
+        for (int lane = 0; lane < NUM_AUX_LANES; lane++)
+            this->channels = std::max(this->channels, auxLanes->channels[lane]);
+    }
+    for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
         auxInput[auxIndex]->channels = this->channels;
 
     for (int c = 0; c < this->channels; c++)
         totalCarSumConnection[c] = 0.f;
 
+    if (debug)
+        debugSectionStart = debugStats.add(DebugSections::AUX, debugSectionStart);
+
+    processControl(processCV, clickFilterDivider.process(), link, sceneOffset, phaseOut, debugSectionStart);
+
+    //Get operator input channel then route to modulation output channel or to sum output channel
+    float wildcardMod[16] = {0.f};
+    float wildcardSum[16] = {0.f};
+    float runClickFilterGain;
+    if (runSilencer)
+        runClickFilterGain = runClickFilter.process(args.sampleTime, running);
+    else
+        runClickFilterGain = 1.f;
+    if (auxModeFlags[AuxInputModes::MOD_ATTEN])
+        rescaleVoltage(AuxInputModes::MOD_ATTEN, this->channels);
+    if (auxModeFlags[AuxInputModes::SUM_ATTEN])
+        rescaleVoltage(AuxInputModes::SUM_ATTEN, this->channels);
+    float modGain = params[AUX_KNOBS + AuxKnobModes::MOD_GAIN].getValue();
+    float sumGain = params[AUX_KNOBS + AuxKnobModes::SUM_GAIN].getValue();
+    float wildcardModGain = params[AUX_KNOBS + AuxKnobModes::WILDCARD_MOD_GAIN].getValue();
+    float modAttenuversion[16] = {1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f};
+    if (auxModeFlags[AuxInputModes::MOD_ATTEN]) {
+        for (int c = 0; c < this->channels; c++)
+            modAttenuversion[c] *= scaledAuxVoltage[AuxInputModes::MOD_ATTEN][c];
+    }
+    float sumAttenuversion[16] = {1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f};
+    if (auxModeFlags[AuxInputModes::SUM_ATTEN]) {
+        for (int c = 0; c < this->channels; c++)
+            sumAttenuversion[c] *= scaledAuxVoltage[AuxInputModes::SUM_ATTEN][c];
+    }
+    for (int i = 0; i < 4; i++) {
+        if (auxModeFlags[AuxInputModes::SHADOW + i])
+            scaleAuxShadow(args.sampleTime, i, this->channels);
+    }
+    updateMorphWeights(this->channels);
+    if (avgMode)
+        updateSumNorms(this->channels);
+    // Average mode is folded into the sum gains
+    float carSumScale[16] = {0.f};
+    float modSumScale[16] = {0.f};
+    for (int c = 0; c < this->channels; c++) {
+        float sumScale = sumAttenuversion[c] * sumGain * runClickFilterGain;
+        modSumScale[c] = avgMode ? sumScale * modSumNorm[c] : sumScale;
+        for (int i = 0; i < 4; i++) {
+            if (opConnected[i]) {
+                in[c] = inputs[OPERATOR_INPUTS + i].getPolyVoltage(c) * params[AUX_KNOBS + AuxKnobModes::OP_GAIN].getValue();
+                float shadowed = in[c] + scaledAuxVoltage[AuxInputModes::SHADOW + i][c];
+                //Check current algorithm and morph target
+                if (modeB)
+                    modOut[i][c] += shadowed * stepModGain(args.sampleTime, i, i, horizontalTarget(i, c), horizontalRingTarget(i, c), c);
+                for (int j = 0; j < 3; j++) {
+                    int dest = relToAbs[i][j];
+                    float diagonal = shadowed * stepModGain(args.sampleTime, i, dest, diagonalTarget(i, j, c), diagonalRingTarget(i, j, c), c);
+                    if (ringMorph) {
+                        // Ring morph adds the shadow input to its share of the diagonals, and in mode B routes an
+                        // unshadowed operator's diagonals back to its own output
+                        diagonal += 2.f * scaledAuxVoltage[AuxInputModes::SHADOW + i][c] * modRingClickGain[i][dest][c];
+                        if (modeB && !auxModeFlags[AuxInputModes::SHADOW + i])
+                            dest = i;
+                    }
+                    modOut[dest][c] += diagonal;
+                }
+                carSumOut[c] += shadowed * stepSumGain(args.sampleTime, i, sumTarget(i, c), sumRingTarget(i, c), c);
+            }
+            // Ring morph applies the output gains as each operator is routed, as well as below
+            if (ringMorph) {
+                modOut[i][c] *= modAttenuversion[c] * modGain * runClickFilterGain;
+                carSumOut[c] *= sumAttenuversion[c] * sumGain * runClickFilterGain;
+            }
+        }
+        for (int mod = 0; mod < 4; mod++)
+            modSumOut[c] += modOut[mod][c] * modSumScale[c];
+        if (auxModeFlags[AuxInputModes::WILDCARD_MOD]) {
+            for (int auxIndex = 0; auxIndex < auxSources; auxIndex++) {
+                auxInput[auxIndex]->wildcardModClickGain = (clickFilterEnabled ? auxInput[auxIndex]->wildcardModClickFilter[c].process(args.sampleTime, auxInput[auxIndex]->modeIsActive[AuxInputModes::WILDCARD_MOD]) : auxInput[auxIndex]->modeIsActive[AuxInputModes::WILDCARD_MOD]);
+                wildcardMod[c] += auxInput[auxIndex]->voltage[AuxInputModes::WILDCARD_MOD][c] * auxInput[auxIndex]->wildcardModClickGain;
+            }
+            for (int mod = 0; mod < 4; mod++) {
+                modOut[mod][c] += wildcardMod[c] * wildcardModGain;
+            }
+            if (wildModIsSummed)
+                modSumOut[c] += wildcardMod[c] * wildcardModGain * modSumScale[c];
+        }
+        for (int mod = 0; mod < 4; mod++)
+            modOut[mod][c] *= runClickFilterGain * modAttenuversion[c] * modGain;
+        if (auxModeFlags[AuxInputModes::WILDCARD_SUM]) {
+            for (int auxIndex = 0; auxIndex < auxSources; auxIndex++) {
+                auxInput[auxIndex]->wildcardSumClickGain = (clickFilterEnabled ? auxInput[auxIndex]->wildcardSumClickFilter[c].process(args.sampleTime, auxInput[auxIndex]->modeIsActive[AuxInputModes::WILDCARD_SUM]) : auxInput[auxIndex]->modeIsActive[AuxInputModes::WILDCARD_SUM]);
+                wildcardSum[c] += auxInput[auxIndex]->voltage[AuxInputModes::WILDCARD_SUM][c] * auxInput[auxIndex]->wildcardSumClickGain;
+            }
+            carSumOut[c] += wildcardSum[c];
+        }
+        // The carrier total depends on the click filters, so it is the one division left per channel
+        if (avgMode)
+            carSumScale[c] = totalCarSumConnection[c] == 0 ? 0.f : sumScale * carSumNorm[c] / totalCarSumConnection[c];
+        else
+            carSumScale[c] = sumScale;
+        carSumOut[c] *= carSumScale[c];
+    }
+
+    if (wide) {
+        float modScale[16];
+        for (int c = 0; c < 16; c++)
+            modScale[c] = modAttenuversion[c] * modGain * runClickFilterGain;
+        processWide(wideIn, (WideOutputMessage*) wide->leftExpander.producerMessage, modScale, carSumScale, modSumScale, wildcardMod, wildcardSum, wildcardModGain);
+        wide->leftExpander.requestMessageFlip();
+    }
+
+    //Set outputs
+    for (int i = 0; i < 4; i++) {
+        if (outputs[MODULATOR_OUTPUTS + i].isConnected()) {
+            outputs[MODULATOR_OUTPUTS + i].setChannels(this->channels);
+            outputs[MODULATOR_OUTPUTS + i].writeVoltages(modOut[i]);
+        }
+    }
+    if (outputs[CARRIER_SUM_OUTPUT].isConnected()) {
+        outputs[CARRIER_SUM_OUTPUT].setChannels(this->channels);
+        outputs[CARRIER_SUM_OUTPUT].writeVoltages(carSumOut);
+    }
+    if (outputs[MODULATOR_SUM_OUTPUT].isConnected()) {
+        outputs[MODULATOR_SUM_OUTPUT].setChannels(this->channels);
+        outputs[MODULATOR_SUM_OUTPUT].writeVoltages(modSumOut);
+    }
+    if (outputs[PHASE_OUTPUT].isConnected()) {
+        outputs[PHASE_OUTPUT].setChannels(this->channels);
+        outputs[PHASE_OUTPUT].writeVoltages(phaseOut);
+    }
+    if (activeBlockSize > 0)
+        delayOutputs();
+
+    if (debug)
+        debugSectionStart = debugStats.add(DebugSections::ROUTING, debugSectionStart);
+
+    updatePanel(args, sceneOffset[0]);
+
+    if (clockIgnoreOnReset > 0l)
+        clockIgnoreOnReset--;
+
+    if (debug) {
+        debugStats.add(DebugSections::LIGHTS, debugSectionStart);
+        debugStats.countScene(centerMorphScene[0]);
+        debugStats.endFrame(debugFrameStart, args.sampleRate);
+    }
+
+    recordTelemetry(args.frame);
+}
+
+// Block routing covers the operators and the AUX modes that act on control. Shadow and Wildcard inputs are audio, and
+// expanders and links trade messages every sample, so with any of them the block is routed per sample instead. So is
+// ring morph, which scales its outputs as each operator is routed. Audio modes on unpatched jacks add nothing, so they
+// don't count.
+bool AlgomorphLarge::canRouteBlock() {
+    if (ringMorph)
+        return false;
+    if (auxSources > NUM_AUX_INPUTS)
+        return false;
+    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
+        if (!inputs[AUX_INPUTS + auxIndex].isConnected())
+            continue;
+        if (auxInput[auxIndex]->modeIsActive[AuxInputModes::WILDCARD_MOD] || auxInput[auxIndex]->modeIsActive[AuxInputModes::WILDCARD_SUM])
+            return false;
+        for (int op = 0; op < 4; op++) {
+            if (auxInput[auxIndex]->modeIsActive[AuxInputModes::SHADOW + op])
+                return false;
+        }
+    }
+    if (leftExpander.module && (leftExpander.module->model == modelAlgomorphAux || (followLeader && leftExpander.module->model == modelAlgomorphLarge)))
+        return false;
+    if (rightExpander.module && rightExpander.module->model == modelAlgomorphWide)
+        return false;
+    if (rightExpander.module && rightExpander.module->model == modelAlgomorphLarge && ((AlgomorphLarge*) rightExpander.module)->followLeader)
+        return false;
+    return true;
+}
+
+// Block mode, every sample: sends out the outputs routed from the last block and keeps this sample's inputs, AUX
+// voltages and divider ticks in their slot. On the block's last sample, control runs over each of its frames in turn,
+// so morph and triggers land on the frame they belong to, then the whole block is routed.
+void AlgomorphLarge::processBlockFrame(const ProcessArgs& args) {
+    int64_t debugFrameStart = 0, debugSectionStart = 0;
+    if (debug)
+        debugFrameStart = debugSectionStart = debugStats.startFrame();
+
+    if (blockPos == 0) {
+        setPanelQuiet(false);
+        blockChannels = 1;
+    }
+    block.processCV[blockPos] = cvDivider.process();
+    block.rearmClickFilters[blockPos] = clickFilterDivider.process();
+
+    int outChannels = block.channels[blockPos];
+    for (int i = 0; i < 4; i++) {
+        if (outputs[MODULATOR_OUTPUTS + i].isConnected()) {
+            outputs[MODULATOR_OUTPUTS + i].setChannels(outChannels);
+            for (int c = 0; c < outChannels; c++)
+                outputs[MODULATOR_OUTPUTS + i].setVoltage(block.modOut[i][c][blockPos], c);
+        }
+    }
+    if (outputs[CARRIER_SUM_OUTPUT].isConnected()) {
+        outputs[CARRIER_SUM_OUTPUT].setChannels(outChannels);
+        for (int c = 0; c < outChannels; c++)
+            outputs[CARRIER_SUM_OUTPUT].setVoltage(block.carSumOut[c][blockPos], c);
+    }
+    if (outputs[MODULATOR_SUM_OUTPUT].isConnected()) {
+        outputs[MODULATOR_SUM_OUTPUT].setChannels(outChannels);
+        for (int c = 0; c < outChannels; c++)
+            outputs[MODULATOR_SUM_OUTPUT].setVoltage(block.modSumOut[c][blockPos], c);
+    }
+    if (outputs[PHASE_OUTPUT].isConnected()) {
+        outputs[PHASE_OUTPUT].setChannels(outChannels);
+        for (int c = 0; c < outChannels; c++)
+            outputs[PHASE_OUTPUT].setVoltage(block.phaseOut[c][blockPos], c);
+    }
+
+    for (int i = 0; i < 4; i++) {
+        blockChannels = std::max(blockChannels, inputs[OPERATOR_INPUTS + i].getChannels());
+        blockChannels = std::max(blockChannels, inputs[AUX_INPUTS + i].getChannels());
+        for (int c = 0; c < CHANNELS; c++)
+            block.in[i][c][blockPos] = inputs[OPERATOR_INPUTS + i].getPolyVoltage(c);
+    }
+    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
+        if (inputs[AUX_INPUTS + auxIndex].isConnected()) {
+            for (int c = 0; c < CHANNELS; c++)
+                block.aux[auxIndex][blockPos][c] = inputs[AUX_INPUTS + auxIndex].getPolyVoltage(c);
+        }
+    }
+
+    if (debug)
+        debugSectionStart = debugStats.add(DebugSections::ROUTING, debugSectionStart);
+
+    updatePanel(args, blockSceneOffset);
+
+    if (debug)
+        debugSectionStart = debugStats.add(DebugSections::LIGHTS, debugSectionStart);
+
+    if (++blockPos == activeBlockSize) {
+        blockPos = 0;
+
+        int sceneOffset[16] = {0};
+        for (int frame = 0; frame < activeBlockSize; frame++) {
+            float phaseOut[16] = {0.f};
+            // As per sample, AUX voltages are read with the polyphony of the frame before
+            readAuxInputs(false, frame);
+            if (frame == 0) {
+                this->channels = blockChannels;
+                for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
+                    auxInput[auxIndex]->channels = this->channels;
+            }
+            processControl(block.processCV[frame], block.rearmClickFilters[frame], NULL, sceneOffset, phaseOut, debugSectionStart);
+            keepBlockControl(frame, args.sampleTime, phaseOut);
+            if (clockIgnoreOnReset > 0l)
+                clockIgnoreOnReset--;
+        }
+        blockSceneOffset = sceneOffset[0];
+
+        routeBlock(args.sampleTime);
+
+        if (debug)
+            debugStats.add(DebugSections::ROUTING, debugSectionStart);
+    }
+
+    if (debug) {
+        debugStats.countScene(centerMorphScene[0]);
+        debugStats.endFrame(debugFrameStart, args.sampleRate);
+    }
+
+    recordTelemetry(args.frame);
+}
+
+// What a block frame's control pass leaves for routing: its gain targets, output scales and Phase output
+void AlgomorphLarge::keepBlockControl(int frame, float sampleTime, const float* phaseOut) {
+    float runGain = runSilencer ? runClickFilter.process(sampleTime, running) : 1.f;
+    if (auxModeFlags[AuxInputModes::MOD_ATTEN])
+        rescaleVoltage(AuxInputModes::MOD_ATTEN, this->channels);
+    if (auxModeFlags[AuxInputModes::SUM_ATTEN])
+        rescaleVoltage(AuxInputModes::SUM_ATTEN, this->channels);
+    // The operator gain is applied once to the routed sums
+    float opGain = params[AUX_KNOBS + AuxKnobModes::OP_GAIN].getValue() * runGain;
+    float modGain = params[AUX_KNOBS + AuxKnobModes::MOD_GAIN].getValue() * opGain;
+    float sumGain = params[AUX_KNOBS + AuxKnobModes::SUM_GAIN].getValue() * opGain;
+    updateMorphWeights(this->channels);
+    if (avgMode)
+        updateSumNorms(this->channels);
+
+    auto keep = [&](float* targets, bool& held, float target) {
+        targets[frame] = target;
+        held = frame == 0 || (held && target == targets[0]);
+    };
+
+    for (int c = 0; c < this->channels; c++) {
+        block.phaseOut[c][frame] = phaseOut[c];
+        float sumScale = sumGain * (auxModeFlags[AuxInputModes::SUM_ATTEN] ? scaledAuxVoltage[AuxInputModes::SUM_ATTEN][c] : 1.f);
+        block.modScale[c][frame] = modGain * (auxModeFlags[AuxInputModes::MOD_ATTEN] ? scaledAuxVoltage[AuxInputModes::MOD_ATTEN][c] : 1.f);
+        block.modSumScale[c][frame] = avgMode ? sumScale * modSumNorm[c] : sumScale;
+        block.carSumScale[c][frame] = avgMode ? sumScale * carSumNorm[c] : sumScale;
+        for (int op = 0; op < 4; op++) {
+            if (!inputs[OPERATOR_INPUTS + op].isConnected())
+                continue;
+            if (modeB)
+                keep(block.modTargets[op][op][c], block.modHeld[op][op][c], horizontalTarget(op, c));
+            for (int mod = 0; mod < 3; mod++) {
+                int dest = relToAbs[op][mod];
+                keep(block.modTargets[op][dest][c], block.modHeld[op][dest][c], diagonalTarget(op, mod, c));
+            }
+            keep(block.sumTargets[op][c], block.sumHeld[op][c], sumTarget(op, c));
+        }
+    }
+}
+
+// Routes the block with the targets and scales its control pass left. Without Shadow and Wildcard inputs each
+// connection is an operator input times one gain, so each click filter steps through the block on its own and its
+// gains are applied to the block 4 samples at a time. Click filters settled on a target held over the block skip the
+// stepping.
+void AlgomorphLarge::routeBlock(float sampleTime) {
+    using rack::simd::float_4;
+    const int frames = activeBlockSize;
+    alignas(16) float gain[MAX_BLOCK_SIZE];
+    alignas(16) float carTotal[MAX_BLOCK_SIZE];
+
+    // A click filter's output over the block, or the targets themselves once it has settled on ones held over the
+    // block. The gain it ends on is kept for the displays
+    auto stepGain = [&](rack::dsp::SlewLimiter& filter, const float* target, bool held, float& lastGain) {
+        const float* out = target;
+        if (clickFilterEnabled && !(held && filter.out == target[0])) {
+            for (int n = 0; n < frames; n++)
+                gain[n] = filter.process(sampleTime, target[n]);
+            out = gain;
+        }
+        lastGain = out[frames - 1];
+        return out;
+    };
+    auto addGained = [&](float* out, const float* in, const float* gains) {
+        for (int n = 0; n < frames; n += 4)
+            (float_4::load(&out[n]) + float_4::load(&in[n]) * float_4::load(&gains[n])).store(&out[n]);
+    };
+
+    std::fill(block.channels, block.channels + frames, this->channels);
+    for (int c = 0; c < this->channels; c++) {
+        for (int mod = 0; mod < 4; mod++)
+            std::fill(block.modOut[mod][c], block.modOut[mod][c] + frames, 0.f);
+        std::fill(block.carSumOut[c], block.carSumOut[c] + frames, 0.f);
+        std::fill(carTotal, carTotal + frames, 0.f);
+
+        for (int op = 0; op < 4; op++) {
+            if (!inputs[OPERATOR_INPUTS + op].isConnected())
+                continue;
+            if (modeB)
+                addGained(block.modOut[op][c], block.in[op][c], stepGain(modClickFilters[op][op][c], block.modTargets[op][op][c], block.modHeld[op][op][c], modClickGain[op][op][c]));
+            for (int mod = 0; mod < 3; mod++) {
+                int dest = relToAbs[op][mod];
+                addGained(block.modOut[dest][c], block.in[op][c], stepGain(modClickFilters[op][dest][c], block.modTargets[op][dest][c], block.modHeld[op][dest][c], modClickGain[op][dest][c]));
+            }
+            const float* sumGain = stepGain(sumClickFilters[op][c], block.sumTargets[op][c], block.sumHeld[op][c], sumClickGain[op][c]);
+            addGained(block.carSumOut[c], block.in[op][c], sumGain);
+            for (int n = 0; n < frames; n += 4)
+                (float_4::load(&carTotal[n]) + float_4::load(&sumGain[n])).store(&carTotal[n]);
+        }
+        totalCarSumConnection[c] = carTotal[frames - 1];
+
+        for (int n = 0; n < frames; n += 4) {
+            float_4 modSum = 0.f;
+            for (int mod = 0; mod < 4; mod++) {
+                float_4 modOut = float_4::load(&block.modOut[mod][c][n]);
+                modSum += modOut;
+                (modOut * float_4::load(&block.modScale[c][n])).store(&block.modOut[mod][c][n]);
+            }
+            (modSum * float_4::load(&block.modSumScale[c][n])).store(&block.modSumOut[c][n]);
+            float_4 carSumScale = float_4::load(&block.carSumScale[c][n]);
+            if (avgMode) {
+                float_4 total = float_4::load(&carTotal[n]);
+                carSumScale = rack::simd::ifelse(total == 0.f, float_4::zero(), carSumScale / total);
+            }
+            (float_4::load(&block.carSumOut[c][n]) * carSumScale).store(&block.carSumOut[c][n]);
+        }
+    }
+}
+
+// Per-sample routing in block mode trades its outputs for the ones from a block ago, so the latency holds
+void AlgomorphLarge::delayOutputs() {
+    auto delay = [&](rack::engine::Output& output, float (*slot)[MAX_BLOCK_SIZE]) {
+        if (!output.isConnected())
+            return;
+        for (int c = 0; c < CHANNELS; c++) {
+            float routed = output.getVoltage(c);
+            output.setVoltage(slot[c][blockPos], c);
+            slot[c][blockPos] = routed;
+        }
+        output.setChannels(block.channels[blockPos]);
+    };
+    for (int i = 0; i < 4; i++)
+        delay(outputs[MODULATOR_OUTPUTS + i], block.modOut[i]);
+    delay(outputs[CARRIER_SUM_OUTPUT], block.carSumOut);
+    delay(outputs[MODULATOR_SUM_OUTPUT], block.modSumOut);
+    delay(outputs[PHASE_OUTPUT], block.phaseOut);
+    block.channels[blockPos] = this->channels;
+
+    if (++blockPos == activeBlockSize)
+        blockPos = 0;
+}
+
+// AUX jacks into their AuxInputs, or in block mode, the voltages kept for one of the block's frames. Disconnecting one
+// resets its voltages, and restarts a stopped module
+void AlgomorphLarge::readAuxInputs(bool delayed, int blockFrame) {
+    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
+        if (inputs[AUX_INPUTS + auxIndex].isConnected()) {
+            auxInput[auxIndex]->connected = true;
+            if (blockFrame >= 0)
+                auxInput[auxIndex]->updateVoltage(block.aux[auxIndex][blockFrame]);
+            else if (delayed) {
+                auxInput[auxIndex]->updateVoltage(delayedAuxVoltage[auxIndex]);
+                for (int c = 0; c < 16; c++)
+                    delayedAuxVoltage[auxIndex][c] = inputs[AUX_INPUTS + auxIndex].getPolyVoltage(c);
+            }
+            else
+                auxInput[auxIndex]->updateVoltage();
+        }
+        else {
+            if (auxInput[auxIndex]->connected) {
+                auxInput[auxIndex]->connected = false;
+                auxInput[auxIndex]->resetVoltages();
+                running = true;
+                rescaleVoltages(16);
+            }
+        }
+    }
+}
+
+// Triggers, scene buttons, morph and editing, then the displays and click filter times. Runs every sample, in block
+// mode once per frame of each block
+void AlgomorphLarge::processControl(bool processCV, bool rearmClickFilters, const LinkMessage* link, int* sceneOffset, float* phaseOut, int64_t& debugSectionStart) {
     if (processCV) {
-        for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
+        for (int auxIndex = 0; auxIndex < auxSources; auxIndex++) {
             //Reset trigger
             if (resetCVTrigger.process(auxInput[auxIndex]->voltage[AuxInputModes::RESET][0])) {
                 initRun();// must be after sequence reset
@@ -198,251 +709,81 @@ void AlgomorphLarge::process(const ProcessArgs& args) {
             }
         }
 
-        //Check to change scene
-        //Scene buttons
-        for (int i = 0; i < 3; i++) {
-            if (sceneButtonTrigger[i].process(params[SCENE_BUTTONS + i].getValue() > 0.f)) {
-                if (configMode) {
-                    //If not changing to a new scene
-                    if (configScene == i) {
-                        //Exit config mode
-                        configMode = false;
+        //Check to change scene, unless following
+        if (!link) {
+            //Scene buttons
+            for (int i = 0; i < 3; i++) {
+                if (sceneButtonTrigger[i].process(params[SCENE_BUTTONS + i].getValue() > 0.f)) {
+                    if (configMode) {
+                        //If not changing to a new scene
+                        if (configScene == i) {
+                            //Exit config mode
+                            configMode = false;
+                        }
+                        else {
+                            //Switch scene
+                            configScene = i;
+                        }
                     }
                     else {
-                        //Switch scene
-                        configScene = i;
-                    }
-                }
-                else {
-                    //If the clicked button does not correspond to the current base scene
-                    if (baseScene != i) {
-                        //Switch scene
-                        // History
-                        AlgorithmSceneChangeAction<>* h = new AlgorithmSceneChangeAction<>();
-                        h->moduleId = this->id;
-                        h->oldScene = baseScene;
-                        h->newScene = i;
-                        
-                        baseScene = i;
+                        //If the clicked button does not correspond to the current base scene
+                        if (baseScene != i) {
+                            //Switch scene
+                            // History
+                            requestSceneChangeHistory(baseScene, i);
 
-                        APP->history->push(h);
+                            baseScene = i;
 
+                        }
                     }
+                    graphDirty = true;
                 }
-                graphDirty = true;
             }
         }
+
+        //Scene bank slot CV, unless following
+        if (!link && auxModeFlags[AuxInputModes::BANK_SLOT]) {
+            rescaleVoltage(AuxInputModes::BANK_SLOT, 1);
+            int slot = rack::math::clamp(bankSlot + (int) std::round(scaledAuxVoltage[AuxInputModes::BANK_SLOT][0] * 12.f), 0, BANK_SLOTS - 1);
+            //A slot is a pointer into the shared mapping, so switching costs the same for any bank size
+            //The patch's scenes are put aside while a slot is routed, and come back for an empty slot
+            const BankSlot* slotScenes = sceneBank.getSlot(slot);
+            if (slotScenes != cvBankSlot) {
+                if (!cvBankSlot)
+                    getBankSlot(&patchScenes);
+                loadBankSlot(slotScenes ? slotScenes : &patchScenes);
+                cvBankSlot = slotScenes;
+            }
+        }
+        else if (cvBankSlot) {
+            loadBankSlot(&patchScenes);
+            cvBankSlot = NULL;
+        }
     }
 
-    //Update scene offset
-    if (auxModeFlags[AuxInputModes::SCENE_OFFSET])
-        rescaleVoltage(AuxInputModes::SCENE_OFFSET, this->channels);
-    for (int c = 0; c < this->channels; c++) {
-        float sceneOffsetVoltage = scaledAuxVoltage[AuxInputModes::SCENE_OFFSET][c];
-        if (sceneOffsetVoltage > FIVE_D_THREE)
-            sceneOffset[c] += 1;
-        else if (sceneOffsetVoltage < -FIVE_D_THREE)
-            sceneOffset[c] += 2;
+    if (debug)
+        debugSectionStart = debugStats.add(DebugSections::CV, debugSectionStart);
+
+    // A follower takes the scene state and morph from its leader instead of computing them
+    if (link)
+        followLink(link, sceneOffset, phaseOut);
+    else
+        updateMorph(sceneOffset, phaseOut);
+
+    // Pass them on to a follower on the right, relaying the leader's message if this module follows too
+    if (rightExpander.module && rightExpander.module->model == modelAlgomorphLarge && ((AlgomorphLarge*) rightExpander.module)->followLeader) {
+        LinkMessage* linkOut = &((LeftExpanderMessage*) rightExpander.module->leftExpander.producerMessage)->link;
+        if (link)
+            *linkOut = *link;
+        else
+            publishLink(linkOut, sceneOffset[0]);
+        rightExpander.module->leftExpander.requestMessageFlip();
     }
 
-    //  Update morph status
-    if (auxModeFlags[AuxInputModes::MORPH_ATTEN])
-        rescaleVoltage(AuxInputModes::MORPH_ATTEN, this->channels);
-    if (auxModeFlags[AuxInputModes::DOUBLE_MORPH_ATTEN])
-        rescaleVoltage(AuxInputModes::DOUBLE_MORPH_ATTEN, this->channels);
-    if (auxModeFlags[AuxInputModes::TRIPLE_MORPH_ATTEN])
-        rescaleVoltage(AuxInputModes::TRIPLE_MORPH_ATTEN, this->channels);
-    float morphAttenuversion[16] = {0.f};
-    for (int c = 0; c < this->channels; c++) {
-        morphAttenuversion[c] = scaledAuxVoltage[AuxInputModes::MORPH_ATTEN][c]
-                                * scaledAuxVoltage[AuxInputModes::DOUBLE_MORPH_ATTEN][c]
-                                * scaledAuxVoltage[AuxInputModes::TRIPLE_MORPH_ATTEN][c]
-                                * params[AUX_KNOBS + AuxKnobModes::MORPH_ATTEN].getValue()
-                                * params[AUX_KNOBS + AuxKnobModes::DOUBLE_MORPH_ATTEN].getValue()
-                                * params[AUX_KNOBS + AuxKnobModes::TRIPLE_MORPH_ATTEN].getValue();
-    }
-    if (auxModeFlags[AuxInputModes::MORPH])
-        rescaleVoltage(AuxInputModes::MORPH, this->channels);
-    if (auxModeFlags[AuxInputModes::DOUBLE_MORPH])
-        rescaleVoltage(AuxInputModes::DOUBLE_MORPH, this->channels);
-    if (auxModeFlags[AuxInputModes::TRIPLE_MORPH])
-        rescaleVoltage(AuxInputModes::TRIPLE_MORPH, this->channels);
-    // Only redraw display if morph on channel 1 has changed
-    float newMorph0 =   + params[MORPH_KNOB].getValue()
-                        + params[AUX_KNOBS + AuxKnobModes::MORPH].getValue()
-                        + params[AUX_KNOBS + AuxKnobModes::DOUBLE_MORPH].getValue()
-                        + params[AUX_KNOBS + AuxKnobModes::TRIPLE_MORPH].getValue()
-                        + params[AUX_KNOBS + AuxKnobModes::UNI_MORPH].getValue()
-                        + params[AUX_KNOBS + AuxKnobModes::ENDLESS_MORPH].getValue()
-                        + (scaledAuxVoltage[AuxInputModes::MORPH][0]
-                        + scaledAuxVoltage[AuxInputModes::DOUBLE_MORPH][0]
-                        + scaledAuxVoltage[AuxInputModes::TRIPLE_MORPH][0])
-                        * morphAttenuversion[0];
-    while (newMorph0 > 3.f)
-        newMorph0 = -3.f + (newMorph0 - 3.f);
-    while (newMorph0 < -3.f)
-        newMorph0 = 3.f + (newMorph0 + 3.f);
-    phaseOut[0] = newMorph0;
-    while (phaseOut[0] > 1.f)
-        phaseOut[0] = -1 + (phaseOut[0] - 1.f);
-    while (phaseOut[0] < -1.f)
-        phaseOut[0] = 1.f + (phaseOut[0] + 1.f);
-    phaseOut[0] = rack::math::rescale(phaseOut[0], -1.f, 1.f, phaseMin, phaseMax);
-    if (morph[0] != newMorph0) {
-        morph[0] = newMorph0;
-        graphDirty = true;
-    }
-    // morph[0] was just processed, so start this loop with [1]
-    for (int c = 1; c < this->channels; c++) {
-        morph[c] =  + params[MORPH_KNOB].getValue()
-                    + params[AUX_KNOBS + AuxKnobModes::MORPH].getValue()
-                    + params[AUX_KNOBS + AuxKnobModes::DOUBLE_MORPH].getValue()
-                    + params[AUX_KNOBS + AuxKnobModes::TRIPLE_MORPH].getValue()
-                    + params[AUX_KNOBS + AuxKnobModes::UNI_MORPH].getValue()
-                    + params[AUX_KNOBS + AuxKnobModes::ENDLESS_MORPH].getValue()
-                    + (scaledAuxVoltage[AuxInputModes::MORPH][c]
-                    + scaledAuxVoltage[AuxInputModes::DOUBLE_MORPH][c]
-                    + scaledAuxVoltage[AuxInputModes::TRIPLE_MORPH][c])
-                    * morphAttenuversion[c];
-        while (morph[c] > 3.f)
-            morph[c] = -3.f + (morph[c] - 3.f);
-        while (morph[c] < -3.f)
-            morph[c] = 3.f + (morph[c] + 3.f);
-        phaseOut[c] = morph[c];
-        while (phaseOut[c] > 1.f)
-            phaseOut[c] = -1 + (phaseOut[c] - 1.f);
-        while (phaseOut[c] < -1.f)
-            phaseOut[c] = 1.f + (phaseOut[c] + 1.f);
-        phaseOut[c] = rack::math::rescale(phaseOut[c], -1.f, 1.f, phaseMin, phaseMax);
-    }
+    if (debug)
+        debugSectionStart = debugStats.add(DebugSections::AUX, debugSectionStart);
 
-    // Update relative morph magnitude and scenes
-    if (!ringMorph) {
-        for (int c = 0; c < this->channels; c++) {
-            relativeMorphMagnitude[c] = morph[c];
-            if (morph[c] > 0.f) {
-                if (morph[c] < 1.f) {
-                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                }
-                else if (morph[c] == 1.f) {
-                    relativeMorphMagnitude[c] = 0.f;
-                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                }
-                else if (morph[c] < 2.f) {
-                    relativeMorphMagnitude[c] -= 1.f;
-                    centerMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                }
-                else if (morph[c] == 2.f) {
-                    relativeMorphMagnitude[c] = 0.f;
-                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                }
-                else if (morph[c] < 3.f) {
-                    relativeMorphMagnitude[c] -= 2.f;
-                    centerMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                }
-                else {
-                    relativeMorphMagnitude[c] = 0.f;
-                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                }
-            }
-            else if (morph[c] == 0.f)
-                centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-            else {
-                relativeMorphMagnitude[c] *= -1.f;
-                if (morph[c] > -1.f) {
-                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                }
-                else if (morph[c] == -1.f) {
-                    relativeMorphMagnitude[c] = 0.f;
-                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                }
-                else if (morph[c] > -2.f) {
-                    relativeMorphMagnitude[c] -= 1.f;
-                    centerMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                }
-                else if (morph[c] == -2.f) {
-                    relativeMorphMagnitude[c] = 0.f;
-                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                }
-                else if (morph[c] < 3.f) {
-                    relativeMorphMagnitude[c] -= 2.f;
-                    centerMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                }
-                else {
-                    relativeMorphMagnitude[c] = 0.f;
-                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                }
-            }
-        }
-    }
-    else {
-        for (int c = 0; c < this->channels; c++) {
-            relativeMorphMagnitude[c] = morph[c];
-            if (morph[c] > 0.f) {
-                if (morph[c] <= 1.f) {
-                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                }
-                else if (morph[c] < 2.f) {
-                    relativeMorphMagnitude[c] -= (relativeMorphMagnitude[c] - 1.f) * 2.f;
-                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                }
-                else if (morph[c] == 2.f) {
-                    relativeMorphMagnitude[c] = 0.f;
-                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                }
-                else {
-                    relativeMorphMagnitude[c] -= (relativeMorphMagnitude[c] - 1.f) * 2.f;
-                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                }
-            }
-            else if (morph[c] == 0.f)
-                centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-            else {
-                relativeMorphMagnitude[c] *= -1.f;
-                if (morph[c] >= -1.f) {
-                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                }
-                else if (morph[c] > -2.f) {
-                    relativeMorphMagnitude[c] -= (relativeMorphMagnitude[c] - 1.f) * 2.f;
-                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                }
-                else if (morph[c] == -2.f) {
-                    relativeMorphMagnitude[c] = 0.f;
-                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                }
-                else {
-                    relativeMorphMagnitude[c] -= (relativeMorphMagnitude[c] - 1.f) * 2.f;
-                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
-                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
-                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
-                }
-            }
-        }
-    }
-
-    if (processCV) {
+    if (processCV && !link) {
         //Edit button
         if (editTrigger.process(params[EDIT_BUTTON].getValue() > 0.f)) {
             configMode ^= true;
@@ -495,15 +836,10 @@ void AlgomorphLarge::process(const ProcessArgs& args) {
             if (configOp > -1) {
                 if (modulatorTrigger[configOp].process(params[MODULATOR_BUTTONS + configOp].getValue() > 0.f)) {  //Op is connected to itself
                     // History
-                    AlgorithmHorizontalChangeAction<>* h = new AlgorithmHorizontalChangeAction<>();
-                    h->moduleId = this->id;
-                    h->scene = configScene;
-                    h->op = configOp;
+                    requestHistory(HistoryRequest::HORIZONTAL, configScene, configOp);
 
                     toggleHorizontalDestination(configScene, configOp);
 
-                    APP->history->push(h);
-
                     if (exitConfigOnConnect) {
                         configMode = false;
                         configOp = -1;
@@ -515,15 +851,9 @@ void AlgomorphLarge::process(const ProcessArgs& args) {
                     for (int mod = 0; mod < 3; mod++) {
                         if (modulatorTrigger[relToAbs[configOp][mod]].process(params[MODULATOR_BUTTONS + relToAbs[configOp][mod]].getValue() > 0.f)) {
                             // History
-                            AlgorithmDiagonalChangeAction<>* h = new AlgorithmDiagonalChangeAction<>();
-                            h->moduleId = this->id;
-                            h->scene = configScene;
-                            h->op = configOp;
-                            h->mod = mod;
+                            requestHistory(HistoryRequest::DIAGONAL, configScene, configOp, mod);
 
                             toggleDiagonalDestination(configScene, configOp, mod);
-                            
-                            APP->history->push(h);
 
                             if (exitConfigOnConnect) {
                                 configMode = false;
@@ -540,14 +870,9 @@ void AlgomorphLarge::process(const ProcessArgs& args) {
                 for (int i = 0; i < 4; i++) {
                     if (modulatorTrigger[i].process(params[MODULATOR_BUTTONS + i].getValue() > 0.f)) {
                         // History
-                        AlgorithmForcedCarrierChangeAction<>* h = new AlgorithmForcedCarrierChangeAction<>();
-                        h->moduleId = this->id;
-                        h->scene = configScene;
-                        h->op = i;
+                        requestHistory(HistoryRequest::FORCED_CARRIER, configScene, i);
 
                         toggleForcedCarrier(configScene, i);
-
-                        APP->history->push(h);
                         
                         graphDirty = true;
                         break;
@@ -569,14 +894,9 @@ void AlgomorphLarge::process(const ProcessArgs& args) {
                     configMode = true;
                     
                     // History
-                    AlgorithmForcedCarrierChangeAction<>* h = new AlgorithmForcedCarrierChangeAction<>();
-                    h->moduleId = this->id;
-                    h->scene = configScene;
-                    h->op = i;
+                    requestHistory(HistoryRequest::FORCED_CARRIER, configScene, i);
 
                     toggleForcedCarrier(configScene, i);
-
-                    APP->history->push(h);
                     
                     graphDirty = true;
                     break;
@@ -585,20 +905,28 @@ void AlgomorphLarge::process(const ProcessArgs& args) {
         }
     }
 
+    if (debug)
+        debugSectionStart = debugStats.add(DebugSections::CV, debugSectionStart);
+
     // Update display
-    displayMorph.push(relativeMorphMagnitude[0]);
-    if (configMode) {
-        displayScene.push(configScene);
-    }
-    else {
-        displayScene.push(centerMorphScene[0]);
-        displayMorphScene.push(forwardMorphScene[0]);
+    if (visible && !panelQuiet) {
+        displayMorph.push(relativeMorphMagnitude[0]);
+        if (configMode) {
+            displayScene.push(configScene);
+        }
+        else {
+            displayScene.push(centerMorphScene[0]);
+            displayMorphScene.push(forwardMorphScene[0]);
+        }
     }
     
     //Update clickfilter rise/fall times
-    if (clickFilterDivider.process()) {
+    if (rearmClickFilters) {
+        if (debug)
+            debugStats.clickFilterRearms++;
+
         if (auxModeFlags[AuxInputModes::CLICK_FILTER]) {
-            for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
+            for (int auxIndex = 0; auxIndex < auxSources; auxIndex++) {
                 if (auxInput[auxIndex]->modeIsActive[AuxInputModes::CLICK_FILTER]) {
                     rescaleVoltage(AuxInputModes::CLICK_FILTER, this->channels);
                     break;
@@ -612,7 +940,7 @@ void AlgomorphLarge::process(const ProcessArgs& args) {
             
             clickFilterResult *= scaledAuxVoltage[AuxInputModes::CLICK_FILTER][c];
 
-            for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
+            for (int auxIndex = 0; auxIndex < auxSources; auxIndex++) {
                 auxInput[auxIndex]->wildcardModClickFilter[c].setRiseFall(clickFilterResult, clickFilterResult);
                 auxInput[auxIndex]->wildcardSumClickFilter[c].setRiseFall(clickFilterResult, clickFilterResult);                    
             }
@@ -627,651 +955,438 @@ void AlgomorphLarge::process(const ProcessArgs& args) {
             }
         }
     }
+}
 
-    //Get operator input channel then route to modulation output channel or to sum output channel
-    float wildcardMod[16] = {0.f};
-    float wildcardSum[16] = {0.f};
-    float runClickFilterGain;
-    if (runSilencer)
-        runClickFilterGain = runClickFilter.process(args.sampleTime, running);
-    else
-        runClickFilterGain = 1.f;
-    if (auxModeFlags[AuxInputModes::MOD_ATTEN])
-        rescaleVoltage(AuxInputModes::MOD_ATTEN, this->channels);
-    if (auxModeFlags[AuxInputModes::SUM_ATTEN])
-        rescaleVoltage(AuxInputModes::SUM_ATTEN, this->channels);
-    float modGain = params[AUX_KNOBS + AuxKnobModes::MOD_GAIN].getValue();
-    float sumGain = params[AUX_KNOBS + AuxKnobModes::SUM_GAIN].getValue();
-    float wildcardModGain = params[AUX_KNOBS + AuxKnobModes::WILDCARD_MOD_GAIN].getValue();
-    float modAttenuversion[16] = {1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f};
-    if (auxModeFlags[AuxInputModes::MOD_ATTEN]) {
-        for (int c = 0; c < this->channels; c++)
-            modAttenuversion[c] *= scaledAuxVoltage[AuxInputModes::MOD_ATTEN][c];
-    }
-    float sumAttenuversion[16] = {1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f};
-    if (auxModeFlags[AuxInputModes::SUM_ATTEN]) {
-        for (int c = 0; c < this->channels; c++)
-            sumAttenuversion[c] *= scaledAuxVoltage[AuxInputModes::SUM_ATTEN][c];
-    }
-    for (int i = 0; i < 4; i++) {
-        if (auxModeFlags[AuxInputModes::SHADOW + i])
-            scaleAuxShadow(args.sampleTime, i, this->channels);
-    }
-    for (int c = 0; c < this->channels; c++) {
-        if (ringMorph) {
-            for (int i = 0; i < 4; i++) {
-                if (inputs[OPERATOR_INPUTS + i].isConnected()) {
-                    in[c] = inputs[OPERATOR_INPUTS + i].getPolyVoltage(c) * params[AUX_KNOBS + AuxKnobModes::OP_GAIN].getValue();
-                    if (!auxModeFlags[AuxInputModes::SHADOW + i]) {
-                        //Check current algorithm and morph target
-                        if (modeB) {
-                            modOut[i][c] += routeHorizontal(args.sampleTime, in[c], i, c);
-                            modOut[i][c] += routeHorizontalRing(args.sampleTime, in[c], i, c);
-                            for (int j = 0; j < 3; j++) {
-                                modOut[i][c] += routeDiagonalB(args.sampleTime, in[c], i, j, c);
-                                modOut[i][c] += routeDiagonalRingB(args.sampleTime, in[c], i, j, c);
-                            }
-                            carSumOut[c] += routeSumRingB(args.sampleTime, in[c], i, c);
-                            carSumOut[c] += routeSumB(args.sampleTime, in[c], i, c);
-                        }
-                        else {
-                            for (int j = 0; j < 3; j++) {
-                                modOut[relToAbs[i][j]][c] += routeDiagonal(args.sampleTime, in[c], i, j, c);
-                                modOut[relToAbs[i][j]][c] += routeDiagonalRing(args.sampleTime, in[c], i, j, c);
-                            }
-                            carSumOut[c] += routeSumRing(args.sampleTime, in[c], i, c);
-                            carSumOut[c] += routeSum(args.sampleTime, in[c], i, c);
-                        }
-                    }
-                    else {
-                        //Check current algorithm and morph target
-                        if (modeB) {
-                            modOut[i][c] += routeHorizontalRing(args.sampleTime, in[c], i, c);
-                            modOut[i][c] += routeHorizontal(args.sampleTime, in[c], i, c);
-                            for (int j = 0; j < 3; j++) {
-                                modOut[relToAbs[i][j]][c] += routeDiagonalRingB(args.sampleTime, in[c], i, j, c);
-                                modOut[relToAbs[i][j]][c] += routeDiagonalB(args.sampleTime, in[c], i, j, c);
-                            }
-                            carSumOut[c] += routeSumRingB(args.sampleTime, in[c], i, c);
-                            carSumOut[c] += routeSumB(args.sampleTime, in[c], i, c);
-                        }
-                        else {
-                            for (int j = 0; j < 3; j++) {
-                                modOut[relToAbs[i][j]][c] += routeDiagonalRing(args.sampleTime, in[c], i, j, c);
-                                modOut[relToAbs[i][j]][c] += routeDiagonal(args.sampleTime, in[c], i, j, c);
-                            }
-                            carSumOut[c] += routeSumRing(args.sampleTime, in[c], i, c);
-                            carSumOut[c] += routeSum(args.sampleTime, in[c], i, c);
-                        }
-                    }
-                }
-                modOut[i][c] *=  modAttenuversion[c] * modGain * runClickFilterGain;
-                carSumOut[c] *= sumAttenuversion[c] * sumGain * runClickFilterGain;
-            }
-        }
-        else {
-            for (int i = 0; i < 4; i++) {
-                if (inputs[OPERATOR_INPUTS + i].isConnected()) {
-                    in[c] = inputs[OPERATOR_INPUTS + i].getPolyVoltage(c) * params[AUX_KNOBS + AuxKnobModes::OP_GAIN].getValue();
-                    if (!auxModeFlags[AuxInputModes::SHADOW + i]) {
-                        //Check current algorithm and morph target
-                        if (modeB) {
-                            modOut[i][c] += routeHorizontal(args.sampleTime, in[c], i, c);
-                            for (int j = 0; j < 3; j++) {
-                                modOut[relToAbs[i][j]][c] += routeDiagonalB(args.sampleTime, in[c], i, j, c);
-                            }
-                            carSumOut[c] += routeSumB(args.sampleTime, in[c], i, c);
-                        }
-                        else {
-                            for (int j = 0; j < 3; j++) {
-                                modOut[relToAbs[i][j]][c] += routeDiagonal(args.sampleTime, in[c], i, j, c);
-                            }
-                            carSumOut[c] += routeSum(args.sampleTime, in[c], i, c);
-                        }
-                    }
-                    else {
-                        //Check current algorithm and morph target
-                        if (modeB) {
-                            modOut[i][c] += routeHorizontal(args.sampleTime, in[c], i, c);
-                            for (int j = 0; j < 3; j++) {
-                                modOut[relToAbs[i][j]][c] += routeDiagonalB(args.sampleTime, in[c], i, j, c);
-                            }
-                            carSumOut[c] += routeSumB(args.sampleTime, in[c], i, c);
-                        }
-                        else {
-                            for (int j = 0; j < 3; j++) {
-                                modOut[relToAbs[i][j]][c] += routeDiagonal(args.sampleTime, in[c], i, j, c);
-                            }
-                            carSumOut[c] += routeSum(args.sampleTime, in[c], i, c);
-                        }
-                    }
-                }
-            }
+// VU meters every sample, lights every lightDivider samples
+void AlgomorphLarge::updatePanel(const ProcessArgs& args, int sceneOffset) {
+    //Meter ports for the VU lights
+    if (vuLights && visible && !panelQuiet) {
+        for (int i = 0; i < 4; i++) {
+            accumulateVu(inputs[OPERATOR_INPUTS + i], LightVuSources::OPERATOR_INPUTS + i);
+            accumulateVu(outputs[MODULATOR_OUTPUTS + i], LightVuSources::MODULATOR_OUTPUTS + i);
         }
-        for (int mod = 0; mod < 4; mod++)
-            modSumOut[c] += modOut[mod][c] * sumAttenuversion[c] * sumGain * runClickFilterGain;
-        if (auxModeFlags[AuxInputModes::WILDCARD_MOD]) {
-            for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
-                auxInput[auxIndex]->wildcardModClickGain = (clickFilterEnabled ? auxInput[auxIndex]->wildcardModClickFilter[c].process(args.sampleTime, auxInput[auxIndex]->modeIsActive[AuxInputModes::WILDCARD_MOD]) : auxInput[auxIndex]->modeIsActive[AuxInputModes::WILDCARD_MOD]);
-                wildcardMod[c] += auxInput[auxIndex]->voltage[AuxInputModes::WILDCARD_MOD][c] * auxInput[auxIndex]->wildcardModClickGain;
-            }
-            for (int mod = 0; mod < 4; mod++) {
-                modOut[mod][c] += wildcardMod[c] * wildcardModGain;
-            }
-            if (wildModIsSummed)
-                modSumOut[c] += wildcardMod[c] * wildcardModGain * sumAttenuversion[c] * sumGain * runClickFilterGain;
+        accumulateVu(outputs[CARRIER_SUM_OUTPUT], LightVuSources::CARRIER_SUM_OUTPUT);
+        vuMeter.endFrame();
+    }
+
+    //Set lights
+    if (lightDivider.process()) {
+        float lightTime = args.sampleTime * lightDivider.getDivision();
+        if (updateVisibility(lightTime) && !panelQuiet) {
+            rotor.step(lightTime);
+            processLights(lightTime, (baseScene + sceneOffset) % 3, params[SCREEN_BUTTON].getValue(), SCREEN_BUTTON_RING_LIGHT);
         }
-        for (int mod = 0; mod < 4; mod++)
-            modOut[mod][c] *= runClickFilterGain * modAttenuversion[c] * modGain;
-        if (auxModeFlags[AuxInputModes::WILDCARD_SUM]) {
-            for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
-                auxInput[auxIndex]->wildcardSumClickGain = (clickFilterEnabled ? auxInput[auxIndex]->wildcardSumClickFilter[c].process(args.sampleTime, auxInput[auxIndex]->modeIsActive[AuxInputModes::WILDCARD_SUM]) : auxInput[auxIndex]->modeIsActive[AuxInputModes::WILDCARD_SUM]);
-                wildcardSum[c] += auxInput[auxIndex]->voltage[AuxInputModes::WILDCARD_SUM][c] * auxInput[auxIndex]->wildcardSumClickGain;
+        if (configMode) {
+            //Check and update blink timer
+            if (blinkTimer > BLINK_INTERVAL / lightDivider.getDivision()) {
+                blinkStatus ^= true;
+                blinkTimer = 0.f;
             }
-            carSumOut[c] += wildcardSum[c];
+            else
+                blinkTimer += args.sampleTime;
         }
-        carSumOut[c] *= sumAttenuversion[c] * sumGain * runClickFilterGain;
     }
+}
 
-    //Set outputs
-    for (int i = 0; i < 4; i++) {
-        if (outputs[MODULATOR_OUTPUTS + i].isConnected()) {
-            outputs[MODULATOR_OUTPUTS + i].setChannels(this->channels);
-            outputs[MODULATOR_OUTPUTS + i].writeVoltages(modOut[i]);
-        }
+// Scene offset, morph and the morph scenes of each channel, from the AUX inputs and knobs
+void AlgomorphLarge::updateMorph(int* sceneOffset, float* phaseOut) {
+    //Update scene offset
+    if (auxModeFlags[AuxInputModes::SCENE_OFFSET])
+        rescaleVoltage(AuxInputModes::SCENE_OFFSET, this->channels);
+    for (int c = 0; c < this->channels; c++) {
+        float sceneOffsetVoltage = scaledAuxVoltage[AuxInputModes::SCENE_OFFSET][c];
+        if (sceneOffsetVoltage > FIVE_D_THREE)
+            sceneOffset[c] += 1;
+        else if (sceneOffsetVoltage < -FIVE_D_THREE)
+            sceneOffset[c] += 2;
+    }
+
+    //  Update morph status
+    if (auxModeFlags[AuxInputModes::MORPH_ATTEN])
+        rescaleVoltage(AuxInputModes::MORPH_ATTEN, this->channels);
+    if (auxModeFlags[AuxInputModes::DOUBLE_MORPH_ATTEN])
+        rescaleVoltage(AuxInputModes::DOUBLE_MORPH_ATTEN, this->channels);
+    if (auxModeFlags[AuxInputModes::TRIPLE_MORPH_ATTEN])
+        rescaleVoltage(AuxInputModes::TRIPLE_MORPH_ATTEN, this->channels);
+    float morphAttenuversion[16] = {0.f};
+    for (int c = 0; c < this->channels; c++) {
+        morphAttenuversion[c] = scaledAuxVoltage[AuxInputModes::MORPH_ATTEN][c]
+                                * scaledAuxVoltage[AuxInputModes::DOUBLE_MORPH_ATTEN][c]
+                                * scaledAuxVoltage[AuxInputModes::TRIPLE_MORPH_ATTEN][c]
+                                * params[AUX_KNOBS + AuxKnobModes::MORPH_ATTEN].getValue()
+                                * params[AUX_KNOBS + AuxKnobModes::DOUBLE_MORPH_ATTEN].getValue()
+                                * params[AUX_KNOBS + AuxKnobModes::TRIPLE_MORPH_ATTEN].getValue();
     }
-    if (avgMode) {
-        if (outputs[CARRIER_SUM_OUTPUT].isConnected()) {
-            outputs[CARRIER_SUM_OUTPUT].setChannels(this->channels);
-            for (int c = 0; c < this->channels; c++) {
-                if (totalCarSumConnection[c] == 0) {
-                    outputs[CARRIER_SUM_OUTPUT].setVoltage(0.f, c);
+    if (auxModeFlags[AuxInputModes::MORPH])
+        rescaleVoltage(AuxInputModes::MORPH, this->channels);
+    if (auxModeFlags[AuxInputModes::DOUBLE_MORPH])
+        rescaleVoltage(AuxInputModes::DOUBLE_MORPH, this->channels);
+    if (auxModeFlags[AuxInputModes::TRIPLE_MORPH])
+        rescaleVoltage(AuxInputModes::TRIPLE_MORPH, this->channels);
+    // Only redraw display if morph on channel 1 has changed
+    float newMorph0 =   + params[MORPH_KNOB].getValue()
+                        + params[AUX_KNOBS + AuxKnobModes::MORPH].getValue()
+                        + params[AUX_KNOBS + AuxKnobModes::DOUBLE_MORPH].getValue()
+                        + params[AUX_KNOBS + AuxKnobModes::TRIPLE_MORPH].getValue()
+                        + params[AUX_KNOBS + AuxKnobModes::UNI_MORPH].getValue()
+                        + params[AUX_KNOBS + AuxKnobModes::ENDLESS_MORPH].getValue()
+                        + (scaledAuxVoltage[AuxInputModes::MORPH][0]
+                        + scaledAuxVoltage[AuxInputModes::DOUBLE_MORPH][0]
+                        + scaledAuxVoltage[AuxInputModes::TRIPLE_MORPH][0])
+                        * morphAttenuversion[0];
+    while (newMorph0 > 3.f) {
+        newMorph0 = -3.f + (newMorph0 - 3.f);
+        if (debug)
+            debugStats.morphWraps++;
+    }
+    while (newMorph0 < -3.f) {
+        newMorph0 = 3.f + (newMorph0 + 3.f);
+        if (debug)
+            debugStats.morphWraps++;
+    }
+    phaseOut[0] = newMorph0;
+    while (phaseOut[0] > 1.f)
+        phaseOut[0] = -1 + (phaseOut[0] - 1.f);
+    while (phaseOut[0] < -1.f)
+        phaseOut[0] = 1.f + (phaseOut[0] + 1.f);
+    phaseOut[0] = rack::math::rescale(phaseOut[0], -1.f, 1.f, phaseMin, phaseMax);
+    morph[0] = newMorph0;
+    // morph[0] was just processed, so start this loop with [1]
+    for (int c = 1; c < this->channels; c++) {
+        morph[c] =  + params[MORPH_KNOB].getValue()
+                    + params[AUX_KNOBS + AuxKnobModes::MORPH].getValue()
+                    + params[AUX_KNOBS + AuxKnobModes::DOUBLE_MORPH].getValue()
+                    + params[AUX_KNOBS + AuxKnobModes::TRIPLE_MORPH].getValue()
+                    + params[AUX_KNOBS + AuxKnobModes::UNI_MORPH].getValue()
+                    + params[AUX_KNOBS + AuxKnobModes::ENDLESS_MORPH].getValue()
+                    + (scaledAuxVoltage[AuxInputModes::MORPH][c]
+                    + scaledAuxVoltage[AuxInputModes::DOUBLE_MORPH][c]
+                    + scaledAuxVoltage[AuxInputModes::TRIPLE_MORPH][c])
+                    * morphAttenuversion[c];
+        while (morph[c] > 3.f)
+            morph[c] = -3.f + (morph[c] - 3.f);
+        while (morph[c] < -3.f)
+            morph[c] = 3.f + (morph[c] + 3.f);
+        phaseOut[c] = morph[c];
+        while (phaseOut[c] > 1.f)
+            phaseOut[c] = -1 + (phaseOut[c] - 1.f);
+        while (phaseOut[c] < -1.f)
+            phaseOut[c] = 1.f + (phaseOut[c] + 1.f);
+        phaseOut[c] = rack::math::rescale(phaseOut[c], -1.f, 1.f, phaseMin, phaseMax);
+    }
+
+    // Update relative morph magnitude and scenes
+    if (!ringMorph) {
+        for (int c = 0; c < this->channels; c++) {
+            relativeMorphMagnitude[c] = morph[c];
+            if (morph[c] > 0.f) {
+                if (morph[c] < 1.f) {
+                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
                 }
-                else {
-                    if (carriers[centerMorphScene[c]].count() > 0 && carriers[forwardMorphScene[c]].count() > 0)
-                        outputs[CARRIER_SUM_OUTPUT].setVoltage(carSumOut[c] / totalCarSumConnection[c], c);
-                    else {
-                        if (carriers[centerMorphScene[c]].count() == 0)
-                            outputs[CARRIER_SUM_OUTPUT].setVoltage(carSumOut[c] * (1.f / totalCarSumConnection[c]) * relativeMorphMagnitude[c], c);
-                        else
-                            outputs[CARRIER_SUM_OUTPUT].setVoltage(carSumOut[c] * (1.f / totalCarSumConnection[c]) * (1.f - relativeMorphMagnitude[c]), c);
-                    }
+                else if (morph[c] == 1.f) {
+                    relativeMorphMagnitude[c] = 0.f;
+                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
                 }
-            }
-        }
-        if (outputs[MODULATOR_SUM_OUTPUT].isConnected()) {
-            outputs[MODULATOR_SUM_OUTPUT].setChannels(this->channels);
-            for (int c = 0; c < this->channels; c++) {
-                int centerModulators = modulators[centerMorphScene[c]];
-                int forwardModulators = modulators[forwardMorphScene[c]];
-                float centerOut = 0.f, forwardOut = 0.f;
-                if (centerModulators && forwardModulators) {
-                    float morphModulators = crossfade(centerModulators, forwardModulators, relativeMorphMagnitude[c]);
-                    outputs[MODULATOR_SUM_OUTPUT].setVoltage(modSumOut[c] / morphModulators, c);
+                else if (morph[c] < 2.f) {
+                    relativeMorphMagnitude[c] -= 1.f;
+                    centerMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                }
+                else if (morph[c] == 2.f) {
+                    relativeMorphMagnitude[c] = 0.f;
+                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
+                }
+                else if (morph[c] < 3.f) {
+                    relativeMorphMagnitude[c] -= 2.f;
+                    centerMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
                 }
                 else {
-                    if (centerModulators > 0)
-                        centerOut = modSumOut[c] / centerModulators;
-                    if (forwardModulators > 0)
-                        forwardOut = modSumOut[c] / forwardModulators;
-                    outputs[MODULATOR_SUM_OUTPUT].setVoltage(crossfade(centerOut, forwardOut, relativeMorphMagnitude[c]), c);
+                    relativeMorphMagnitude[c] = 0.f;
+                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
                 }
-                // if (processCV)
-                //     DEBUG("Modulators center: %d, forward: %d, morph: %f", centerModulators, forwardModulators, morphModulators);
-            }
-        }
-    }
-    else {
-        if (outputs[CARRIER_SUM_OUTPUT].isConnected()) {
-            outputs[CARRIER_SUM_OUTPUT].setChannels(this->channels);
-            outputs[CARRIER_SUM_OUTPUT].writeVoltages(carSumOut);
-        }
-        if (outputs[MODULATOR_SUM_OUTPUT].isConnected()) {
-            outputs[MODULATOR_SUM_OUTPUT].setChannels(this->channels);
-            outputs[MODULATOR_SUM_OUTPUT].writeVoltages(modSumOut);
-        }
-    }
-    if (outputs[PHASE_OUTPUT].isConnected()) {
-        outputs[PHASE_OUTPUT].setChannels(this->channels);
-        outputs[PHASE_OUTPUT].writeVoltages(phaseOut);
-    }
-
-    //Set lights
-    if (lightDivider.process()) {
-        rotor.step(args.sampleTime * lightDivider.getDivision());
-        if (configMode) {   //Display state without morph, highlight configScene
-            //Set purple component to off
-            lights[DISPLAY_BACKLIGHT].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-            //Set yellow component
-            lights[DISPLAY_BACKLIGHT + 1].setSmoothBrightness(getOutputBrightness(CARRIER_SUM_OUTPUT) / 2048.f + .005f / 3.f, args.sampleTime * lightDivider.getDivision());
-            //Set edit light
-            lights[EDIT_LIGHT].setSmoothBrightness(1.f, args.sampleTime * lightDivider.getDivision());
-            //Set scene lights
-            for (int i = 0; i < 3; i++) {
-                //Set purple components to off
-                lights[SCENE_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                lights[SCENE_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                //Set yellow components depending on config scene and blink status
-                lights[SCENE_LIGHTS + i * 3 + 1].setSmoothBrightness(configScene == i ? 1.f : 0.f, args.sampleTime * lightDivider.getDivision());
-                lights[SCENE_INDICATORS + i * 3 + 1].setSmoothBrightness(configScene == i ?
-                    INDICATOR_BRIGHTNESS
-                    : 0.f, args.sampleTime * lightDivider.getDivision());
             }
-            //Set op/mod lights
-            for (int i = 0; i < 4; i++) {
-                if (horizontalMarks[configScene].test(i)) {
-                    if (modeB) {
-                        //Set carrier indicator
-                        // In (config + alter ego) mode, when a selected operator is a forced-carrier,
-                        // the purple indicator should blink on/off whenever the yellow selection indicator blinks off/on,
-                        // regardless of whether it is horizontally marked.
-                        if (forcedCarriers[configScene].test(i)) {
-                            //Purple light
-                            lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(configOp == i ?
-                                blinkStatus ?
-                                    0.f
-                                    : INDICATOR_BRIGHTNESS
-                                : INDICATOR_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                            //Yellow light
-                            lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(configOp == i ?
-                                blinkStatus
-                                : 0.f, args.sampleTime * lightDivider.getDivision());
-                            //Red light
-                            lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        }
-                        else {
-                            //Purple light
-                            lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                            //Yellow light
-                            lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                            //Red light
-                            lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        }
-                        //Set op lights
-                        //Purple lights
-                        lights[OPERATOR_LIGHTS + i * 3].setSmoothBrightness(configOp == i ?
-                            blinkStatus ?
-                                0.f
-                                : DEF_RED_BRIGHTNESS
-                            : DEF_RED_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                        //Yellow Lights
-                        lights[OPERATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(configOp == i ?
-                            blinkStatus
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
-                        //Red lights
-                        lights[OPERATOR_LIGHTS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    }
-                    else {
-                        //Set carrier indicator
-                        // In config mode, when a selected operator is both a forced-carrier and disabled,
-                        // the red indicator should blink on/off whenever the yellow selection indicator blinks off/on.
-                        if (forcedCarriers[configScene].test(i)) {
-                            //Purple light
-                            lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                            //Yellow light
-                            lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(configOp == i ?
-                                blinkStatus
-                                : 0.f, args.sampleTime * lightDivider.getDivision());
-                            //Red light
-                            lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(configOp == i ?
-                                blinkStatus ?
-                                    0.f
-                                    : DEF_RED_BRIGHTNESS
-                                : DEF_RED_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                        }
-                        else {
-                            //Purple light
-                            lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                            //Yellow light
-                            lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                            //Red light
-                            lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        }
-                        //Set op lights
-                        //Purple lights
-                        lights[OPERATOR_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        //Yellow Lights
-                        lights[OPERATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(configOp == i ?
-                            blinkStatus
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
-                        //Red lights
-                        lights[OPERATOR_LIGHTS + i * 3 + 2].setSmoothBrightness(configOp == i ?
-                            blinkStatus ?
-                                0.f
-                                : DEF_RED_BRIGHTNESS
-                            : DEF_RED_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                    }
+            else if (morph[c] == 0.f)
+                centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+            else {
+                relativeMorphMagnitude[c] *= -1.f;
+                if (morph[c] > -1.f) {
+                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
                 }
-                else {
-                    //Set carrier indicator
-                    // In config mode, if a non-horizontal-marked operator is a forced-carrier,
-                    // the purple indicator should blink on/off whenever the yellow selection indicator blinks off/on.
-                    if (forcedCarriers[configScene].test(i)) {
-                        //Purple light
-                        lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(configOp == i ?
-                            blinkStatus ?
-                                0.f
-                                : INDICATOR_BRIGHTNESS
-                            : INDICATOR_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                        //Yellow light
-                        lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(configOp == i ?
-                            blinkStatus
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
-                        //Red light
-                        lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    }
-                    else {
-                        //Purple light
-                        lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        //Yellow light
-                        lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        //Red light
-                        lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    }
-                    //Set op lights
-                    //Purple lights
-                    lights[OPERATOR_LIGHTS + i * 3].setSmoothBrightness(configOp == i ?
-                        blinkStatus ?
-                            0.f
-                            : getInputBrightness(OPERATOR_INPUTS + i)
-                        : getInputBrightness(OPERATOR_INPUTS + i), args.sampleTime * lightDivider.getDivision());
-                    //Yellow Lights
-                    lights[OPERATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(configOp == i ? blinkStatus : 0.f, args.sampleTime * lightDivider.getDivision());
-                    //Red lights
-                    lights[OPERATOR_LIGHTS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
+                else if (morph[c] == -1.f) {
+                    relativeMorphMagnitude[c] = 0.f;
+                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
                 }
-                //Set mod lights
-                if (i != configOp) {
-                    //Purple lights
-                    lights[MODULATOR_LIGHTS + i * 3].setSmoothBrightness(configOp > -1 ?
-                        algoName[configScene].test(configOp * 3 + absToRel[configOp][i]) ?
-                            blinkStatus ?
-                                0.f
-                                : getOutputBrightness(MODULATOR_OUTPUTS + i)
-                            : getOutputBrightness(MODULATOR_OUTPUTS + i)
-                        : getOutputBrightness(MODULATOR_OUTPUTS + i), args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[MODULATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(configOp > -1 ?
-                        (algoName[configScene].test(configOp * 3 + absToRel[configOp][i]) ?
-                            blinkStatus
-                            : 0.f)
-                        : 0.f, args.sampleTime * lightDivider.getDivision());
+                else if (morph[c] > -2.f) {
+                    relativeMorphMagnitude[c] -= 1.f;
+                    centerMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                }
+                else if (morph[c] == -2.f) {
+                    relativeMorphMagnitude[c] = 0.f;
+                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
+                }
+                else if (morph[c] < 3.f) {
+                    relativeMorphMagnitude[c] -= 2.f;
+                    centerMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
                 }
                 else {
-                    if (modeB) {
-                        //Purple lights
-                        lights[MODULATOR_LIGHTS + i * 3].setSmoothBrightness(getOutputBrightness(MODULATOR_OUTPUTS + i), args.sampleTime * lightDivider.getDivision());
-                        //Yellow lights
-                        lights[MODULATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(horizontalMarks[configScene].test(configOp) ?
-                            blinkStatus
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
-                    }
-                    else {
-                        //Purple lights
-                        lights[MODULATOR_LIGHTS + i * 3].setSmoothBrightness(horizontalMarks[configScene].test(configOp) ?
-                            blinkStatus ?
-                                0.f
-                                : getOutputBrightness(MODULATOR_OUTPUTS + i)
-                            : getOutputBrightness(MODULATOR_OUTPUTS + i), args.sampleTime * lightDivider.getDivision());
-                        //Yellow lights
-                        lights[MODULATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(horizontalMarks[configScene].test(configOp) ?
-                            blinkStatus
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
-                    }
+                    relativeMorphMagnitude[c] = 0.f;
+                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
                 }
             }
-            //Check and update blink timer
-            if (blinkTimer > BLINK_INTERVAL / lightDivider.getDivision()) {
-                blinkStatus ^= true;
-                blinkTimer = 0.f;
-            }
-            else
-                blinkTimer += args.sampleTime;
-            //Set connection lights
-            if (modeB) {
-                for (int i = 0; i < 12; i++) {
-                    //Purple lights
-                    lights[CONNECTION_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(algoName[configScene].test((i / 3) * 3 + (i % 3)) ?
-                        0.4f
-                        : 0.f, args.sampleTime * lightDivider.getDivision());
-                    //Set diagonal disable lights
-                    lights[D_DISABLE_LIGHTS + i].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
+        }
+    }
+    else {
+        for (int c = 0; c < this->channels; c++) {
+            relativeMorphMagnitude[c] = morph[c];
+            if (morph[c] > 0.f) {
+                if (morph[c] <= 1.f) {
+                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
                 }
-                for (int i = 0; i < 4; i++) {
-                    //Purple lights
-                    lights[H_CONNECTION_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(horizontalMarks[configScene].test(i) ?
-                        0.4f
-                        : 0.f, args.sampleTime * lightDivider.getDivision());
-                    //Red lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
+                else if (morph[c] < 2.f) {
+                    relativeMorphMagnitude[c] -= (relativeMorphMagnitude[c] - 1.f) * 2.f;
+                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
                 }
-            }
-            else {
-                for (int i = 0; i < 12; i++) {
-                    //Purple lights
-                    lights[CONNECTION_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(!horizontalMarks[configScene].test(i / 3) ? 
-                        algoName[configScene].test((i / 3) * 3 + (i % 3)) ?
-                            0.4f
-                            : 0.f
-                        : 0.f, args.sampleTime * lightDivider.getDivision());
-                    //Set diagonal disable lights
-                    lights[D_DISABLE_LIGHTS + i].setSmoothBrightness(!horizontalMarks[configScene].test(i / 3) ? 
-                        0.f
-                        : algoName[configScene].test((i / 3) * 3 + (i % 3)) ?
-                            DEF_RED_BRIGHTNESS
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
+                else if (morph[c] == 2.f) {
+                    relativeMorphMagnitude[c] = 0.f;
+                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
                 }
-                //Set horizontal lights
-                for (int i = 0; i < 4; i++) {
-                    //Purple lights
-                    lights[H_CONNECTION_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Red lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 2].setSmoothBrightness(!horizontalMarks[configScene].test(i) ?
-                        0.f
-                        : DEF_RED_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
+                else {
+                    relativeMorphMagnitude[c] -= (relativeMorphMagnitude[c] - 1.f) * 2.f;
+                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
                 }
             }
-            //Set screen button ring light if pressed
-            //Purple lights
-            lights[SCREEN_BUTTON_RING_LIGHT].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-            //Yellow lights
-            lights[SCREEN_BUTTON_RING_LIGHT + 1].setSmoothBrightness(params[SCREEN_BUTTON].getValue(), args.sampleTime * lightDivider.getDivision());
-        } 
-        else {
-            //Set backlight
-            //Set yellow component to off
-            lights[DISPLAY_BACKLIGHT + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-            //Set purple component
-            lights[DISPLAY_BACKLIGHT].setSmoothBrightness(getOutputBrightness(CARRIER_SUM_OUTPUT) / 1024.f + 0.0975f, args.sampleTime * lightDivider.getDivision());
-            //Set edit light
-            lights[EDIT_LIGHT].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-            //Display morphed state
-            float brightness;
-            //Set scene lights
-            for (int i = 0; i < 3; i++) {
-                //Set all components to off
-                lights[SCENE_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                lights[SCENE_LIGHTS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                lights[SCENE_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                lights[SCENE_INDICATORS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                //Set base scene indicator purple component
-                lights[SCENE_INDICATORS + i * 3].setSmoothBrightness(i == (baseScene + sceneOffset[0]) % 3 ? 
-                    INDICATOR_BRIGHTNESS
-                    : 0.f, args.sampleTime * lightDivider.getDivision());
-            }
-            //Set center morph scene light's purple component depending on morph
-            lights[SCENE_LIGHTS + centerMorphScene[0] * 3].setSmoothBrightness(1.f - relativeMorphMagnitude[0], args.sampleTime * lightDivider.getDivision());
-            //Set morph target light's purple component depending on morph
-            lights[SCENE_LIGHTS + forwardMorphScene[0] * 3].setSmoothBrightness(relativeMorphMagnitude[0], args.sampleTime * lightDivider.getDivision());
-            //Set op/mod lights and carrier indicators
-            updateSceneBrightnesses();
-            for (int i = 0; i < 4; i++) {
-                //Purple, yellow, and red lights
-                for (int j = 0; j < 3; j++) {
-                    lights[OPERATOR_LIGHTS + i * 3 + j].setSmoothBrightness(crossfade(sceneBrightnesses[centerMorphScene[0]][i][j], sceneBrightnesses[forwardMorphScene[0]][i][j], relativeMorphMagnitude[0]), args.sampleTime * lightDivider.getDivision()); 
-                    lights[MODULATOR_LIGHTS + i * 3 + j].setSmoothBrightness(crossfade(sceneBrightnesses[centerMorphScene[0]][i + 4][j], sceneBrightnesses[forwardMorphScene[0]][i + 4][j], relativeMorphMagnitude[0]), args.sampleTime * lightDivider.getDivision()); 
-                    lights[CARRIER_INDICATORS + i * 3 + j].setSmoothBrightness(crossfade(sceneBrightnesses[centerMorphScene[0]][i + 8][j], sceneBrightnesses[forwardMorphScene[0]][i + 8][j], relativeMorphMagnitude[0]), args.sampleTime * lightDivider.getDivision()); 
+            else if (morph[c] == 0.f)
+                centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+            else {
+                relativeMorphMagnitude[c] *= -1.f;
+                if (morph[c] >= -1.f) {
+                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
                 }
-            }
-            //Set connection lights
-            if (modeB) {
-                for (int i = 0; i < 4; i++) {
-                    brightness = 0.f;
-                    if (horizontalMarks[centerMorphScene[0]].test(i))
-                        brightness += getOutputBrightness(MODULATOR_OUTPUTS + i) * (1.f - relativeMorphMagnitude[0]);
-                    if (horizontalMarks[forwardMorphScene[0]].test(i))
-                        brightness += getOutputBrightness(MODULATOR_OUTPUTS + i) * relativeMorphMagnitude[0];
-                    //Purple lights
-                    lights[H_CONNECTION_LIGHTS + i * 3].setSmoothBrightness(brightness, args.sampleTime * lightDivider.getDivision());
-                    //Yellow
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Red
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
+                else if (morph[c] > -2.f) {
+                    relativeMorphMagnitude[c] -= (relativeMorphMagnitude[c] - 1.f) * 2.f;
+                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
                 }
-                for (int i = 0; i < 12; i++) {
-                    brightness = 0.f;
-                    if (algoName[centerMorphScene[0]].test((i / 3) * 3 + (i % 3)))
-                        brightness += getOutputBrightness(MODULATOR_OUTPUTS + i / 3) * (1.f - relativeMorphMagnitude[0]);
-                    if (algoName[forwardMorphScene[0]].test((i / 3) * 3 + (i % 3)))
-                        brightness += getOutputBrightness(MODULATOR_OUTPUTS + i / 3) * relativeMorphMagnitude[0];
-                    //Purple lights
-                    lights[CONNECTION_LIGHTS + i * 3].setSmoothBrightness(brightness, args.sampleTime * lightDivider.getDivision());
-                    //Yellow
-                    lights[CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Set diagonal disable lights
-                    lights[D_DISABLE_LIGHTS + i].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
+                else if (morph[c] == -2.f) {
+                    relativeMorphMagnitude[c] = 0.f;
+                    centerMorphScene[c] = forwardMorphScene[c] = backwardMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
                 }
-            }
-            else {
-                for (int i = 0; i < 4; i++) {
-                    brightness = getInputBrightness(OPERATOR_INPUTS + i);
-                    for (int j = 0; j < 3; j++) {
-                        float morphBrightness = 0.f;
-                        if (algoName[centerMorphScene[0]].test(i * 3 + j)) {
-                            if (!horizontalMarks[centerMorphScene[0]].test(i))
-                                morphBrightness += brightness * (1.f - relativeMorphMagnitude[0]);
-                        }
-                        if (algoName[forwardMorphScene[0]].test(i * 3 + j)) {
-                            if (!horizontalMarks[forwardMorphScene[0]].test(i))
-                                morphBrightness += brightness * relativeMorphMagnitude[0];
-                        }
-                        //Purple lights
-                        lights[CONNECTION_LIGHTS + i * 9 + j * 3].setSmoothBrightness(morphBrightness, args.sampleTime * lightDivider.getDivision());
-                        //Yellow
-                        lights[CONNECTION_LIGHTS + i * 9 + j * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        //Set diagonal disable lights
-                        lights[D_DISABLE_LIGHTS + i * 3 + j].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    }
-                    //Set horizontal disable lights
-                    float horizontalMorphBrightness = 0.f;
-                    if (horizontalMarks[centerMorphScene[0]].test(i))
-                        horizontalMorphBrightness += (1.f - relativeMorphMagnitude[0]);
-                    if (horizontalMarks[forwardMorphScene[0]].test(i))
-                        horizontalMorphBrightness += relativeMorphMagnitude[0];
-                    //Purple lights
-                    lights[H_CONNECTION_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Red lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 2].setSmoothBrightness(horizontalMorphBrightness * DEF_RED_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
+                else {
+                    relativeMorphMagnitude[c] -= (relativeMorphMagnitude[c] - 1.f) * 2.f;
+                    centerMorphScene[c] = (baseScene + sceneOffset[c]) % 3;
+                    forwardMorphScene[c] = (baseScene + sceneOffset[c] + 1) % 3;
+                    backwardMorphScene[c] = (baseScene + sceneOffset[c] + 2) % 3;
                 }
             }
-            //Set screen button ring light if pressed
-            //Purple lights
-            lights[SCREEN_BUTTON_RING_LIGHT].setSmoothBrightness(params[SCREEN_BUTTON].getValue(), args.sampleTime * lightDivider.getDivision());
-            //Yellow lights
-            lights[SCREEN_BUTTON_RING_LIGHT + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
         }
     }
-
-    if (clockIgnoreOnReset > 0l)
-        clockIgnoreOnReset--;
 }
 
-float AlgomorphLarge::routeHorizontal(float sampleTime, float inputVoltage, int op, int c) {
-    float connectionA = horizontalMarks[centerMorphScene[c]].test(op) * (1.f - relativeMorphMagnitude[c]);
-    float connectionB = horizontalMarks[forwardMorphScene[c]].test(op) * (relativeMorphMagnitude[c]);
-    float morphedConnection = connectionA + connectionB;
-    modClickGain[op][op][c] = clickFilterEnabled ? modClickFilters[op][op][c].process(sampleTime, morphedConnection) : morphedConnection;
-    return (inputVoltage + scaledAuxVoltage[AuxInputModes::SHADOW + op][c]) * modClickGain[op][op][c];
-}
+// Lanes take their modes from the expander, and are dropped along with their modes when it goes away
+void AlgomorphLarge::updateAuxLanes(const AuxLaneMessage* lanes) {
+    for (int lane = 0; lane < NUM_AUX_LANES; lane++) {
+        int auxIndex = NUM_AUX_INPUTS + lane;
+        AuxInput* input = auxInput[auxIndex];
+        int oldMode = input->activeModes > 0 ? input->lastSetMode : -1;
+        int newMode = lanes ? lanes->mode[lane] : -1;
+        if (newMode != oldMode) {
+            if (oldMode > -1) {
+                unsetAuxMode(auxIndex, oldMode);
+                for (int c = 0; c < 16; c++)
+                    input->voltage[oldMode][c] = input->defVoltage[oldMode];
+                rescaleVoltage(oldMode, 16);
+            }
+            if (newMode > -1)
+                input->setMode(newMode);
+        }
 
-float AlgomorphLarge::routeHorizontalRing(float sampleTime, float inputVoltage, int op, int c) {
-    float connection = horizontalMarks[backwardMorphScene[c]].test(op) * relativeMorphMagnitude[c];
-    modRingClickGain[op][op][c] = clickFilterEnabled ? modRingClickFilters[op][op][c].process(sampleTime, connection) : connection;
-    return (-inputVoltage - scaledAuxVoltage[AuxInputModes::SHADOW + op][c]) * modRingClickGain[op][op][c];
+        if (lanes && lanes->channels[lane] > 0) {
+            input->connected = true;
+            input->updateVoltage(lanes->voltage[lane]);
+        }
+        else if (input->connected) {
+            input->connected = false;
+            input->resetVoltages();
+            running = true;
+            rescaleVoltages(16);
+        }
+    }
+    auxSources = lanes ? NUM_AUX_SOURCES : NUM_AUX_INPUTS;
 }
 
-float AlgomorphLarge::routeDiagonal(float sampleTime, float inputVoltage, int op, int mod, int c) {
-    float connectionA = algoName[centerMorphScene[c]].test(op * 3 + mod)   * (1.f - relativeMorphMagnitude[c])  * !horizontalMarks[centerMorphScene[c]].test(op);
-    float connectionB = algoName[forwardMorphScene[c]].test(op * 3 + mod)  * relativeMorphMagnitude[c]          * !horizontalMarks[forwardMorphScene[c]].test(op);
-    float morphedConnection = connectionA + connectionB;
-    modClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, morphedConnection) : morphedConnection;
-    return (inputVoltage + scaledAuxVoltage[AuxInputModes::SHADOW + op][c]) * modClickGain[op][relToAbs[op][mod]][c];
+void AlgomorphLarge::getBankSlot(BankSlot* slot) {
+    *slot = BankSlot();
+    for (int scene = 0; scene < 3; scene++) {
+        slot->algoName[scene] = algoName[scene].to_ulong();
+        slot->horizontalMarks[scene] = horizontalMarks[scene].to_ulong();
+        slot->forcedCarriers[scene] = forcedCarriers[scene].to_ulong();
+    }
+    slot->flags = (modeB ? BankSlot::MODE_B : 0) | (ringMorph ? BankSlot::RING_MORPH : 0);
 }
 
-float AlgomorphLarge::routeDiagonalB(float sampleTime, float inputVoltage, int op, int mod, int c) {
-    float connectionA = algoName[centerMorphScene[c]].test(op * 3 + mod)   * (1.f - relativeMorphMagnitude[c]);
-    float connectionB = algoName[forwardMorphScene[c]].test(op * 3 + mod)  * relativeMorphMagnitude[c];
-    float morphedConnection = connectionA + connectionB;
-    modClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, morphedConnection) : morphedConnection;
-    return (inputVoltage + scaledAuxVoltage[AuxInputModes::SHADOW + op][c]) * modClickGain[op][relToAbs[op][mod]][c];
+// What the patch saves: the live scenes, unless the bank slot CV routes a slot over them
+void AlgomorphLarge::getPatchScenes(BankSlot* scenes) {
+    if (cvBankSlot)
+        *scenes = patchScenes;
+    else
+        getBankSlot(scenes);
 }
 
-float AlgomorphLarge::routeDiagonalRing(float sampleTime, float inputVoltage, int op, int mod, int c) {
-    float connection = algoName[backwardMorphScene[c]].test(op * 3 + mod) * relativeMorphMagnitude[c] * !horizontalMarks[backwardMorphScene[c]].test(op);
-    modRingClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modRingClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, connection) : connection; 
-    return (-inputVoltage + scaledAuxVoltage[AuxInputModes::SHADOW + op][c]) * modRingClickGain[op][relToAbs[op][mod]][c];
+// Only the stored algorithms change, so the click filters crossfade the routing as they would an edit
+void AlgomorphLarge::loadBankSlot(const BankSlot* slot) {
+    modeB = slot->flags & BankSlot::MODE_B;
+    ringMorph = slot->flags & BankSlot::RING_MORPH;
+    for (int scene = 0; scene < 3; scene++) {
+        algoName[scene] = slot->algoName[scene];
+        horizontalMarks[scene] = slot->horizontalMarks[scene];
+        forcedCarriers[scene] = slot->forcedCarriers[scene];
+        updateCarriers(scene);
+        updateModulators(scene);
+        updateOpsDisabled(scene);
+        updateDisplayAlgo(scene);
+    }
+    graphDirty = true;
 }
 
-float AlgomorphLarge::routeDiagonalRingB(float sampleTime, float inputVoltage, int op, int mod, int c) {
-    float connection = algoName[backwardMorphScene[c]].test(op * 3 + mod) * relativeMorphMagnitude[c];
-    modRingClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modRingClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, connection) : connection; 
-    return (-inputVoltage + scaledAuxVoltage[AuxInputModes::SHADOW + op][c]) * modRingClickGain[op][relToAbs[op][mod]][c];
-}
+void AlgomorphLarge::getLinkScenes(LinkScenes* scenes) {
+    for (int scene = 0; scene < 3; scene++) {
+        scenes->modulators[scene] = modulators[scene];
+        scenes->algoName[scene] = algoName[scene].to_ulong();
+        scenes->horizontalMarks[scene] = horizontalMarks[scene].to_ulong();
+        scenes->forcedCarriers[scene] = forcedCarriers[scene].to_ulong();
+        scenes->carriers[scene] = carriers[scene].to_ulong();
+        scenes->opsDisabled[scene] = opsDisabled[scene].to_ulong();
+    }
+    scenes->modeB = modeB;
+    scenes->ringMorph = ringMorph;
+}
+
+void AlgomorphLarge::publishLink(LinkMessage* out, int sceneOffset) {
+    out->valid = true;
+    getLinkScenes(&out->scenes);
+    out->baseScene = baseScene;
+    out->sceneOffset = sceneOffset;
+    out->channels = this->channels;
+    std::copy(morph, morph + this->channels, out->morph);
+    std::copy(relativeMorphMagnitude, relativeMorphMagnitude + this->channels, out->relativeMorphMagnitude);
+    std::copy(centerMorphScene, centerMorphScene + this->channels, out->centerMorphScene);
+    std::copy(forwardMorphScene, forwardMorphScene + this->channels, out->forwardMorphScene);
+    std::copy(backwardMorphScene, backwardMorphScene + this->channels, out->backwardMorphScene);
+}
+
+// Channels past the leader's count follow its first channel, like a mono CV would
+void AlgomorphLarge::followLink(const LinkMessage* link, int* sceneOffset, float* phaseOut) {
+    LinkScenes scenes;
+    getLinkScenes(&scenes);
+    if (std::memcmp(&scenes, &link->scenes, sizeof(LinkScenes))) {
+        for (int scene = 0; scene < 3; scene++) {
+            modulators[scene] = link->scenes.modulators[scene];
+            algoName[scene] = link->scenes.algoName[scene];
+            horizontalMarks[scene] = link->scenes.horizontalMarks[scene];
+            forcedCarriers[scene] = link->scenes.forcedCarriers[scene];
+            carriers[scene] = link->scenes.carriers[scene];
+            opsDisabled[scene] = link->scenes.opsDisabled[scene];
+        }
+        modeB = link->scenes.modeB;
+        ringMorph = link->scenes.ringMorph;
+        for (int scene = 0; scene < 3; scene++) {
+            updateSceneCounts(scene);
+            updateDisplayAlgo(scene);
+        }
+        graphDirty = true;
+    }
+    if (configMode || baseScene != link->baseScene)
+        graphDirty = true;
+    configMode = false;
+    configOp = -1;
+    baseScene = link->baseScene;
+    sceneOffset[0] = link->sceneOffset;
 
-float AlgomorphLarge::routeSum(float sampleTime, float inputVoltage, int op, int c) {
-    float connection    =   carriers[centerMorphScene[c]].test(op)     * (1.f - relativeMorphMagnitude[c])  * !horizontalMarks[centerMorphScene[c]].test(op)
-                        +   carriers[forwardMorphScene[c]].test(op)    * relativeMorphMagnitude[c]          * !horizontalMarks[forwardMorphScene[c]].test(op);
-    sumClickGain[op][c] = clickFilterEnabled ? sumClickFilters[op][c].process(sampleTime, connection) : connection;
-    totalCarSumConnection[c] += sumClickGain[op][c];
-    return (inputVoltage + scaledAuxVoltage[AuxInputModes::SHADOW + op][c]) * sumClickGain[op][c];
+    for (int c = 0; c < this->channels; c++) {
+        int l = c < link->channels ? c : 0;
+        morph[c] = link->morph[l];
+        relativeMorphMagnitude[c] = link->relativeMorphMagnitude[l];
+        centerMorphScene[c] = link->centerMorphScene[l];
+        forwardMorphScene[c] = link->forwardMorphScene[l];
+        backwardMorphScene[c] = link->backwardMorphScene[l];
+        phaseOut[c] = morph[c];
+        while (phaseOut[c] > 1.f)
+            phaseOut[c] = -1 + (phaseOut[c] - 1.f);
+        while (phaseOut[c] < -1.f)
+            phaseOut[c] = 1.f + (phaseOut[c] + 1.f);
+        phaseOut[c] = rack::math::rescale(phaseOut[c], -1.f, 1.f, phaseMin, phaseMax);
+    }
 }
 
-float AlgomorphLarge::routeSumB(float sampleTime, float inputVoltage, int op, int c) {
-    float connection    =   carriers[centerMorphScene[c]].test(op)     * (1.f - relativeMorphMagnitude[c])
-                        +   carriers[forwardMorphScene[c]].test(op)    * relativeMorphMagnitude[c];
-    sumClickGain[op][c] = clickFilterEnabled ? sumClickFilters[op][c].process(sampleTime, connection) : connection;
-    totalCarSumConnection[c] += sumClickGain[op][c];
-    return (inputVoltage + scaledAuxVoltage[AuxInputModes::SHADOW + op][c]) * sumClickGain[op][c];
-}
+// Applies this sample's per-channel routing gains to every Algomorph Wide voice group, 4 voices at a time.
+// Voice c of each group is routed like channel c of the module, without the module's AUX shadow voltages.
+// The sum scales already hold average mode's normalization, as for the module's own sum outputs.
+void AlgomorphLarge::processWide(const WideInputMessage* in, WideOutputMessage* out, const float* modScale, const float* carSumScale, const float* modSumScale, const float* wildcardMod, const float* wildcardSum, float wildcardModGain) {
+    using rack::simd::float_4;
+    float opGain = params[AUX_KNOBS + AuxKnobModes::OP_GAIN].getValue();
 
-float AlgomorphLarge::routeSumRing(float sampleTime, float inputVoltage, int op, int c) {
-    float connection = carriers[backwardMorphScene[c]].test(op) * relativeMorphMagnitude[c] * !horizontalMarks[backwardMorphScene[c]].test(op);
-    sumRingClickGain[op][c] = clickFilterEnabled ? sumRingClickFilters[op][c].process(sampleTime, connection) : connection;
-    totalCarSumConnection[c] += sumClickGain[op][c];
-    return (-inputVoltage - scaledAuxVoltage[AuxInputModes::SHADOW + op][c]) * sumRingClickGain[op][c];
-}
+    for (int group = 0; group < WIDE_GROUPS; group++) {
+        int groupChannels = 0;
+        for (int op = 0; op < 4; op++)
+            groupChannels = std::max(groupChannels, in->channels[group][op]);
+        groupChannels = std::min(groupChannels, this->channels);
+        out->channels[group] = groupChannels;
+
+        for (int c = 0; c < groupChannels; c += 4) {
+            float_4 input[4];
+            for (int op = 0; op < 4; op++)
+                input[op] = float_4::load(&in->in[group][op][c]) * opGain;
+            float_4 wildMod = float_4::load(&wildcardMod[c]) * wildcardModGain;
+
+            float_4 modSum = 0.f;
+            for (int mod = 0; mod < 4; mod++) {
+                float_4 modOut = 0.f;
+                for (int op = 0; op < 4; op++) {
+                    if (op == mod && !modeB)
+                        continue;
+                    modOut += input[op] * float_4::load(&modClickGain[op][mod][c]);
+                }
+                modSum += modOut;
+                ((modOut + wildMod) * float_4::load(&modScale[c])).store(&out->modOut[group][mod][c]);
+            }
+            if (wildModIsSummed)
+                modSum += wildMod;
+
+            float_4 carSum = float_4::load(&wildcardSum[c]);
+            for (int op = 0; op < 4; op++) {
+                carSum += input[op] * float_4::load(&sumClickGain[op][c]);
+            }
 
-float AlgomorphLarge::routeSumRingB(float sampleTime, float inputVoltage, int op, int c) {
-    float connection = carriers[backwardMorphScene[c]].test(op) * relativeMorphMagnitude[c];
-    sumRingClickGain[op][c] = clickFilterEnabled ? sumRingClickFilters[op][c].process(sampleTime, connection) : connection;
-    totalCarSumConnection[c] += sumClickGain[op][c];
-    return (-inputVoltage - scaledAuxVoltage[AuxInputModes::SHADOW + op][c]) * sumRingClickGain[op][c];
+            (carSum * float_4::load(&carSumScale[c])).store(&out->carSumOut[group][c]);
+            (modSum * float_4::load(&modSumScale[c])).store(&out->modSumOut[group][c]);
+        }
+    }
 }
 
 void AlgomorphLarge::scaleAuxSumAttenCV(int channels) {
     for (int c = 0; c < channels; c++) {
         scaledAuxVoltage[AuxInputModes::SUM_ATTEN][c] = 1.f;
-        for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+        for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
             scaledAuxVoltage[AuxInputModes::SUM_ATTEN][c] *= rack::math::clamp(auxInput[auxIndex]->voltage[AuxInputModes::SUM_ATTEN][c] / 5.f, -1.f, 1.f);
     }
 }
@@ -1279,7 +1394,7 @@ void AlgomorphLarge::scaleAuxSumAttenCV(int channels) {
 void AlgomorphLarge::scaleAuxModAttenCV(int channels) {
     for (int c = 0; c < channels; c++) {
         scaledAuxVoltage[AuxInputModes::MOD_ATTEN][c] = 1.f;
-        for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+        for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
             scaledAuxVoltage[AuxInputModes::MOD_ATTEN][c] *= rack::math::clamp(auxInput[auxIndex]->voltage[AuxInputModes::MOD_ATTEN][c] / 5.f, -1.f, 1.f);
     }    
 }
@@ -1288,7 +1403,7 @@ void AlgomorphLarge::scaleAuxClickFilterCV(int channels) {
     for (int c = 0; c < channels; c++) {
         //+/-5V = 0V-2V
         scaledAuxVoltage[AuxInputModes::CLICK_FILTER][c] = 1.f;
-        for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+        for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
             scaledAuxVoltage[AuxInputModes::CLICK_FILTER][c] *= (rack::math::clamp(auxInput[auxIndex]->voltage[AuxInputModes::CLICK_FILTER][c] / 5.f, -1.f, 1.f) + 1.001f);
     }    
 }
@@ -1296,7 +1411,7 @@ void AlgomorphLarge::scaleAuxClickFilterCV(int channels) {
 void AlgomorphLarge::scaleAuxMorphCV(int channels) {
     for (int c = 0; c < channels; c++) {
         scaledAuxVoltage[AuxInputModes::MORPH][c] = 0.f;
-        for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+        for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
             scaledAuxVoltage[AuxInputModes::MORPH][c] += auxInput[auxIndex]->voltage[AuxInputModes::MORPH][c] / 5.f;
     }
 }
@@ -1304,7 +1419,7 @@ void AlgomorphLarge::scaleAuxMorphCV(int channels) {
 void AlgomorphLarge::scaleAuxDoubleMorphCV(int channels) {
     for (int c = 0; c < channels; c++) {
         scaledAuxVoltage[AuxInputModes::DOUBLE_MORPH][c] = 0.f;
-        for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+        for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
             scaledAuxVoltage[AuxInputModes::DOUBLE_MORPH][c] += auxInput[auxIndex]->voltage[AuxInputModes::DOUBLE_MORPH][c] / FIVE_D_TWO;
     }
 }
@@ -1312,7 +1427,7 @@ void AlgomorphLarge::scaleAuxDoubleMorphCV(int channels) {
 void AlgomorphLarge::scaleAuxTripleMorphCV(int channels) {
     for (int c = 0; c < channels; c++) {
         scaledAuxVoltage[AuxInputModes::TRIPLE_MORPH][c] = 0.f;
-        for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+        for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
             scaledAuxVoltage[AuxInputModes::TRIPLE_MORPH][c] += auxInput[auxIndex]->voltage[AuxInputModes::TRIPLE_MORPH][c] / FIVE_D_THREE;
     }
 }
@@ -1320,7 +1435,7 @@ void AlgomorphLarge::scaleAuxTripleMorphCV(int channels) {
 void AlgomorphLarge::scaleAuxMorphAttenCV(int channels) {
     for (int c = 0; c < channels; c++) {
         scaledAuxVoltage[AuxInputModes::MORPH_ATTEN][c] = 1.f;
-        for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+        for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
             scaledAuxVoltage[AuxInputModes::MORPH_ATTEN][c] *= auxInput[auxIndex]->voltage[AuxInputModes::MORPH_ATTEN][c] / 5.f;
     }
 }
@@ -1328,7 +1443,7 @@ void AlgomorphLarge::scaleAuxMorphAttenCV(int channels) {
 void AlgomorphLarge::scaleAuxMorphDoubleAttenCV(int channels) {
     for (int c = 0; c < channels; c++) {
         scaledAuxVoltage[AuxInputModes::DOUBLE_MORPH_ATTEN][c] = 1.f;
-        for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+        for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
             scaledAuxVoltage[AuxInputModes::DOUBLE_MORPH_ATTEN][c] *= auxInput[auxIndex]->voltage[AuxInputModes::DOUBLE_MORPH_ATTEN][c] / FIVE_D_TWO;
     }
 }
@@ -1336,7 +1451,7 @@ void AlgomorphLarge::scaleAuxMorphDoubleAttenCV(int channels) {
 void AlgomorphLarge::scaleAuxMorphTripleAttenCV(int channels) {
     for (int c = 0; c < channels; c++) {
         scaledAuxVoltage[AuxInputModes::TRIPLE_MORPH_ATTEN][c] = 1.f;
-        for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+        for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
             scaledAuxVoltage[AuxInputModes::TRIPLE_MORPH_ATTEN][c] *= auxInput[auxIndex]->voltage[AuxInputModes::TRIPLE_MORPH_ATTEN][c] / FIVE_D_THREE;
     }
 }
@@ -1344,7 +1459,7 @@ void AlgomorphLarge::scaleAuxMorphTripleAttenCV(int channels) {
 void AlgomorphLarge::scaleAuxShadow(float sampleTime, int op, int channels) {
     for (int c = 0; c < channels; c++) {
         scaledAuxVoltage[AuxInputModes::SHADOW + op][c] = 0.f;
-        for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
+        for (int auxIndex = 0; auxIndex < auxSources; auxIndex++) {
             float gain = clickFilterEnabled ? auxInput[auxIndex]->shadowClickFilter[op].process(sampleTime, auxInput[auxIndex]->modeIsActive[AuxInputModes::SHADOW + op] * auxInput[auxIndex]->connected) : auxInput[auxIndex]->modeIsActive[AuxInputModes::SHADOW + op] * auxInput[auxIndex]->connected;
             scaledAuxVoltage[AuxInputModes::SHADOW + op][c] += gain * auxInput[auxIndex]->voltage[AuxInputModes::SHADOW + op][c];
         }
@@ -1383,7 +1498,7 @@ void AlgomorphLarge::rescaleVoltage(int mode, int channels) {
         default:
             for (int c = 0; c < channels; c++) {
                 scaledAuxVoltage[mode][c] = 0.f;
-                for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+                for (int auxIndex = 0; auxIndex < auxSources; auxIndex++)
                     scaledAuxVoltage[mode][c] += auxInput[auxIndex]->voltage[mode][c];
             }
             break;
@@ -1400,102 +1515,6 @@ void AlgomorphLarge::initRun() {
     baseScene = resetScene;
 }
 
-void AlgomorphLarge::updateSceneBrightnesses() {
-    if (modeB) {
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 4; j++) {
-                //Op lights
-                //Purple lights
-                sceneBrightnesses[i][j][0] = getInputBrightness(OPERATOR_INPUTS + j);
-
-                //Mod lights
-                //Purple lights
-                sceneBrightnesses[i][j + 4][0] = getOutputBrightness(MODULATOR_OUTPUTS + j);
-
-                //Op lights
-                //Yellow Lights
-                sceneBrightnesses[i][j][1] = 0.f;
-                //Red lights
-                sceneBrightnesses[i][j][2] = 0.f;
-
-                //Carrier indicators
-                if (forcedCarriers[i].test(j)) {
-                    //Purple lights
-                    sceneBrightnesses[i][j + 8][0] = INDICATOR_BRIGHTNESS;
-                }
-                else {
-                    //Purple lights
-                    sceneBrightnesses[i][j + 8][0] = 0.f;
-                }
-                //Yellow lights
-                sceneBrightnesses[i][j + 8][1] = 0.f;
-                //Red lights
-                sceneBrightnesses[i][j + 8][2] = 0.f;
-            }
-        }
-    }
-    else {
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 4; j++) {
-                if (!horizontalMarks[i].test(j)) {
-                    //Op lights
-                    //Purple lights
-                    sceneBrightnesses[i][j][0] = getInputBrightness(OPERATOR_INPUTS + j);
-                    //Red lights
-                    sceneBrightnesses[i][j][2] = 0.f;
-
-                    //Mod lights
-                    //Purple lights
-                    sceneBrightnesses[i][j + 4][0] = getOutputBrightness(MODULATOR_OUTPUTS + j);
-
-                    //Carrier indicators
-                    if (forcedCarriers[i].test(j)) {
-                        //Purple lights
-                        sceneBrightnesses[i][j + 8][0] = INDICATOR_BRIGHTNESS;
-                    }
-                    else {
-                        //Purple lights
-                        sceneBrightnesses[i][j + 8][0] = 0.f;
-                    }
-                    //Red lights
-                    sceneBrightnesses[i][j + 8][2] = 0.f;
-                }
-                else {
-                    //Op lights
-                    //Purple lights
-                    sceneBrightnesses[i][j][0] = 0.f;
-                    //Red lights
-                    sceneBrightnesses[i][j][2] = DEF_RED_BRIGHTNESS;
-
-                    //Mod lights
-                    //Purple lights
-                    sceneBrightnesses[i][j + 4][0] = getOutputBrightness(MODULATOR_OUTPUTS + j);
-
-                    //Carrier indicators
-                    if (forcedCarriers[i].test(j)) {
-                        //Red lights
-                        sceneBrightnesses[i][j + 8][2] = INDICATOR_BRIGHTNESS;
-                    }
-                    else {
-                        //Red lights
-                        sceneBrightnesses[i][j + 8][2] = 0.f;
-                    }
-                    //Purple lights
-                    sceneBrightnesses[i][j + 8][0] = 0.f;
-                }
-
-                //Op lights
-                //Yellow Lights
-                sceneBrightnesses[i][j][1] = 0.f;
-                
-                //Carrier indicators
-                //Yellow lights
-                sceneBrightnesses[i][j + 8][1] = 0.f;
-            }
-        }
-    }
-}
-
 bool AlgomorphLarge::auxInputsAreDefault() {
     for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
         if (auxInput[auxIndex]->allowMultipleModes != pluginSettings.allowMultipleModes[auxIndex])
@@ -1509,23 +1528,31 @@ bool AlgomorphLarge::auxInputsAreDefault() {
 }
 
 json_t* AlgomorphLarge::dataToJson() {
+    BankSlot scenes;
+    getPatchScenes(&scenes);
+
     json_t* rootJ = json_object();
     json_object_set_new(rootJ, "Config Enabled", json_boolean(configMode));
     json_object_set_new(rootJ, "Config Mode", json_integer(configOp));
     json_object_set_new(rootJ, "Config Scene", json_integer(configScene));
     json_object_set_new(rootJ, "Current Scene", json_integer(baseScene));
-    json_object_set_new(rootJ, "Horizontal Allowed", json_boolean(modeB));
+    json_object_set_new(rootJ, "Horizontal Allowed", json_boolean(scenes.flags & BankSlot::MODE_B));
     json_object_set_new(rootJ, "Reset Scene", json_integer(resetScene));
-    json_object_set_new(rootJ, "Ring Morph", json_boolean(ringMorph));
+    json_object_set_new(rootJ, "Ring Morph", json_boolean(scenes.flags & BankSlot::RING_MORPH));
     json_object_set_new(rootJ, "Randomize Ring Morph", json_boolean(randomRingMorph));
     json_object_set_new(rootJ, "Auto Exit", json_boolean(exitConfigOnConnect));
     json_object_set_new(rootJ, "CCW Scene Selection", json_boolean(ccwSceneSelection));
     json_object_set_new(rootJ, "Wildcard Modulator Summing Enabled", json_boolean(wildModIsSummed));
+    json_object_set_new(rootJ, "Follow Leader", json_boolean(followLeader));
+    json_object_set_new(rootJ, "Quiet Follower", json_boolean(quietFollower));
     json_object_set_new(rootJ, "Reset on Run", json_boolean(resetOnRun));
     json_object_set_new(rootJ, "Click Filter Enabled", json_boolean(clickFilterEnabled));
     json_object_set_new(rootJ, "Average Mode", json_boolean(avgMode));
     // json_object_set_new(rootJ, "Glowing Ink", json_boolean(glowingInk));
     json_object_set_new(rootJ, "VU Lights", json_boolean(vuLights));
+    json_object_set_new(rootJ, "Display Frame Rate", json_integer(displayFrameRate));
+    json_object_set_new(rootJ, "Scene Bank Slot", json_integer(bankSlot));
+    json_object_set_new(rootJ, "Block Size", json_integer(blockSize));
     
     json_t* lastSetModesJ = json_array();
     for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
@@ -1566,7 +1593,7 @@ json_t* AlgomorphLarge::dataToJson() {
     json_t* algoNamesJ = json_array();
     for (int scene = 0; scene < 3; scene++) {
         json_t* nameJ = json_object();
-        json_object_set_new(nameJ, (std::string("Algorithm ") + std::to_string(scene)).c_str(), json_integer(algoName[scene].to_ullong()));
+        json_object_set_new(nameJ, (std::string("Algorithm ") + std::to_string(scene)).c_str(), json_integer(scenes.algoName[scene]));
         json_array_append_new(algoNamesJ, nameJ);
     }
     json_object_set_new(rootJ, "Algorithms: Algorithm IDs", algoNamesJ);
@@ -1574,7 +1601,7 @@ json_t* AlgomorphLarge::dataToJson() {
     json_t* horizontalMarksJ = json_array();
     for (int scene = 0; scene < 3; scene++) {
         json_t* sceneMarksJ = json_object();
-        json_object_set_new(sceneMarksJ, (std::string("Algorithm ") + std::to_string(scene)).c_str(), json_integer(horizontalMarks[scene].to_ullong()));
+        json_object_set_new(sceneMarksJ, (std::string("Algorithm ") + std::to_string(scene)).c_str(), json_integer(scenes.horizontalMarks[scene]));
         json_array_append_new(horizontalMarksJ, sceneMarksJ);
     }
     json_object_set_new(rootJ, "Algorithms: Horizontal Marks", horizontalMarksJ);
@@ -1582,30 +1609,187 @@ json_t* AlgomorphLarge::dataToJson() {
     json_t* forcedCarriersJ = json_array();
     for (int scene = 0; scene < 3; scene++) {
         json_t* sceneForcedCarriers = json_object();
-        json_object_set_new(sceneForcedCarriers, (std::string("Algorithm ") + std::to_string(scene)).c_str(), json_integer(forcedCarriers[scene].to_ullong()));
+        json_object_set_new(sceneForcedCarriers, (std::string("Algorithm ") + std::to_string(scene)).c_str(), json_integer(scenes.forcedCarriers[scene]));
         json_array_append_new(forcedCarriersJ, sceneForcedCarriers);
     }
     json_object_set_new(rootJ, "Algorithms: Forced Carriers", forcedCarriersJ);
 
+    std::string state = stateToBase64(scenes);
+    if (!state.empty())
+        json_object_set_new(rootJ, "State", json_string(state.c_str()));
+
     return rootJ;
 }
 
+// Everything the legacy keys hold, bitpacked. Empty if a value doesn't fit its field.
+std::string AlgomorphLarge::stateToBase64(const BankSlot& scenes) {
+    PatchStateWriter w(STATE_VERSION);
+    w.writeBool(configMode);
+    w.writeBool(scenes.flags & BankSlot::MODE_B);
+    w.writeBool(scenes.flags & BankSlot::RING_MORPH);
+    w.writeBool(randomRingMorph);
+    w.writeBool(exitConfigOnConnect);
+    w.writeBool(ccwSceneSelection);
+    w.writeBool(wildModIsSummed);
+    w.writeBool(resetOnRun);
+    w.writeBool(clickFilterEnabled);
+    w.writeBool(avgMode);
+    w.writeBool(vuLights);
+    w.writeBool(followLeader);
+    w.writeBool(quietFollower);
+    w.writeInt(configOp, 8);
+    w.writeInt(configScene, 8);
+    w.writeInt(baseScene, 8);
+    w.writeInt(resetScene, 8);
+    w.writeInt(knobMode, 8);
+    w.writeInt(displayFrameRate, 16);
+    w.writeInt(bankSlot, 16);
+    w.writeInt(blockSize, 8);
+    for (int scene = 0; scene < 3; scene++) {
+        w.writeBits(scenes.algoName[scene], 16);
+        w.writeBits(scenes.horizontalMarks[scene], 4);
+        w.writeBits(scenes.forcedCarriers[scene], 4);
+    }
+    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
+        w.writeBool(auxInput[auxIndex]->allowMultipleModes);
+        w.writeBool(auxInput[auxIndex]->connected);
+        w.writeInt(auxInput[auxIndex]->lastSetMode, 8);
+        for (int mode = 0; mode < AuxInputModes::NUM_MODES; mode++)
+            w.writeBool(auxInput[auxIndex]->modeIsActive[mode]);
+    }
+    return w.exact ? w.toBase64() : "";
+}
+
+// Returns false, leaving the module untouched, if the state can't be read. Fields added after the state's version keep their defaults.
+bool AlgomorphLarge::stateFromBase64(const std::string& state) {
+    PatchStateReader r(state, STATE_VERSION);
+    bool newConfigMode = r.readBool();
+    bool newModeB = r.readBool();
+    bool newRingMorph = r.readBool();
+    bool newRandomRingMorph = r.readBool();
+    bool newExitConfigOnConnect = r.readBool();
+    bool newCcwSceneSelection = r.readBool();
+    bool newWildModIsSummed = r.readBool();
+    bool newResetOnRun = r.readBool();
+    bool newClickFilterEnabled = r.readBool();
+    bool newAvgMode = r.readBool();
+    bool newVuLights = r.readBool();
+    bool newFollowLeader = r.version >= 2 ? r.readBool() : false;
+    bool newQuietFollower = r.version >= 2 ? r.readBool() : false;
+    int newConfigOp = r.readInt(8);
+    int newConfigScene = r.readInt(8);
+    int newBaseScene = r.readInt(8);
+    int newResetScene = r.readInt(8);
+    int newKnobMode = r.readInt(8);
+    int newDisplayFrameRate = r.readInt(16);
+    int newBankSlot = r.version >= 3 ? r.readInt(16) : 0;
+    int newBlockSize = r.version >= 4 ? r.readInt(8) : 0;
+    uint32_t newAlgoName[3];
+    uint32_t newHorizontalMarks[3];
+    uint32_t newForcedCarriers[3];
+    for (int scene = 0; scene < 3; scene++) {
+        newAlgoName[scene] = r.readBits(16);
+        newHorizontalMarks[scene] = r.readBits(4);
+        newForcedCarriers[scene] = r.readBits(4);
+    }
+    bool newAllowMultipleModes[NUM_AUX_INPUTS];
+    bool newConnected[NUM_AUX_INPUTS];
+    int newLastSetMode[NUM_AUX_INPUTS];
+    bool newModeIsActive[NUM_AUX_INPUTS][AuxInputModes::NUM_MODES];
+    int savedModes = r.version >= 3 ? AuxInputModes::NUM_MODES : AuxInputModes::BANK_SLOT;    // Bank Slot is the last mode, added in 3
+    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
+        newAllowMultipleModes[auxIndex] = r.readBool();
+        newConnected[auxIndex] = r.readBool();
+        newLastSetMode[auxIndex] = r.readInt(8);
+        for (int mode = 0; mode < AuxInputModes::NUM_MODES; mode++)
+            newModeIsActive[auxIndex][mode] = mode < savedModes ? r.readBool() : false;
+    }
+    if (!r.ok)
+        return false;
+
+    configMode = newConfigMode;
+    modeB = newModeB;
+    ringMorph = newRingMorph;
+    randomRingMorph = newRandomRingMorph;
+    exitConfigOnConnect = newExitConfigOnConnect;
+    ccwSceneSelection = newCcwSceneSelection;
+    wildModIsSummed = newWildModIsSummed;
+    resetOnRun = newResetOnRun;
+    clickFilterEnabled = newClickFilterEnabled;
+    avgMode = newAvgMode;
+    vuLights = newVuLights;
+    followLeader = newFollowLeader;
+    quietFollower = newQuietFollower;
+    // Same ranges as the legacy keys. configScene is -1 before the first reset and 3 after it, until config mode picks one
+    configOp = rack::math::clamp(newConfigOp, -1, 3);
+    configScene = rack::math::clamp(newConfigScene, -1, 3);
+    baseScene = rack::math::clamp(newBaseScene, 0, 2);
+    resetScene = rack::math::clamp(newResetScene, 0, 2);
+    knobMode = newKnobMode;
+    displayFrameRate = newDisplayFrameRate;
+    bankSlot = rack::math::clamp(newBankSlot, 0, BANK_SLOTS - 1);
+    blockSize = validBlockSize(newBlockSize);
+    for (int scene = 0; scene < 3; scene++) {
+        algoName[scene] = newAlgoName[scene];
+        horizontalMarks[scene] = newHorizontalMarks[scene];
+        forcedCarriers[scene] = newForcedCarriers[scene];
+    }
+
+    // Same order as the legacy keys: allowMultipleModes before modes
+    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+        auxInput[auxIndex]->clearAuxModes();
+    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++)
+        auxInput[auxIndex]->allowMultipleModes = newAllowMultipleModes[auxIndex];
+    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
+        for (int mode = 0; mode < AuxInputModes::NUM_MODES; mode++) {
+            if (newModeIsActive[auxIndex][mode])
+                auxInput[auxIndex]->setMode(mode);
+            else
+                unsetAuxMode(auxIndex, mode);
+        }
+    }
+    for (int auxIndex = 0; auxIndex < NUM_AUX_INPUTS; auxIndex++) {
+        auxInput[auxIndex]->connected = newConnected[auxIndex];
+        auxInput[auxIndex]->lastSetMode = newLastSetMode[auxIndex];
+    }
+    return true;
+}
+
 void AlgomorphLarge::dataFromJson(json_t* rootJ) {
+    // Prefer the compact state, falling back to the keys for patches from older versions
+    json_t* stateJ = json_object_get(rootJ, "State");
+    if (!json_is_string(stateJ) || !stateFromBase64(json_string_value(stateJ)))
+        legacyDataFromJson(rootJ);
+    // The loaded scenes are the patch's own, and the bank slot CV routes over them afresh
+    cvBankSlot = NULL;
+
+    // Update carriers, modulators, disabled status, and display algorithm
+    for (int scene = 0; scene < 3; scene++) {
+        updateCarriers(scene);
+        updateModulators(scene);
+        updateOpsDisabled(scene);
+        updateDisplayAlgo(scene);
+    }
+
+    graphDirty = true;
+}
+
+void AlgomorphLarge::legacyDataFromJson(json_t* rootJ) {
     auto configMode = json_object_get(rootJ, "Config Enabled");
     if (configMode)
         this->configMode = json_boolean_value(configMode);
     
     auto configOp = json_object_get(rootJ, "Config Mode");
     if (configOp)
-        this->configOp = json_integer_value(configOp);
+        this->configOp = rack::math::clamp((int) json_integer_value(configOp), -1, 3);
     
     auto configScene = json_object_get(rootJ, "Config Scene");
     if (configScene)
-        this->configScene = json_integer_value(configScene);
+        this->configScene = rack::math::clamp((int) json_integer_value(configScene), -1, 3);
     
     auto baseScene = json_object_get(rootJ, "Current Scene");
     if (baseScene)
-        this->baseScene = json_integer_value(baseScene);
+        this->baseScene = rack::math::clamp((int) json_integer_value(baseScene), 0, 2);
     
     auto modeB = json_object_get(rootJ, "Horizontal Allowed");
     if (modeB)
@@ -1613,7 +1797,7 @@ void AlgomorphLarge::dataFromJson(json_t* rootJ) {
     
     auto resetScene = json_object_get(rootJ, "Reset Scene");
     if (resetScene)
-        this->resetScene = json_integer_value(resetScene);
+        this->resetScene = rack::math::clamp((int) json_integer_value(resetScene), 0, 2);
     
     auto knobMode = json_object_get(rootJ, "Aux Knob Mode");
     if (knobMode)
@@ -1639,6 +1823,14 @@ void AlgomorphLarge::dataFromJson(json_t* rootJ) {
     if (wildModIsSummed)
         this->wildModIsSummed = json_boolean_value(wildModIsSummed);
 
+    auto followLeader = json_object_get(rootJ, "Follow Leader");
+    if (followLeader)
+        this->followLeader = json_boolean_value(followLeader);
+
+    auto quietFollower = json_object_get(rootJ, "Quiet Follower");
+    if (quietFollower)
+        this->quietFollower = json_boolean_value(quietFollower);
+
     auto resetOnRun = json_object_get(rootJ, "Reset on Run");
     if (resetOnRun)
         this->resetOnRun = json_boolean_value(resetOnRun);
@@ -1661,6 +1853,18 @@ void AlgomorphLarge::dataFromJson(json_t* rootJ) {
     if (vuLights)
         this->vuLights = json_boolean_value(vuLights);
 
+    auto displayFrameRate = json_object_get(rootJ, "Display Frame Rate");
+    if (displayFrameRate)
+        this->displayFrameRate = json_integer_value(displayFrameRate);
+
+    auto bankSlot = json_object_get(rootJ, "Scene Bank Slot");
+    if (bankSlot)
+        this->bankSlot = rack::math::clamp((int) json_integer_value(bankSlot), 0, BANK_SLOTS - 1);
+
+    auto blockSize = json_object_get(rootJ, "Block Size");
+    if (blockSize)
+        this->blockSize = validBlockSize(json_integer_value(blockSize));
+
     bool reset = true;
 
     //Set allowMultipleModes before loading modes
@@ -1734,34 +1938,6 @@ void AlgomorphLarge::dataFromJson(json_t* rootJ) {
             forcedCarriers[sceneIndex] = json_integer_value(json_object_get(sceneForcedCarriersJ, (std::string("Algorithm ") + std::to_string(sceneIndex)).c_str()));
         }
     }
-
-    // Update carriers, modulators, disabled status, and display algorithm
-    for (int scene = 0; scene < 3; scene++) {
-        updateCarriers(scene);
-        updateModulators(scene);
-        updateOpsDisabled(scene);
-        updateDisplayAlgo(scene);
-    }
-
-    graphDirty = true;
-}
-
-float AlgomorphLarge::getInputBrightness(int portID) {
-    if (vuLights)
-        return std::max(    {   inputs[portID].plugLights[0].getBrightness(),
-                                inputs[portID].plugLights[1].getBrightness() * 4,
-                                inputs[portID].plugLights[2].getBrightness()          }   );
-    else
-        return 1.f;
-}
-
-float AlgomorphLarge::getOutputBrightness(int portID) {
-    if (vuLights)
-        return std::max(    {   outputs[portID].plugLights[0].getBrightness(),
-                                outputs[portID].plugLights[1].getBrightness() * 4,
-                                outputs[portID].plugLights[2].getBrightness()          }   );
-    else
-        return 1.f;
 }
 
 
@@ -1985,6 +2161,7 @@ void AlgomorphLargeWidget::AuxInputModeMenuItem::createAuxInputModeMenu(Menu* me
     menu->addChild(construct<AuxModeItem>(&MenuItem::text, AuxInputModeLabels[AuxInputModes::DOUBLE_MORPH_ATTEN], &AuxModeItem::module, module, &AuxModeItem::auxIndex, auxIndex, &AuxModeItem::rightText, CHECKMARK(module->auxInput[auxIndex]->modeIsActive[AuxInputModes::DOUBLE_MORPH_ATTEN]), &AuxModeItem::mode, AuxInputModes::DOUBLE_MORPH_ATTEN));
     menu->addChild(construct<AuxModeItem>(&MenuItem::text, AuxInputModeLabels[AuxInputModes::TRIPLE_MORPH_ATTEN], &AuxModeItem::module, module, &AuxModeItem::auxIndex, auxIndex, &AuxModeItem::rightText, CHECKMARK(module->auxInput[auxIndex]->modeIsActive[AuxInputModes::TRIPLE_MORPH_ATTEN]), &AuxModeItem::mode, AuxInputModes::TRIPLE_MORPH_ATTEN));
     menu->addChild(construct<AuxModeItem>(&MenuItem::text, AuxInputModeLabels[AuxInputModes::SCENE_OFFSET], &AuxModeItem::module, module, &AuxModeItem::auxIndex, auxIndex, &AuxModeItem::rightText, CHECKMARK(module->auxInput[auxIndex]->modeIsActive[AuxInputModes::SCENE_OFFSET]), &AuxModeItem::mode, AuxInputModes::SCENE_OFFSET));
+    menu->addChild(construct<AuxModeItem>(&MenuItem::text, AuxInputModeLabels[AuxInputModes::BANK_SLOT], &AuxModeItem::module, module, &AuxModeItem::auxIndex, auxIndex, &AuxModeItem::rightText, CHECKMARK(module->auxInput[auxIndex]->modeIsActive[AuxInputModes::BANK_SLOT]), &AuxModeItem::mode, AuxInputModes::BANK_SLOT));
     menu->addChild(construct<AuxModeItem>(&MenuItem::text, AuxInputModeLabels[AuxInputModes::CLICK_FILTER], &AuxModeItem::module, module, &AuxModeItem::auxIndex, auxIndex, &AuxModeItem::rightText, CHECKMARK(module->auxInput[auxIndex]->modeIsActive[AuxInputModes::CLICK_FILTER]), &AuxModeItem::mode, AuxInputModes::CLICK_FILTER));
 }
 
@@ -2031,6 +2208,107 @@ void AlgomorphLargeWidget::WildModSumItem::onAction(const Action &e) {
     APP->history->push(h);
 }
 
+void AlgomorphLargeWidget::FollowLeaderItem::onAction(const Action &e) {
+    // History
+    ToggleFollowLeaderAction<>* h = new ToggleFollowLeaderAction<>();
+    h->moduleId = module->id;
+
+    module->followLeader ^= true;
+
+    APP->history->push(h);
+}
+
+void AlgomorphLargeWidget::QuietFollowerItem::onAction(const Action &e) {
+    // History
+    ToggleQuietFollowerAction<>* h = new ToggleQuietFollowerAction<>();
+    h->moduleId = module->id;
+
+    module->quietFollower ^= true;
+
+    APP->history->push(h);
+}
+
+void AlgomorphLargeWidget::LoadBankSlotItem::onAction(const Action &e) {
+    const BankSlot* slot = sceneBank.getSlot(module->bankSlot);
+    if (!slot)
+        return;
+
+    // History
+    LoadBankSlotAction<>* h = new LoadBankSlotAction<>();
+    h->moduleId = module->id;
+    h->capture(module);
+
+    module->loadBankSlot(slot);
+
+    h->commit(module);
+    APP->history->push(h);
+}
+
+// Not undoable: the bank is shared by every instance, outside the patch
+void AlgomorphLargeWidget::SaveBankSlotItem::onAction(const Action &e) {
+    BankSlot slot;
+    module->getBankSlot(&slot);
+    if (sceneBank.open(true))
+        sceneBank.writeSlot(module->bankSlot, slot);
+}
+
+AlgomorphLargeWidget::BankSlotSlider::BankSlotSlider(AlgomorphLarge* m) {
+    quantity = new BankSlotQuantity(m);
+    module = m;
+}
+
+AlgomorphLargeWidget::BankSlotSlider::~BankSlotSlider() {
+    delete quantity;
+}
+
+void AlgomorphLargeWidget::BankSlotSlider::onDragStart(const rack::event::DragStart& e) {
+    oldValue = module->bankSlot;
+}
+
+void AlgomorphLargeWidget::BankSlotSlider::onDragMove(const rack::event::DragMove& e) {
+    if (quantity)
+        quantity->moveScaledValue(0.002f * e.mouseDelta.x);
+}
+
+void AlgomorphLargeWidget::BankSlotSlider::onDragEnd(const rack::event::DragEnd& e) {
+    if (module->bankSlot != oldValue) {
+        // History
+        BankSlotAction<>* h = new BankSlotAction<>;
+        h->moduleId = module->id;
+        h->oldSlot = oldValue;
+        h->newSlot = module->bankSlot;
+
+        APP->history->push(h);
+    }
+}
+
+Menu* AlgomorphLargeWidget::SceneBankMenuItem::createChildMenu() {
+    Menu* menu = new Menu;
+    createSceneBankMenu(menu);
+    return menu;
+}
+
+void AlgomorphLargeWidget::SceneBankMenuItem::createSceneBankMenu(Menu* menu) {
+    //Shared by every instance, mapped by the first one to use it
+    sceneBank.open(false);
+    if (sceneBank.unusable) {
+        menu->addChild(construct<MenuLabel>(&MenuLabel::text, "Scene bank file unavailable"));
+        return;
+    }
+
+    BankSlotSlider* bankSlotSlider = new BankSlotSlider(module);
+    bankSlotSlider->box.size.x = 200.0;
+    menu->addChild(bankSlotSlider);
+
+    LoadBankSlotItem *loadBankSlotItem = rack::createMenuItem<LoadBankSlotItem>("Load scenes from slot");
+    loadBankSlotItem->module = module;
+    menu->addChild(loadBankSlotItem);
+
+    SaveBankSlotItem *saveBankSlotItem = rack::createMenuItem<SaveBankSlotItem>("Save scenes to slot");
+    saveBankSlotItem->module = module;
+    menu->addChild(saveBankSlotItem);
+}
+
 void AlgomorphLargeWidget::LargeAudioSettingsMenuItem::createLargeAudioSettingsMenu(Menu* menu) {   
     auto module = reinterpret_cast<AlgomorphLarge*>(this->module);
 
@@ -2043,6 +2321,27 @@ void AlgomorphLargeWidget::LargeAudioSettingsMenuItem::createLargeAudioSettingsM
     WildModSumItem *wildModSumItem = rack::createMenuItem<WildModSumItem>("Mod Sum excludes Wildcard", CHECKMARK(!module->wildModIsSummed));
     wildModSumItem->module = module;
     menu->addChild(wildModSumItem);
+
+    menu->addChild(construct<BlockSizeMenuItem>(&MenuItem::text, "Block processing", &MenuItem::rightText, (module->blockSize > 0 ? rack::string::f("%d samples ", module->blockSize) : std::string("Off ")) + RIGHT_ARROW, &BlockSizeMenuItem::module, module));
+}
+
+void AlgomorphLargeWidget::BlockSizeItem::onAction(const Action &e) {
+    module->blockSize = size;
+}
+
+// Each size shows the latency it adds to every output
+Menu* AlgomorphLargeWidget::BlockSizeMenuItem::createChildMenu() {
+    Menu* menu = new Menu;
+    for (int size : BLOCK_SIZES) {
+        std::string text = size > 0 ? rack::string::f("%d samples (%.2f ms latency)", size, size * 1000.f / APP->engine->getSampleRate()) : "Off";
+        BlockSizeItem *blockSizeItem = rack::createMenuItem<BlockSizeItem>(text, CHECKMARK(module->blockSize == size));
+        blockSizeItem->module = module;
+        blockSizeItem->size = size;
+        menu->addChild(blockSizeItem);
+    }
+    menu->addChild(new MenuSeparator());
+    menu->addChild(construct<MenuLabel>(&MenuLabel::text, "Shadow, Wildcard and expanders route per sample"));
+    return menu;
 }
 
 Menu* AlgomorphLargeWidget::LargeAudioSettingsMenuItem::createChildMenu() {
@@ -2215,6 +2514,8 @@ void AlgomorphLargeWidget::VisualSettingsMenuItem::createVisualSettingsMenu(Menu
     VULightsItem *vuLightsItem = rack::createMenuItem<VULightsItem>("VU lighting", CHECKMARK(module->vuLights));
     vuLightsItem->module = module;
     menu->addChild(vuLightsItem);
+
+    menu->addChild(construct<DisplayFrameRateMenuItem>(&MenuItem::text, "Display frame rate", &MenuItem::rightText, (module->displayFrameRate > 0 ? rack::string::f("%d fps ", module->displayFrameRate) : std::string("Unlimited ")) + RIGHT_ARROW, &DisplayFrameRateMenuItem::module, module));
     
     // GlowingInkItem *glowingInkItem = rack::createMenuItem<GlowingInkItem>("Enable glowing panel ink", CHECKMARK(module->glowingInk));
     // glowingInkItem->module = module;
@@ -2407,6 +2708,20 @@ void AlgomorphLargeWidget::appendContextMenu(Menu* menu) {
     toggleModeBItem->module = module;
     menu->addChild(toggleModeBItem);
     
+    menu->addChild(new MenuSeparator());
+    menu->addChild(construct<MenuLabel>(&MenuLabel::text, "Link"));
+
+    FollowLeaderItem *followLeaderItem = rack::createMenuItem<FollowLeaderItem>("Follow Algomorph Advance on the left", CHECKMARK(module->followLeader));
+    followLeaderItem->module = module;
+    menu->addChild(followLeaderItem);
+
+    QuietFollowerItem *quietFollowerItem = rack::createMenuItem<QuietFollowerItem>("Display and lights off while following", CHECKMARK(module->quietFollower));
+    quietFollowerItem->module = module;
+    menu->addChild(quietFollowerItem);
+
+    menu->addChild(new MenuSeparator());
+    menu->addChild(construct<SceneBankMenuItem>(&MenuItem::text, "Scene bank…", &MenuItem::rightText, rack::string::f("Slot %d ", module->bankSlot + 1) + RIGHT_ARROW, &SceneBankMenuItem::module, module));
+    
     menu->addChild(new MenuSeparator());
     
     SaveAuxInputSettingsItem *saveAuxInputSettingsItem = rack::createMenuItem<SaveAuxInputSettingsItem>("Save AUX input modes as default", CHECKMARK(module->auxInputsAreDefault()));
@@ -2418,11 +2733,15 @@ void AlgomorphLargeWidget::appendContextMenu(Menu* menu) {
     saveVisualSettingsItem->module = module;
     menu->addChild(saveVisualSettingsItem);
 
-    // menu->addChild(new MenuSeparator());
+    menu->addChild(new MenuSeparator());
 
-    // DebugItem *debugItem = rack::createMenuItem<DebugItem>("The system is down", CHECKMARK(module->debug));
-    // debugItem->module = module;
-    // menu->addChild(debugItem);
+    DebugItem *debugItem = rack::createMenuItem<DebugItem>("Profile CPU usage", CHECKMARK(module->debug));
+    debugItem->module = module;
+    menu->addChild(debugItem);
+    if (module->debug)
+        menu->addChild(construct<DebugStatsMenuItem>(&MenuItem::text, "Statistics…", &MenuItem::rightText, RIGHT_ARROW, &DebugStatsMenuItem::module, module));
+    TelemetryRecorder* telemetry = module->telemetry.load(std::memory_order_relaxed);
+    menu->addChild(construct<TelemetryMenuItem>(&MenuItem::text, "Telemetry…", &MenuItem::rightText, (telemetry && telemetry->recording ? "Recording " : "") + std::string(RIGHT_ARROW), &TelemetryMenuItem::module, module));
 }
 
 void AlgomorphLargeWidget::setKnobMode(int mode) {
@@ -2441,6 +2760,9 @@ void AlgomorphLargeWidget::setKnobMode(int mode) {
 void AlgomorphLargeWidget::step() {
     if (module) {
         AlgomorphLarge* m = dynamic_cast<AlgomorphLarge*>(module);
+        pushHistoryRequests(m);
+        if (m->auxModeFlags[AuxInputModes::BANK_SLOT])
+            sceneBank.requestOpen();
         // ink->visible = m->glowingInk == 1;
         if (activeKnob != m->knobMode)
             setKnobMode(m->knobMode);
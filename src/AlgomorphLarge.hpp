@@ -1,6 +1,10 @@
 #pragma once
 #include "Algomorph.hpp"
+#include "AlgomorphAux.hpp"
+#include "AlgomorphLink.hpp"
+#include "AlgomorphWide.hpp"
 #include "AuxSources.hpp"
+#include "SceneBank.hpp"
 #include <rack.hpp>
 using rack::history::ModuleAction;
 using rack::event::Action;
@@ -8,8 +12,48 @@ using rack::ui::Menu;
 using rack::window::mm2px;
 
 
+struct LeftExpanderMessage {           // Written by whichever module is on the left
+    LinkMessage link;                   // A leader
+    AuxLaneMessage aux;                 // An Algomorph AUX
+};
+
+// Block processing keeps one block of operator inputs and, in the same slots, the outputs routed from the block before,
+// which go out as the next inputs come in. Channel-major, so routing runs down contiguous samples. AUX voltages and
+// divider ticks are kept per frame too, and the block's control pass leaves each frame's gain targets and output scales
+// for routing.
+template < int AUX_INPUTS >
+struct BlockBuffer {
+    int channels[MAX_BLOCK_SIZE];                   // Output channels of each slot
+    float in[4][CHANNELS][MAX_BLOCK_SIZE];
+    float aux[AUX_INPUTS][MAX_BLOCK_SIZE][CHANNELS];        // Frame-major, as AuxInput::updateVoltage() takes a frame
+    bool processCV[MAX_BLOCK_SIZE];
+    bool rearmClickFilters[MAX_BLOCK_SIZE];
+    float modOut[4][CHANNELS][MAX_BLOCK_SIZE];
+    float carSumOut[CHANNELS][MAX_BLOCK_SIZE];
+    float modSumOut[CHANNELS][MAX_BLOCK_SIZE];
+    float phaseOut[CHANNELS][MAX_BLOCK_SIZE];
+
+    float modTargets[4][4][CHANNELS][MAX_BLOCK_SIZE];       // [op][mod]
+    float sumTargets[4][CHANNELS][MAX_BLOCK_SIZE];          // [op]
+    bool modHeld[4][4][CHANNELS];                           // Whether a target stayed put over the block
+    bool sumHeld[4][CHANNELS];
+    float modScale[CHANNELS][MAX_BLOCK_SIZE];               // Operator, modulator and run gains
+    float modSumScale[CHANNELS][MAX_BLOCK_SIZE];            // Operator, sum and run gains, with average mode's factor
+    float carSumScale[CHANNELS][MAX_BLOCK_SIZE];            // Same, still to be divided by the carrier total in average mode
+
+    void clearOutputs() {
+        std::fill(channels, channels + MAX_BLOCK_SIZE, 1);
+        std::fill(&modOut[0][0][0], &modOut[0][0][0] + 4 * CHANNELS * MAX_BLOCK_SIZE, 0.f);
+        std::fill(&carSumOut[0][0], &carSumOut[0][0] + CHANNELS * MAX_BLOCK_SIZE, 0.f);
+        std::fill(&modSumOut[0][0], &modSumOut[0][0] + CHANNELS * MAX_BLOCK_SIZE, 0.f);
+        std::fill(&phaseOut[0][0], &phaseOut[0][0] + CHANNELS * MAX_BLOCK_SIZE, 0.f);
+    };
+};
+
 struct AlgomorphLarge : Algomorph<> {
     static constexpr int NUM_AUX_INPUTS = 5;
+    static constexpr int NUM_AUX_SOURCES = NUM_AUX_INPUTS + NUM_AUX_LANES;     // Jacks, then Algomorph AUX lanes
+    static constexpr uint8_t STATE_VERSION = 4;     // 2: link settings, 3: scene bank slot and mode, 4: block size
 
     enum ParamIds {
         ENUMS(OPERATOR_BUTTONS, 4),
@@ -55,7 +99,9 @@ struct AlgomorphLarge : Algomorph<> {
         NUM_LIGHTS
     };
 
-    AuxInput* auxInput[NUM_AUX_INPUTS];
+    AuxInput* auxInput[NUM_AUX_SOURCES];
+    int auxSources = NUM_AUX_INPUTS;                            // AuxInputs being processed, lanes only while an Algomorph AUX is linked
+    float delayedAuxVoltage[NUM_AUX_INPUTS][16] = {{0.f}};      // AUX jacks one sample late, to line up with the lanes
     float scaledAuxVoltage[AuxInputModes::NUM_MODES][16] = {{0.f}};    // store processed (ready-to-use) values from auxInput[]->voltage[][], so they can be remembered if necessary
     bool auxModeFlags[AuxInputModes::NUM_MODES] = {false};             // a mode's flag is set to true when any aux input has that mode active
     int knobMode = AuxKnobModes::MORPH_ATTEN;
@@ -76,23 +122,46 @@ struct AlgomorphLarge : Algomorph<> {
     int resetScene = 1;
     bool ccwSceneSelection = true;      // Default true to interface with rising ramp LFO at Morph CV input
     bool wildModIsSummed = false;
+    bool followLeader = false;          // Follow the Algomorph Advance on the left
+    bool quietFollower = false;         // Turn display and lights off while following
+    int bankSlot = 0;                   // Scene bank slot picked in the menu, and the base for the bank slot CV
+    const BankSlot* cvBankSlot = NULL;  // Slot the bank slot CV routes, NULL while the patch's own scenes do
+    BankSlot patchScenes = {};          // The patch's own scenes, put aside while cvBankSlot is routed
+    int blockSize = 0;                  // Block processing, one of BLOCK_SIZES. Outputs are this many samples late
+
+    BlockBuffer<NUM_AUX_INPUTS> block = {};
+    int activeBlockSize = 0;            // blockSize, taken over between blocks
+    int blockPos = 0;
+    bool blockRouting = false;          // This block is routed in one go, rather than per sample
+    int blockChannels = 1;
+    int blockSceneOffset = 0;           // Channel 1's, for the lights
     
     bool auxPanelDirty = true;
 
+    WideInputMessage wideInputMessages[2] = {};     // Written by an Algomorph Wide on the right
+    LeftExpanderMessage leftMessages[2] = {};       // Written by a leader or an Algomorph AUX on the left
+
     AlgomorphLarge();
     void onReset() override;
     void unsetAuxMode(int auxIndex, int mode);
     void process(const ProcessArgs& args) override;
-    float routeHorizontal(float sampleTime, float inputVoltage, int op, int c);
-    float routeHorizontalRing(float sampleTime, float inputVoltage, int op, int c);
-    float routeDiagonal(float sampleTime, float inputVoltage, int op, int mod, int c);
-    float routeDiagonalB(float sampleTime, float inputVoltage, int op, int mod, int c);
-    float routeDiagonalRing(float sampleTime, float inputVoltage, int op, int mod, int c);
-    float routeDiagonalRingB(float sampleTime, float inputVoltage, int op, int mod, int c);
-    float routeSum(float sampleTime, float inputVoltage, int op, int c);
-    float routeSumB(float sampleTime, float inputVoltage, int op, int c);
-    float routeSumRing(float sampleTime, float inputVoltage, int op, int c);
-    float routeSumRingB(float sampleTime, float inputVoltage, int op, int c);
+    void readAuxInputs(bool delayed, int blockFrame = -1);
+    void processControl(bool processCV, bool rearmClickFilters, const LinkMessage* link, int* sceneOffset, float* phaseOut, int64_t& debugSectionStart);
+    void updatePanel(const ProcessArgs& args, int sceneOffset);
+    bool canRouteBlock();
+    void processBlockFrame(const ProcessArgs& args);
+    void keepBlockControl(int frame, float sampleTime, const float* phaseOut);
+    void routeBlock(float sampleTime);
+    void delayOutputs();
+    void updateMorph(int* sceneOffset, float* phaseOut);
+    void getLinkScenes(LinkScenes* scenes);
+    void publishLink(LinkMessage* out, int sceneOffset);
+    void followLink(const LinkMessage* link, int* sceneOffset, float* phaseOut);
+    void updateAuxLanes(const AuxLaneMessage* lanes);
+    void getBankSlot(BankSlot* slot);
+    void getPatchScenes(BankSlot* scenes);
+    void loadBankSlot(const BankSlot* slot);
+    void processWide(const WideInputMessage* in, WideOutputMessage* out, const float* modScale, const float* carSumScale, const float* modSumScale, const float* wildcardMod, const float* wildcardSum, float wildcardModGain);
     void scaleAuxSumAttenCV(int channels);
     void scaleAuxModAttenCV(int channels);
     void scaleAuxClickFilterCV(int channels);
@@ -106,10 +175,10 @@ struct AlgomorphLarge : Algomorph<> {
     void initRun();
     void rescaleVoltage(int mode, int channels);
     void rescaleVoltages(int channels);
-    void updateSceneBrightnesses();
-    float getInputBrightness(int portID);
-    float getOutputBrightness(int portID);
     bool auxInputsAreDefault();
+    std::string stateToBase64(const BankSlot& scenes);
+    bool stateFromBase64(const std::string& state);
+    void legacyDataFromJson(json_t* rootJ);
     json_t* dataToJson() override;
     void dataFromJson(json_t* rootJ) override;
 };
@@ -184,6 +253,25 @@ struct AlgomorphLargeWidget : AlgomorphWidget<> {
     struct WildModSumItem : AlgomorphLargeMenuItem {
         void onAction(const Action &e) override;
     };
+    struct BlockSizeItem : AlgomorphLargeMenuItem {
+        int size;
+        void onAction(const Action &e) override;
+    };
+    struct BlockSizeMenuItem : AlgomorphLargeMenuItem {
+        Menu* createChildMenu() override;
+    };
+    struct FollowLeaderItem : AlgomorphLargeMenuItem {
+        void onAction(const Action &e) override;
+    };
+    struct QuietFollowerItem : AlgomorphLargeMenuItem {
+        void onAction(const Action &e) override;
+    };
+    struct LoadBankSlotItem : AlgomorphLargeMenuItem {
+        void onAction(const Action &e) override;
+    };
+    struct SaveBankSlotItem : AlgomorphLargeMenuItem {
+        void onAction(const Action &e) override;
+    };
     struct AllowMultipleModesItem : AlgomorphLargeMenuItem {
         void onAction(const Action &e) override;
     };
@@ -241,6 +329,53 @@ struct AlgomorphLargeWidget : AlgomorphWidget<> {
     struct KnobModeMenuItem : AlgomorphLargeMenuItem {
         Menu* createChildMenu() override;
     };
+    struct SceneBankMenuItem : AlgomorphLargeMenuItem {
+        Menu* createChildMenu() override;
+        void createSceneBankMenu(Menu* menu);
+    };
+
+    struct BankSlotSlider : rack::ui::Slider {
+        int oldValue = 0;
+        AlgomorphLarge* module;
+
+        struct BankSlotQuantity : rack::Quantity {
+            AlgomorphLarge* module;
+
+            BankSlotQuantity(AlgomorphLarge* m) {
+                module = m;
+            };
+            void setValue(float value) override {
+                module->bankSlot = (int) rack::math::clamp(std::round(value), 0.f, BANK_SLOTS - 1.f);
+            };
+            float getValue() override {
+                return module->bankSlot;
+            };
+            float getMinValue() override {
+                return 0.f;
+            };
+            float getMaxValue() override {
+                return BANK_SLOTS - 1.f;
+            };
+            float getDisplayValue() override {
+                return getValue() + 1.f;
+            };
+            std::string getDisplayValueString() override {
+                return rack::string::f("%i", (int) getDisplayValue()) + (sceneBank.getSlot(module->bankSlot) ? "" : " (empty)");
+            };
+            void setDisplayValue(float displayValue) override {
+                setValue(displayValue - 1.f);
+            };
+            std::string getLabel() override {
+                return "Slot";
+            };
+        };
+
+        BankSlotSlider(AlgomorphLarge* m);
+        ~BankSlotSlider();
+        void onDragStart(const rack::event::DragStart& e) override;
+        void onDragMove(const rack::event::DragMove& e) override;
+        void onDragEnd(const rack::event::DragEnd& e) override;
+    };
 
     AlgomorphLargeWidget(AlgomorphLarge* module);
     void appendContextMenu(Menu* menu) override;
@@ -316,6 +451,78 @@ struct ToggleWildModSumAction : ModuleAction {
 	};
 };
 
+template < int OPS = 4, int SCENES = 3 >
+struct ToggleFollowLeaderAction : ModuleAction {
+	ToggleFollowLeaderAction() {
+		name = "Delexander Algomorph toggle follow leader";
+	};
+	void undo() override {
+		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
+		assert(mw);
+		AlgomorphLarge* m = dynamic_cast<AlgomorphLarge*>(mw->module);
+		assert(m);
+		m->followLeader ^= true;
+	};
+	void redo() override {
+		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
+		assert(mw);
+		AlgomorphLarge* m = dynamic_cast<AlgomorphLarge*>(mw->module);
+		assert(m);
+		m->followLeader ^= true;
+	};
+};
+
+template < int OPS = 4, int SCENES = 3 >
+struct ToggleQuietFollowerAction : ModuleAction {
+	ToggleQuietFollowerAction() {
+		name = "Delexander Algomorph toggle quiet follower";
+	};
+	void undo() override {
+		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
+		assert(mw);
+		AlgomorphLarge* m = dynamic_cast<AlgomorphLarge*>(mw->module);
+		assert(m);
+		m->quietFollower ^= true;
+	};
+	void redo() override {
+		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
+		assert(mw);
+		AlgomorphLarge* m = dynamic_cast<AlgomorphLarge*>(mw->module);
+		assert(m);
+		m->quietFollower ^= true;
+	};
+};
+
+template < int OPS = 4, int SCENES = 3 >
+struct BankSlotAction : ModuleAction {
+	int oldSlot, newSlot;
+
+	BankSlotAction() {
+		name = "Delexander Algomorph scene bank slot";
+	};
+	void undo() override {
+		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
+		assert(mw);
+		AlgomorphLarge* m = dynamic_cast<AlgomorphLarge*>(mw->module);
+		assert(m);
+		m->bankSlot = oldSlot;
+	};
+	void redo() override {
+		rack::app::ModuleWidget* mw = APP->scene->rack->getModule(moduleId);
+		assert(mw);
+		AlgomorphLarge* m = dynamic_cast<AlgomorphLarge*>(mw->module);
+		assert(m);
+		m->bankSlot = newSlot;
+	};
+};
+
+template < int OPS = 4, int SCENES = 3 >
+struct LoadBankSlotAction : SceneDeltaAction<OPS, SCENES> {
+	LoadBankSlotAction() {
+		this->name = "Delexander Algomorph load scene bank slot";
+	};
+};
+
 template < int OPS = 4, int SCENES = 3 >
 struct ToggleResetOnRunAction : ModuleAction {
 	ToggleResetOnRunAction() {
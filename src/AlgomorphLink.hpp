@@ -0,0 +1,36 @@
+#pragma once
+#include "plugin.hpp" // For constants
+#include <cstdint>
+
+
+// Algomorph Link Structure
+// Algomorph Advance modules placed side by side can share one routing engine. A module set to follow takes the scene
+// state and per-channel morph of the module on its left, the leader, instead of running its own scene buttons, morph
+// knob and morph CV. It still routes its own voices, with its own click filters and gains.
+// The leader writes into a buffer the follower owns and Rack flips the pair between samples, so a follower reads the
+// message in place, one sample behind. A follower passes the message on to its right, so a chain follows one leader.
+// Scene state only changes on edits: a follower compares it with its own and takes it over when it differs.
+
+struct LinkScenes {                                 // Packed without padding, compared with memcmp
+    int modulators[3];
+    uint16_t algoName[3];
+    uint8_t horizontalMarks[3];
+    uint8_t forcedCarriers[3];
+    uint8_t carriers[3];
+    uint8_t opsDisabled[3];
+    bool modeB;
+    bool ringMorph;
+};
+
+struct alignas(16) LinkMessage {                    // Leader to follower, held by the follower's leftExpander
+    bool valid;                                     // Set by the first write, so a fresh buffer is never followed
+    LinkScenes scenes;
+    int baseScene;
+    int sceneOffset;                                // Channel 1's, for the scene indicators
+    int channels;
+    float morph[CHANNELS];
+    float relativeMorphMagnitude[CHANNELS];
+    int centerMorphScene[CHANNELS];
+    int forwardMorphScene[CHANNELS];
+    int backwardMorphScene[CHANNELS];
+};
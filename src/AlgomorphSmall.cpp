@@ -2,6 +2,7 @@
 #include "Components.hpp"
 #include "AlgomorphDisplayWidget.hpp"
 #include "ConnectionBgWidget.hpp"
+#include "PatchState.hpp"
 #include "plugin.hpp" // For constants
 #include <rack.hpp>
 using rack::math::crossfade;
@@ -11,6 +12,9 @@ using rack::ui::MenuSeparator;
 using rack::ui::MenuLabel;
 
 
+// The light engine writes lights by slot, so the shared part of LightIds must keep its order
+static_assert(AlgomorphSmall::OPERATOR_LIGHTS == LightSlots::OPERATOR_LIGHTS && AlgomorphSmall::EDIT_LIGHT == LightSlots::EDIT_LIGHT, "LightIds out of sync with LightSlots");
+
 AlgomorphSmall::AlgomorphSmall() {
     config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
     configParam(MORPH_KNOB, -1.f, 1.f, 0.f, "Morph", " millimorphs", 0, 1000);
@@ -54,6 +58,11 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
     float modOut[4][16] = {{0.f}};                          // Modulator outputs & channels
     float sumOut[16] = {0.f};                               // Sum output channels
     bool processCV = cvDivider.process();
+    int64_t debugFrameStart = 0, debugSectionStart = 0;
+    if (debug)
+        debugFrameStart = debugSectionStart = debugStats.startFrame();
+
+    processSceneRequests();
 
     //Determine polyphony count
     this->channels = 1;
@@ -86,14 +95,9 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
                     if (baseScene != i) {
                         //Switch scene
                         // History
-                        AlgorithmSceneChangeAction<>* h = new AlgorithmSceneChangeAction<>;
-                        h->moduleId = this->id;
-                        h->oldScene = baseScene;
-                        h->newScene = i;
-                        
-                        baseScene = i;
+                        requestSceneChangeHistory(baseScene, i);
 
-                        APP->history->push(h);
+                        baseScene = i;
 
                     }
                 }
@@ -102,6 +106,9 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
         }
     }
 
+    if (debug)
+        debugSectionStart = debugStats.add(DebugSections::CV, debugSectionStart);
+
     //  Update morph status
     float morphFromKnob = params[MORPH_KNOB].getValue();
     float morphAttenuversion = params[MORPH_ATTEN_KNOB].getValue();
@@ -111,14 +118,17 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
                         + inputs[MORPH_INPUTS + 1].getVoltage() * morphMult[1])
                         / 5.f)
                         * morphAttenuversion;
-    while (newMorph0 > 3.f)
+    while (newMorph0 > 3.f) {
         newMorph0 = -3.f + (newMorph0 - 3.f);
-    while (newMorph0 < -3.f)
+        if (debug)
+            debugStats.morphWraps++;
+    }
+    while (newMorph0 < -3.f) {
         newMorph0 = 3.f + (newMorph0 + 3.f);
-    if (morph[0] != newMorph0) {
-        morph[0] = newMorph0;
-        graphDirty = true;
+        if (debug)
+            debugStats.morphWraps++;
     }
+    morph[0] = newMorph0;
     // morph[0] was just processed, so start this loop with [1]
     for (int c = 1; c < this->channels; c++) {
         morph[c] =  + morphFromKnob
@@ -257,6 +267,9 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
         }
     }
 
+    if (debug)
+        debugSectionStart = debugStats.add(DebugSections::AUX, debugSectionStart);
+
     if (processCV) {
         //Edit button
         if (editTrigger.process(params[EDIT_BUTTON].getValue() > 0.f)) {
@@ -310,15 +323,10 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
             if (configOp > -1) {
                 if (modulatorTrigger[configOp].process(params[MODULATOR_BUTTONS + configOp].getValue() > 0.f)) {  //Op is connected to itself
                     // History
-                    AlgorithmHorizontalChangeAction<>* h = new AlgorithmHorizontalChangeAction<>;
-                    h->moduleId = this->id;
-                    h->scene = configScene;
-                    h->op = configOp;
+                    requestHistory(HistoryRequest::HORIZONTAL, configScene, configOp);
 
                     toggleHorizontalDestination(configScene, configOp);
 
-                    APP->history->push(h);
-
                     if (exitConfigOnConnect) {
                         configMode = false;
                         configOp = -1;
@@ -330,15 +338,9 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
                     for (int mod = 0; mod < 3; mod++) {
                         if (modulatorTrigger[relToAbs[configOp][mod]].process(params[MODULATOR_BUTTONS + relToAbs[configOp][mod]].getValue() > 0.f)) {
                             // History
-                            AlgorithmDiagonalChangeAction<>* h = new AlgorithmDiagonalChangeAction<>;
-                            h->moduleId = this->id;
-                            h->scene = configScene;
-                            h->op = configOp;
-                            h->mod = mod;
+                            requestHistory(HistoryRequest::DIAGONAL, configScene, configOp, mod);
 
                             toggleDiagonalDestination(configScene, configOp, mod);
-                            
-                            APP->history->push(h);
 
                             if (exitConfigOnConnect) {
                                 configMode = false;
@@ -355,14 +357,9 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
                 for (int i = 0; i < 4; i++) {
                     if (modulatorTrigger[i].process(params[MODULATOR_BUTTONS + i].getValue() > 0.f)) {
                         // History
-                        AlgorithmForcedCarrierChangeAction<>* h = new AlgorithmForcedCarrierChangeAction<>;
-                        h->moduleId = this->id;
-                        h->scene = configScene;
-                        h->op = i;
+                        requestHistory(HistoryRequest::FORCED_CARRIER, configScene, i);
 
                         toggleForcedCarrier(configScene, i);
-
-                        APP->history->push(h);
                         
                         graphDirty = true;
                         break;
@@ -384,14 +381,9 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
                     configMode = true;
                     
                     // History
-                    AlgorithmForcedCarrierChangeAction<>* h = new AlgorithmForcedCarrierChangeAction<>;
-                    h->moduleId = this->id;
-                    h->scene = configScene;
-                    h->op = i;
+                    requestHistory(HistoryRequest::FORCED_CARRIER, configScene, i);
 
                     toggleForcedCarrier(configScene, i);
-
-                    APP->history->push(h);
                     
                     graphDirty = true;
                     break;
@@ -399,65 +391,43 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
             }
         }
     }
+
+    if (debug)
+        debugSectionStart = debugStats.add(DebugSections::CV, debugSectionStart);
     
     // Update display
-    displayMorph.push(relativeMorphMagnitude[0]);
-    if (configMode) {
-        displayScene.push(configScene);
-    }
-    else {
-        displayScene.push(centerMorphScene[0]);
-        displayMorphScene.push(forwardMorphScene[0]);
+    if (visible) {
+        displayMorph.push(relativeMorphMagnitude[0]);
+        if (configMode) {
+            displayScene.push(configScene);
+        }
+        else {
+            displayScene.push(centerMorphScene[0]);
+            displayMorphScene.push(forwardMorphScene[0]);
+        }
     }
     
     //Get operator input channel then route to modulation output channel or to sum output channel
     float wildcardMod[16] = {0.f};
+    updateMorphWeights(this->channels);
+    if (avgMode)
+        updateSumNorms(this->channels);
     for (int c = 0; c < this->channels; c++) {
-        if (ringMorph) {
-            for (int i = 0; i < 4; i++) {
-                if (inputs[OPERATOR_INPUTS + i].isConnected()) {
-                    in[c] = inputs[OPERATOR_INPUTS + i].getPolyVoltage(c);
-                    //Check current algorithm and morph target
-                    if (modeB) {
-                        modOut[i][c] += routeHorizontal(args.sampleTime, in[c], i, c);
-                        modOut[i][c] += routeHorizontalRing(args.sampleTime, in[c], i, c);
-                        for (int j = 0; j < 3; j++) {
-                            modOut[i][c] += routeDiagonalB(args.sampleTime, in[c], i, j, c);
-                            modOut[i][c] += routeDiagonalRingB(args.sampleTime, in[c], i, j, c);
-                        }
-                        sumOut[c] += routeSumRingB(args.sampleTime, in[c], i, c);
-                        sumOut[c] += routeSumB(args.sampleTime, in[c], i, c);
-                    }
-                    else {
-                        for (int j = 0; j < 3; j++) {
-                            modOut[relToAbs[i][j]][c] += routeDiagonal(args.sampleTime, in[c], i, j, c);
-                            modOut[relToAbs[i][j]][c] += routeDiagonalRing(args.sampleTime, in[c], i, j, c);
-                        }
-                        sumOut[c] += routeSumRing(args.sampleTime, in[c], i, c);
-                        sumOut[c] += routeSum(args.sampleTime, in[c], i, c);
-                    }
-                }
-            }
-        }
-        else {
-            for (int i = 0; i < 4; i++) {
-                if (inputs[OPERATOR_INPUTS + i].isConnected()) {
-                    in[c] = inputs[OPERATOR_INPUTS + i].getPolyVoltage(c);
-                    //Check current algorithm and morph target
-                    if (modeB) {
-                        modOut[i][c] += routeHorizontal(args.sampleTime, in[c], i, c);
-                        for (int j = 0; j < 3; j++) {
-                            modOut[relToAbs[i][j]][c] += routeDiagonalB(args.sampleTime, in[c], i, j, c);
-                        }
-                        sumOut[c] += routeSumB(args.sampleTime, in[c], i, c);
-                    }
-                    else {
-                        for (int j = 0; j < 3; j++) {
-                            modOut[relToAbs[i][j]][c] += routeDiagonal(args.sampleTime, in[c], i, j, c);
-                        }
-                        sumOut[c] += routeSum(args.sampleTime, in[c], i, c);
-                    }
+        for (int i = 0; i < 4; i++) {
+            if (inputs[OPERATOR_INPUTS + i].isConnected()) {
+                in[c] = inputs[OPERATOR_INPUTS + i].getPolyVoltage(c);
+                //Check current algorithm and morph target
+                if (modeB)
+                    modOut[i][c] += in[c] * stepModGain(args.sampleTime, i, i, horizontalTarget(i, c), horizontalRingTarget(i, c), c);
+                for (int j = 0; j < 3; j++) {
+                    int dest = relToAbs[i][j];
+                    float connection = stepModGain(args.sampleTime, i, dest, diagonalTarget(i, j, c), diagonalRingTarget(i, j, c), c);
+                    // Ring morph in mode B routes the diagonals back to the operator's own output
+                    if (ringMorph && modeB)
+                        dest = i;
+                    modOut[dest][c] += in[c] * connection;
                 }
+                sumOut[c] += in[c] * stepSumGain(args.sampleTime, i, sumTarget(i, c), sumRingTarget(i, c), c);
             }
         }
         wildcardMod[c] += inputs[WILDCARD_INPUT].getPolyVoltage(c);
@@ -465,6 +435,9 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
             modOut[mod][c] += wildcardMod[c];
             modOut[mod][c] *= gain;
         }
+        // The carrier total depends on the click filters, so it is the one division left per channel
+        if (avgMode)
+            sumOut[c] *= totalCarSumConnection[c] == 0 ? 0.f : carSumNorm[c] / totalCarSumConnection[c];
     }
 
     //Set outputs
@@ -476,211 +449,30 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
     }
     if (outputs[CARRIER_SUM_OUTPUT].isConnected()) {
         outputs[CARRIER_SUM_OUTPUT].setChannels(this->channels);
-        if (avgMode) {
-            for (int c = 0; c < this->channels; c++) {
-                if (totalCarSumConnection[c] == 0) {
-                    outputs[CARRIER_SUM_OUTPUT].setVoltage(0.f, c);
-                }
-                else {
-                    if (carriers[centerMorphScene[c]].count() > 0 && carriers[forwardMorphScene[c]].count() > 0)
-                        outputs[CARRIER_SUM_OUTPUT].setVoltage(sumOut[c] / totalCarSumConnection[c], c);
-                    else {
-                        if (carriers[centerMorphScene[c]].count() == 0)
-                            outputs[CARRIER_SUM_OUTPUT].setVoltage(sumOut[c] * (1.f / totalCarSumConnection[c]) * relativeMorphMagnitude[c], c);
-                        else
-                            outputs[CARRIER_SUM_OUTPUT].setVoltage(sumOut[c] * (1.f / totalCarSumConnection[c]) * (1.f - relativeMorphMagnitude[c]), c);
-                    }
-                }
-            }
+        outputs[CARRIER_SUM_OUTPUT].writeVoltages(sumOut);
+    }
+
+    //Meter ports for the VU lights
+    if (vuLights && visible) {
+        for (int i = 0; i < 4; i++) {
+            accumulateVu(inputs[OPERATOR_INPUTS + i], LightVuSources::OPERATOR_INPUTS + i);
+            accumulateVu(outputs[MODULATOR_OUTPUTS + i], LightVuSources::MODULATOR_OUTPUTS + i);
         }
-        else
-            outputs[CARRIER_SUM_OUTPUT].writeVoltages(sumOut);
+        accumulateVu(outputs[CARRIER_SUM_OUTPUT], LightVuSources::CARRIER_SUM_OUTPUT);
+        vuMeter.endFrame();
     }
 
+    if (debug)
+        debugSectionStart = debugStats.add(DebugSections::ROUTING, debugSectionStart);
+
     //Set lights
     if (lightDivider.process()) {
-        rotor.step(args.sampleTime * lightDivider.getDivision());
-        if (configMode) {   //Display state without morph, highlight configScene
-            //Set purple component to off
-            lights[DISPLAY_BACKLIGHT].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-            //Set yellow component
-            lights[DISPLAY_BACKLIGHT + 1].setSmoothBrightness(getOutputBrightness(CARRIER_SUM_OUTPUT) / 2048.f + .005f / 3.f, args.sampleTime * lightDivider.getDivision());
-            //Set edit light
-            lights[EDIT_LIGHT].setSmoothBrightness(1.f, args.sampleTime * lightDivider.getDivision());
-            //Set scene lights
-            for (int i = 0; i < 3; i++) {
-                //Set purple components to off
-                lights[SCENE_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                lights[SCENE_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                //Set yellow components depending on config scene and blink status
-                lights[SCENE_LIGHTS + i * 3 + 1].setSmoothBrightness(configScene == i ? 1.f : 0.f, args.sampleTime * lightDivider.getDivision());
-                lights[SCENE_INDICATORS + i * 3 + 1].setSmoothBrightness(configScene == i ?
-                    INDICATOR_BRIGHTNESS
-                    : 0.f, args.sampleTime * lightDivider.getDivision());
-            }
-            //Set op/mod lights
-            for (int i = 0; i < 4; i++) {
-                if (horizontalMarks[configScene].test(i)) {
-                    if (modeB) {
-                        //Set carrier indicator
-                        // In (config + alter ego) mode, when a selected operator is a forced-carrier,
-                        // the purple indicator should blink on/off whenever the yellow selection indicator blinks off/on,
-                        // regardless of whether it is horizontally marked.
-                        if (forcedCarriers[configScene].test(i)) {
-                            //Purple light
-                            lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(configOp == i ?
-                                blinkStatus ?
-                                    0.f
-                                    : INDICATOR_BRIGHTNESS
-                                : INDICATOR_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                            //Yellow light
-                            lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(configOp == i ?
-                                blinkStatus
-                                : 0.f, args.sampleTime * lightDivider.getDivision());
-                            //Red light
-                            lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        }
-                        else {
-                            //Purple light
-                            lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                            //Yellow light
-                            lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                            //Red light
-                            lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        }
-                        //Set op lights
-                        //Purple lights
-                        lights[OPERATOR_LIGHTS + i * 3].setSmoothBrightness(configOp == i ?
-                            blinkStatus ?
-                                0.f
-                                : DEF_RED_BRIGHTNESS
-                            : DEF_RED_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                        //Yellow Lights
-                        lights[OPERATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(configOp == i ?
-                            blinkStatus
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
-                        //Red lights
-                        lights[OPERATOR_LIGHTS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    }
-                    else {
-                        //Set carrier indicator
-                        // In config mode, when a selected operator is both a forced-carrier and disabled,
-                        // the red indicator should blink on/off whenever the yellow selection indicator blinks off/on.
-                        if (forcedCarriers[configScene].test(i)) {
-                            //Purple light
-                            lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                            //Yellow light
-                            lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(configOp == i ?
-                                blinkStatus
-                                : 0.f, args.sampleTime * lightDivider.getDivision());
-                            //Red light
-                            lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(configOp == i ?
-                                blinkStatus ?
-                                    0.f
-                                    : DEF_RED_BRIGHTNESS
-                                : DEF_RED_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                        }
-                        else {
-                            //Purple light
-                            lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                            //Yellow light
-                            lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                            //Red light
-                            lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        }
-                        //Set op lights
-                        //Purple lights
-                        lights[OPERATOR_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        //Yellow Lights
-                        lights[OPERATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(configOp == i ?
-                            blinkStatus
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
-                        //Red lights
-                        lights[OPERATOR_LIGHTS + i * 3 + 2].setSmoothBrightness(configOp == i ?
-                            blinkStatus ?
-                                0.f
-                                : DEF_RED_BRIGHTNESS
-                            : DEF_RED_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                    }
-                }
-                else {
-                    //Set carrier indicator
-                    // In config mode, if a non-horizontal-marked operator is a forced-carrier,
-                    // the purple indicator should blink on/off whenever the yellow selection indicator blinks off/on.
-                    if (forcedCarriers[configScene].test(i)) {
-                        //Purple light
-                        lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(configOp == i ?
-                            blinkStatus ?
-                                0.f
-                                : INDICATOR_BRIGHTNESS
-                            : INDICATOR_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                        //Yellow light
-                        lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(configOp == i ?
-                            blinkStatus
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
-                        //Red light
-                        lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    }
-                    else {
-                        //Purple light
-                        lights[CARRIER_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        //Yellow light
-                        lights[CARRIER_INDICATORS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        //Red light
-                        lights[CARRIER_INDICATORS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    }
-                    //Set op lights
-                    //Purple lights
-                    lights[OPERATOR_LIGHTS + i * 3].setSmoothBrightness(configOp == i ?
-                        blinkStatus ?
-                            0.f
-                            : getInputBrightness(OPERATOR_INPUTS + i)
-                        : getInputBrightness(OPERATOR_INPUTS + i), args.sampleTime * lightDivider.getDivision());
-                    //Yellow Lights
-                    lights[OPERATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(configOp == i ? blinkStatus : 0.f, args.sampleTime * lightDivider.getDivision());
-                    //Red lights
-                    lights[OPERATOR_LIGHTS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                }
-                //Set mod lights
-                if (i != configOp) {
-                    //Purple lights
-                    lights[MODULATOR_LIGHTS + i * 3].setSmoothBrightness(configOp > -1 ?
-                        algoName[configScene].test(configOp * 3 + absToRel[configOp][i]) ?
-                            blinkStatus ?
-                                0.f
-                                : getOutputBrightness(MODULATOR_OUTPUTS + i)
-                            : getOutputBrightness(MODULATOR_OUTPUTS + i)
-                        : getOutputBrightness(MODULATOR_OUTPUTS + i), args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[MODULATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(configOp > -1 ?
-                        (algoName[configScene].test(configOp * 3 + absToRel[configOp][i]) ?
-                            blinkStatus
-                            : 0.f)
-                        : 0.f, args.sampleTime * lightDivider.getDivision());
-                }
-                else {
-                    if (modeB) {
-                        //Purple lights
-                        lights[MODULATOR_LIGHTS + i * 3].setSmoothBrightness(getOutputBrightness(MODULATOR_OUTPUTS + i), args.sampleTime * lightDivider.getDivision());
-                        //Yellow lights
-                        lights[MODULATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(horizontalMarks[configScene].test(configOp) ?
-                            blinkStatus
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
-                    }
-                    else {
-                        //Purple lights
-                        lights[MODULATOR_LIGHTS + i * 3].setSmoothBrightness(horizontalMarks[configScene].test(configOp) ?
-                            blinkStatus ?
-                                0.f
-                                : getOutputBrightness(MODULATOR_OUTPUTS + i)
-                            : getOutputBrightness(MODULATOR_OUTPUTS + i), args.sampleTime * lightDivider.getDivision());
-                        //Yellow lights
-                        lights[MODULATOR_LIGHTS + i * 3 + 1].setSmoothBrightness(horizontalMarks[configScene].test(configOp) ?
-                            blinkStatus
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
-                    }
-                }
-            }
+        float lightTime = args.sampleTime * lightDivider.getDivision();
+        if (updateVisibility(lightTime)) {
+            rotor.step(lightTime);
+            processLights(lightTime, baseScene % 3, params[SCREEN_BUTTON].getValue(), SCREEN_BUTTON_RING_LIGHT);
+        }
+        if (configMode) {
             //Check and update blink timer
             if (blinkTimer > BLINK_INTERVAL / lightDivider.getDivision()) {
                 blinkStatus ^= true;
@@ -688,338 +480,16 @@ void AlgomorphSmall::process(const ProcessArgs& args) {
             }
             else
                 blinkTimer += args.sampleTime;
-            //Set connection lights
-            if (modeB) {
-                for (int i = 0; i < 12; i++) {
-                    //Purple lights
-                    lights[CONNECTION_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(algoName[configScene].test((i / 3) * 3 + (i % 3)) ?
-                        0.4f
-                        : 0.f, args.sampleTime * lightDivider.getDivision());
-                    //Set diagonal disable lights
-                    lights[D_DISABLE_LIGHTS + i].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                }
-                for (int i = 0; i < 4; i++) {
-                    //Purple lights
-                    lights[H_CONNECTION_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(horizontalMarks[configScene].test(i) ?
-                        0.4f
-                        : 0.f, args.sampleTime * lightDivider.getDivision());
-                    //Red lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                }
-            }
-            else {
-                for (int i = 0; i < 12; i++) {
-                    //Purple lights
-                    lights[CONNECTION_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(!horizontalMarks[configScene].test(i / 3) ? 
-                        algoName[configScene].test((i / 3) * 3 + (i % 3)) ?
-                            0.4f
-                            : 0.f
-                        : 0.f, args.sampleTime * lightDivider.getDivision());
-                    //Set diagonal disable lights
-                    lights[D_DISABLE_LIGHTS + i].setSmoothBrightness(!horizontalMarks[configScene].test(i / 3) ? 
-                        0.f
-                        : algoName[configScene].test((i / 3) * 3 + (i % 3)) ?
-                            DEF_RED_BRIGHTNESS
-                            : 0.f, args.sampleTime * lightDivider.getDivision());
-                }
-                //Set horizontal lights
-                for (int i = 0; i < 4; i++) {
-                    //Purple lights
-                    lights[H_CONNECTION_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Red lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 2].setSmoothBrightness(!horizontalMarks[configScene].test(i) ?
-                        0.f
-                        : DEF_RED_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                }
-            }
-            //Set screen button ring light if pressed
-            //Purple lights
-            lights[SCREEN_BUTTON_RING_LIGHT].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-            //Yellow lights
-            lights[SCREEN_BUTTON_RING_LIGHT + 1].setSmoothBrightness(params[SCREEN_BUTTON].getValue(), args.sampleTime * lightDivider.getDivision());
-        } 
-        else {
-            //Set backlight
-            //Set yellow component to off
-            lights[DISPLAY_BACKLIGHT + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-            //Set purple component
-            lights[DISPLAY_BACKLIGHT].setSmoothBrightness(getOutputBrightness(CARRIER_SUM_OUTPUT) / 1024.f + 0.0975f, args.sampleTime * lightDivider.getDivision());
-            //Set edit light
-            lights[EDIT_LIGHT].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-            //Display morphed state
-            float brightness;
-            //Set scene lights
-            for (int i = 0; i < 3; i++) {
-                //Set all components to off
-                lights[SCENE_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                lights[SCENE_LIGHTS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                lights[SCENE_INDICATORS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                lights[SCENE_INDICATORS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                //Set base scene indicator purple component
-                lights[SCENE_INDICATORS + i * 3].setSmoothBrightness(i == (baseScene) % 3 ? 
-                    INDICATOR_BRIGHTNESS
-                    : 0.f, args.sampleTime * lightDivider.getDivision());
-            }
-            //Set center morph scene light's purple component depending on morph
-            lights[SCENE_LIGHTS + centerMorphScene[0] * 3].setSmoothBrightness(1.f - relativeMorphMagnitude[0], args.sampleTime * lightDivider.getDivision());
-            //Set morph target light's purple component depending on morph
-            lights[SCENE_LIGHTS + forwardMorphScene[0] * 3].setSmoothBrightness(relativeMorphMagnitude[0], args.sampleTime * lightDivider.getDivision());
-            //Set op/mod lights and carrier indicators
-            updateSceneBrightnesses();
-            for (int i = 0; i < 4; i++) {
-                //Purple, yellow, and red lights
-                for (int j = 0; j < 3; j++) {
-                    lights[OPERATOR_LIGHTS + i * 3 + j].setSmoothBrightness(crossfade(sceneBrightnesses[centerMorphScene[0]][i][j], sceneBrightnesses[forwardMorphScene[0]][i][j], relativeMorphMagnitude[0]), args.sampleTime * lightDivider.getDivision()); 
-                    lights[MODULATOR_LIGHTS + i * 3 + j].setSmoothBrightness(crossfade(sceneBrightnesses[centerMorphScene[0]][i + 4][j], sceneBrightnesses[forwardMorphScene[0]][i + 4][j], relativeMorphMagnitude[0]), args.sampleTime * lightDivider.getDivision()); 
-                    lights[CARRIER_INDICATORS + i * 3 + j].setSmoothBrightness(crossfade(sceneBrightnesses[centerMorphScene[0]][i + 8][j], sceneBrightnesses[forwardMorphScene[0]][i + 8][j], relativeMorphMagnitude[0]), args.sampleTime * lightDivider.getDivision()); 
-                }
-            }
-            //Set connection lights
-            if (modeB) {
-                for (int i = 0; i < 4; i++) {
-                    brightness = 0.f;
-                    if (horizontalMarks[centerMorphScene[0]].test(i))
-                        brightness += getOutputBrightness(MODULATOR_OUTPUTS + i) * (1.f - relativeMorphMagnitude[0]);
-                    if (horizontalMarks[forwardMorphScene[0]].test(i))
-                        brightness += getOutputBrightness(MODULATOR_OUTPUTS + i) * relativeMorphMagnitude[0];
-                    //Purple lights
-                    lights[H_CONNECTION_LIGHTS + i * 3].setSmoothBrightness(brightness, args.sampleTime * lightDivider.getDivision());
-                    //Yellow
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Red
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 2].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                }
-                for (int i = 0; i < 12; i++) {
-                    brightness = 0.f;
-                    if (algoName[centerMorphScene[0]].test((i / 3) * 3 + (i % 3)))
-                        brightness += getOutputBrightness(MODULATOR_OUTPUTS + i / 3) * (1.f - relativeMorphMagnitude[0]);
-                    if (algoName[forwardMorphScene[0]].test((i / 3) * 3 + (i % 3)))
-                        brightness += getOutputBrightness(MODULATOR_OUTPUTS + i / 3) * relativeMorphMagnitude[0];
-                    //Purple lights
-                    lights[CONNECTION_LIGHTS + i * 3].setSmoothBrightness(brightness, args.sampleTime * lightDivider.getDivision());
-                    //Yellow
-                    lights[CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Set diagonal disable lights
-                    lights[D_DISABLE_LIGHTS + i].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                }
-            }
-            else {
-                for (int i = 0; i < 4; i++) {
-                    brightness = getInputBrightness(OPERATOR_INPUTS + i);
-                    for (int j = 0; j < 3; j++) {
-                        float morphBrightness = 0.f;
-                        if (algoName[centerMorphScene[0]].test(i * 3 + j)) {
-                            if (!horizontalMarks[centerMorphScene[0]].test(i))
-                                morphBrightness += brightness * (1.f - relativeMorphMagnitude[0]);
-                        }
-                        if (algoName[forwardMorphScene[0]].test(i * 3 + j)) {
-                            if (!horizontalMarks[forwardMorphScene[0]].test(i))
-                                morphBrightness += brightness * relativeMorphMagnitude[0];
-                        }
-                        //Purple lights
-                        lights[CONNECTION_LIGHTS + i * 9 + j * 3].setSmoothBrightness(morphBrightness, args.sampleTime * lightDivider.getDivision());
-                        //Yellow
-                        lights[CONNECTION_LIGHTS + i * 9 + j * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                        //Set diagonal disable lights
-                        lights[D_DISABLE_LIGHTS + i * 3 + j].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    }
-                    //Set horizontal disable lights
-                    float horizontalMorphBrightness = 0.f;
-                    if (horizontalMarks[centerMorphScene[0]].test(i))
-                        horizontalMorphBrightness += (1.f - relativeMorphMagnitude[0]);
-                    if (horizontalMarks[forwardMorphScene[0]].test(i))
-                        horizontalMorphBrightness += relativeMorphMagnitude[0];
-                    //Purple lights
-                    lights[H_CONNECTION_LIGHTS + i * 3].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Yellow lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
-                    //Red lights
-                    lights[H_CONNECTION_LIGHTS + i * 3 + 2].setSmoothBrightness(horizontalMorphBrightness * DEF_RED_BRIGHTNESS, args.sampleTime * lightDivider.getDivision());
-                }
-            }
-            //Set screen button ring light if pressed
-            //Purple lights
-            lights[SCREEN_BUTTON_RING_LIGHT].setSmoothBrightness(params[SCREEN_BUTTON].getValue(), args.sampleTime * lightDivider.getDivision());
-            //Yellow lights
-            lights[SCREEN_BUTTON_RING_LIGHT + 1].setSmoothBrightness(0.f, args.sampleTime * lightDivider.getDivision());
         }
     }
-}
-
-float AlgomorphSmall::routeHorizontal(float sampleTime, float inputVoltage, int op, int c) {
-    float connectionA = horizontalMarks[centerMorphScene[c]].test(op) * (1.f - relativeMorphMagnitude[c]);
-    float connectionB = horizontalMarks[forwardMorphScene[c]].test(op) * (relativeMorphMagnitude[c]);
-    float morphedConnection = connectionA + connectionB;
-    modClickGain[op][op][c] = clickFilterEnabled ? modClickFilters[op][op][c].process(sampleTime, morphedConnection) : morphedConnection;
-    return inputVoltage  * modClickGain[op][op][c];
-}
-
-float AlgomorphSmall::routeHorizontalRing(float sampleTime, float inputVoltage, int op, int c) {
-    float connection = horizontalMarks[backwardMorphScene[c]].test(op) * relativeMorphMagnitude[c];
-    modRingClickGain[op][op][c] = clickFilterEnabled ? modRingClickFilters[op][op][c].process(sampleTime, connection) : connection;
-    return -inputVoltage * modRingClickGain[op][op][c];
-}
 
-float AlgomorphSmall::routeDiagonal(float sampleTime, float inputVoltage, int op, int mod, int c) {
-    float connectionA = algoName[centerMorphScene[c]].test(op * 3 + mod)   * (1.f - relativeMorphMagnitude[c])  * !horizontalMarks[centerMorphScene[c]].test(op);
-    float connectionB = algoName[forwardMorphScene[c]].test(op * 3 + mod)  * relativeMorphMagnitude[c]          * !horizontalMarks[forwardMorphScene[c]].test(op);
-    float morphedConnection = connectionA + connectionB;
-    modClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, morphedConnection) : morphedConnection;
-    return inputVoltage * modClickGain[op][relToAbs[op][mod]][c];
-}
-
-float AlgomorphSmall::routeDiagonalB(float sampleTime, float inputVoltage, int op, int mod, int c) {
-    float connectionA = algoName[centerMorphScene[c]].test(op * 3 + mod)   * (1.f - relativeMorphMagnitude[c]);
-    float connectionB = algoName[forwardMorphScene[c]].test(op * 3 + mod)  * relativeMorphMagnitude[c];
-    float morphedConnection = connectionA + connectionB;
-    modClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, morphedConnection) : morphedConnection;
-    return inputVoltage * modClickGain[op][relToAbs[op][mod]][c];
-}
-
-float AlgomorphSmall::routeDiagonalRing(float sampleTime, float inputVoltage, int op, int mod, int c) {
-    float connection = algoName[backwardMorphScene[c]].test(op * 3 + mod) * relativeMorphMagnitude[c] * !horizontalMarks[backwardMorphScene[c]].test(op);
-    modRingClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modRingClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, connection) : connection; 
-    return -inputVoltage * modRingClickGain[op][relToAbs[op][mod]][c];
-}
-
-float AlgomorphSmall::routeDiagonalRingB(float sampleTime, float inputVoltage, int op, int mod, int c) {
-    float connection = algoName[backwardMorphScene[c]].test(op * 3 + mod) * relativeMorphMagnitude[c];
-    modRingClickGain[op][relToAbs[op][mod]][c] = clickFilterEnabled ? modRingClickFilters[op][relToAbs[op][mod]][c].process(sampleTime, connection) : connection; 
-    return -inputVoltage * modRingClickGain[op][relToAbs[op][mod]][c];
-}
-
-float AlgomorphSmall::routeSum(float sampleTime, float inputVoltage, int op, int c) {
-    float connection    =   carriers[centerMorphScene[c]].test(op)     * (1.f - relativeMorphMagnitude[c])  * !horizontalMarks[centerMorphScene[c]].test(op)
-                        +   carriers[forwardMorphScene[c]].test(op)    * relativeMorphMagnitude[c]          * !horizontalMarks[forwardMorphScene[c]].test(op);
-    sumClickGain[op][c] = clickFilterEnabled ? sumClickFilters[op][c].process(sampleTime, connection) : connection;
-    totalCarSumConnection[c] += sumClickGain[op][c];
-    return inputVoltage * sumClickGain[op][c];
-}
-
-float AlgomorphSmall::routeSumB(float sampleTime, float inputVoltage, int op, int c) {
-    float connection    =   carriers[centerMorphScene[c]].test(op)     * (1.f - relativeMorphMagnitude[c])
-                        +   carriers[forwardMorphScene[c]].test(op)    * relativeMorphMagnitude[c];
-    sumClickGain[op][c] = clickFilterEnabled ? sumClickFilters[op][c].process(sampleTime, connection) : connection;
-    totalCarSumConnection[c] += sumClickGain[op][c];
-    return inputVoltage * sumClickGain[op][c];
-}
-
-float AlgomorphSmall::routeSumRing(float sampleTime, float inputVoltage, int op, int c) {
-    float connection = carriers[backwardMorphScene[c]].test(op) * relativeMorphMagnitude[c] * !horizontalMarks[backwardMorphScene[c]].test(op);
-    sumRingClickGain[op][c] = clickFilterEnabled ? sumRingClickFilters[op][c].process(sampleTime, connection) : connection;
-    totalCarSumConnection[c] += sumClickGain[op][c];
-    return -inputVoltage * sumRingClickGain[op][c];
-}
-
-float AlgomorphSmall::routeSumRingB(float sampleTime, float inputVoltage, int op, int c) {
-    float connection = carriers[backwardMorphScene[c]].test(op) * relativeMorphMagnitude[c];
-    sumRingClickGain[op][c] = clickFilterEnabled ? sumRingClickFilters[op][c].process(sampleTime, connection) : connection;
-    totalCarSumConnection[c] += sumClickGain[op][c];
-    return -inputVoltage * sumRingClickGain[op][c];
-}
-
-void AlgomorphSmall::updateSceneBrightnesses() {
-    if (modeB) {
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 4; j++) {
-                //Op lights
-                //Purple lights
-                sceneBrightnesses[i][j][0] = getInputBrightness(AlgomorphSmall::InputIds::OPERATOR_INPUTS + j);
-
-                //Mod lights
-                //Purple lights
-                sceneBrightnesses[i][j + 4][0] = getOutputBrightness(AlgomorphSmall::OutputIds::MODULATOR_OUTPUTS + j);
-
-                //Op lights
-                //Yellow Lights
-                sceneBrightnesses[i][j][1] = 0.f;
-                //Red lights
-                sceneBrightnesses[i][j][2] = 0.f;
-
-                //Carrier indicators
-                if (forcedCarriers[i].test(j)) {
-                    //Purple lights
-                    sceneBrightnesses[i][j + 8][0] = INDICATOR_BRIGHTNESS;
-                }
-                else {
-                    //Purple lights
-                    sceneBrightnesses[i][j + 8][0] = 0.f;
-                }
-                //Yellow lights
-                sceneBrightnesses[i][j + 8][1] = 0.f;
-                //Red lights
-                sceneBrightnesses[i][j + 8][2] = 0.f;
-            }
-        }
+    if (debug) {
+        debugStats.add(DebugSections::LIGHTS, debugSectionStart);
+        debugStats.countScene(centerMorphScene[0]);
+        debugStats.endFrame(debugFrameStart, args.sampleRate);
     }
-    else {
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 4; j++) {
-                if (!horizontalMarks[i].test(j)) {
-                    //Op lights
-                    //Purple lights
-                    sceneBrightnesses[i][j][0] = getInputBrightness(AlgomorphSmall::InputIds::OPERATOR_INPUTS + j);
-                    //Red lights
-                    sceneBrightnesses[i][j][2] = 0.f;
-
-                    //Mod lights
-                    //Purple lights
-                    sceneBrightnesses[i][j + 4][0] = getOutputBrightness(AlgomorphSmall::OutputIds::MODULATOR_OUTPUTS + j);
-
-                    //Carrier indicators
-                    if (forcedCarriers[i].test(j)) {
-                        //Purple lights
-                        sceneBrightnesses[i][j + 8][0] = INDICATOR_BRIGHTNESS;
-                    }
-                    else {
-                        //Purple lights
-                        sceneBrightnesses[i][j + 8][0] = 0.f;
-                    }
-                    //Red lights
-                    sceneBrightnesses[i][j + 8][2] = 0.f;
-                }
-                else {
-                    //Op lights
-                    //Purple lights
-                    sceneBrightnesses[i][j][0] = 0.f;
-                    //Red lights
-                    sceneBrightnesses[i][j][2] = DEF_RED_BRIGHTNESS;
-
-                    //Mod lights
-                    //Purple lights
-                    sceneBrightnesses[i][j + 4][0] = getOutputBrightness(AlgomorphSmall::OutputIds::MODULATOR_OUTPUTS + j);
-
-                    //Carrier indicators
-                    if (forcedCarriers[i].test(j)) {
-                        //Red lights
-                        sceneBrightnesses[i][j + 8][2] = INDICATOR_BRIGHTNESS;
-                    }
-                    else {
-                        //Red lights
-                        sceneBrightnesses[i][j + 8][2] = 0.f;
-                    }
-                    //Purple lights
-                    sceneBrightnesses[i][j + 8][0] = 0.f;
-                }
 
-                //Op lights
-                //Yellow Lights
-                sceneBrightnesses[i][j][1] = 0.f;
-                
-                //Carrier indicators
-                //Yellow lights
-                sceneBrightnesses[i][j + 8][1] = 0.f;
-            }
-        }
-    }
+    recordTelemetry(args.frame);
 }
 
 json_t* AlgomorphSmall::dataToJson() {
@@ -1036,6 +506,7 @@ json_t* AlgomorphSmall::dataToJson() {
     json_object_set_new(rootJ, "Average Mode", json_boolean(avgMode));
     // json_object_set_new(rootJ, "Glowing Ink", json_boolean(glowingInk));
     json_object_set_new(rootJ, "VU Lights", json_boolean(vuLights));
+    json_object_set_new(rootJ, "Display Frame Rate", json_integer(displayFrameRate));
     json_object_set_new(rootJ, "Mod Gain", json_real(gain));
     json_object_set_new(rootJ, "Morph CV 1 Multiplier", json_real(morphMult[0]));
     json_object_set_new(rootJ, "Morph CV 2 Multiplier", json_real(morphMult[1]));
@@ -1064,25 +535,125 @@ json_t* AlgomorphSmall::dataToJson() {
     }
     json_object_set_new(rootJ, "Algorithms: Forced Carriers", forcedCarriersJ);
 
+    std::string state = stateToBase64();
+    if (!state.empty())
+        json_object_set_new(rootJ, "State", json_string(state.c_str()));
+
     return rootJ;
 }
 
+// Everything the legacy keys hold, bitpacked. Empty if a value doesn't fit its field.
+std::string AlgomorphSmall::stateToBase64() {
+    PatchStateWriter w(STATE_VERSION);
+    w.writeBool(configMode);
+    w.writeBool(modeB);
+    w.writeBool(ringMorph);
+    w.writeBool(randomRingMorph);
+    w.writeBool(exitConfigOnConnect);
+    w.writeBool(clickFilterEnabled);
+    w.writeBool(avgMode);
+    w.writeBool(vuLights);
+    w.writeInt(configOp, 8);
+    w.writeInt(configScene, 8);
+    w.writeInt(baseScene, 8);
+    w.writeInt(displayFrameRate, 16);
+    w.writeFloat(gain);
+    w.writeFloat(morphMult[0]);
+    w.writeFloat(morphMult[1]);
+    for (int scene = 0; scene < 3; scene++) {
+        w.writeBits(algoName[scene].to_ulong(), 16);
+        w.writeBits(horizontalMarks[scene].to_ulong(), 4);
+        w.writeBits(forcedCarriers[scene].to_ulong(), 4);
+    }
+    return w.exact ? w.toBase64() : "";
+}
+
+// Returns false, leaving the module untouched, if the state can't be read
+bool AlgomorphSmall::stateFromBase64(const std::string& state) {
+    PatchStateReader r(state, STATE_VERSION);
+    bool newConfigMode = r.readBool();
+    bool newModeB = r.readBool();
+    bool newRingMorph = r.readBool();
+    bool newRandomRingMorph = r.readBool();
+    bool newExitConfigOnConnect = r.readBool();
+    bool newClickFilterEnabled = r.readBool();
+    bool newAvgMode = r.readBool();
+    bool newVuLights = r.readBool();
+    int newConfigOp = r.readInt(8);
+    int newConfigScene = r.readInt(8);
+    int newBaseScene = r.readInt(8);
+    int newDisplayFrameRate = r.readInt(16);
+    float newGain = r.readFloat();
+    float newMorphMult0 = r.readFloat();
+    float newMorphMult1 = r.readFloat();
+    uint32_t newAlgoName[3];
+    uint32_t newHorizontalMarks[3];
+    uint32_t newForcedCarriers[3];
+    for (int scene = 0; scene < 3; scene++) {
+        newAlgoName[scene] = r.readBits(16);
+        newHorizontalMarks[scene] = r.readBits(4);
+        newForcedCarriers[scene] = r.readBits(4);
+    }
+    if (!r.ok)
+        return false;
+
+    configMode = newConfigMode;
+    modeB = newModeB;
+    ringMorph = newRingMorph;
+    randomRingMorph = newRandomRingMorph;
+    exitConfigOnConnect = newExitConfigOnConnect;
+    clickFilterEnabled = newClickFilterEnabled;
+    avgMode = newAvgMode;
+    vuLights = newVuLights;
+    // Same ranges as the legacy keys. configScene is -1 before the first reset and 3 after it, until config mode picks one
+    configOp = rack::math::clamp(newConfigOp, -1, 3);
+    configScene = rack::math::clamp(newConfigScene, -1, 3);
+    baseScene = rack::math::clamp(newBaseScene, 0, 2);
+    displayFrameRate = newDisplayFrameRate;
+    gain = newGain;
+    morphMult[0] = newMorphMult0;
+    morphMult[1] = newMorphMult1;
+    for (int scene = 0; scene < 3; scene++) {
+        algoName[scene] = newAlgoName[scene];
+        horizontalMarks[scene] = newHorizontalMarks[scene];
+        forcedCarriers[scene] = newForcedCarriers[scene];
+    }
+    return true;
+}
+
 void AlgomorphSmall::dataFromJson(json_t* rootJ) {
+    // Prefer the compact state, falling back to the keys for patches from older versions
+    json_t* stateJ = json_object_get(rootJ, "State");
+    if (!json_is_string(stateJ) || !stateFromBase64(json_string_value(stateJ)))
+        legacyDataFromJson(rootJ);
+
+    // Update disabled status, carriers, modulators, and display algorithm
+    for (int scene = 0; scene < 3; scene++) {
+        updateOpsDisabled(scene);
+        updateCarriers(scene);
+        updateModulators(scene);
+        updateDisplayAlgo(scene);
+    }
+
+    graphDirty = true;
+}
+
+void AlgomorphSmall::legacyDataFromJson(json_t* rootJ) {
     auto configMode = json_object_get(rootJ, "Config Enabled");
     if (configMode)
         this->configMode = json_boolean_value(configMode);
     
     auto configOp = json_object_get(rootJ, "Config Mode");
     if (configOp)
-        this->configOp = json_integer_value(configOp);
+        this->configOp = rack::math::clamp((int) json_integer_value(configOp), -1, 3);
     
     auto configScene = json_object_get(rootJ, "Config Scene");
     if (configScene)
-        this->configScene = json_integer_value(configScene);
+        this->configScene = rack::math::clamp((int) json_integer_value(configScene), -1, 3);
     
     auto baseScene = json_object_get(rootJ, "Current Scene");
     if (baseScene)
-        this->baseScene = json_integer_value(baseScene);
+        this->baseScene = rack::math::clamp((int) json_integer_value(baseScene), 0, 2);
     
     auto modeB = json_object_get(rootJ, "Horizontal Allowed");
     if (modeB)
@@ -1118,6 +689,10 @@ void AlgomorphSmall::dataFromJson(json_t* rootJ) {
     if (vuLights)
         this->vuLights = json_boolean_value(vuLights);
 
+    auto displayFrameRate = json_object_get(rootJ, "Display Frame Rate");
+    if (displayFrameRate)
+        this->displayFrameRate = json_integer_value(displayFrameRate);
+
     auto gain = json_object_get(rootJ, "Mod Gain");
     if (gain)
         this->gain = json_real_value(gain);
@@ -1153,34 +728,6 @@ void AlgomorphSmall::dataFromJson(json_t* rootJ) {
             forcedCarriers[sceneIndex] = json_integer_value(json_object_get(sceneForcedCarriers, (std::string("Algorithm ") + std::to_string(sceneIndex)).c_str()));
         }
     }
-
-    // Update disabled status, carriers, modulators, and display algorithm
-    for (int scene = 0; scene < 3; scene++) {
-        updateOpsDisabled(scene);
-        updateCarriers(scene);
-        updateModulators(scene);
-        updateDisplayAlgo(scene);
-    }
-
-    graphDirty = true;
-}
-
-float AlgomorphSmall::getInputBrightness(int portID) {
-    if (vuLights)
-        return std::max(    {   inputs[portID].plugLights[0].getBrightness(),
-                                inputs[portID].plugLights[1].getBrightness() * 4,
-                                inputs[portID].plugLights[2].getBrightness()          }   );
-    else
-        return 1.f;
-}
-
-float AlgomorphSmall::getOutputBrightness(int portID) {
-    if (vuLights)
-        return std::max(    {   outputs[portID].plugLights[0].getBrightness(),
-                                outputs[portID].plugLights[1].getBrightness() * 4,
-                                outputs[portID].plugLights[2].getBrightness()          }   );
-    else
-        return 1.f;
 }
 
 
@@ -1451,6 +998,8 @@ void AlgomorphSmallWidget::appendContextMenu(Menu* menu) {
     VULightsItem *vuLightsItem = rack::createMenuItem<VULightsItem>("VU lighting", CHECKMARK(module->vuLights));
     vuLightsItem->module = module;
     menu->addChild(vuLightsItem);
+
+    menu->addChild(construct<DisplayFrameRateMenuItem>(&MenuItem::text, "Display frame rate", &MenuItem::rightText, (module->displayFrameRate > 0 ? rack::string::f("%d fps ", module->displayFrameRate) : std::string("Unlimited ")) + RIGHT_ARROW, &DisplayFrameRateMenuItem::module, module));
     
     // GlowingInkItem *glowingInkItem = rack::createMenuItem<GlowingInkItem>("Enable glowing panel ink", CHECKMARK(module->glowingInk));
     // glowingInkItem->module = module;
@@ -1461,16 +1010,21 @@ void AlgomorphSmallWidget::appendContextMenu(Menu* menu) {
     saveVisualSettingsItem->module = module;
     menu->addChild(saveVisualSettingsItem);
 
-    // menu->addChild(new rack::ui::MenuSeparator());
+    menu->addChild(new rack::ui::MenuSeparator());
 
-    // DebugItem *debugItem = rack::createMenuItem<DebugItem>("The system is down", CHECKMARK(module->debug));
-    // debugItem->module = module;
-    // menu->addChild(debugItem);
+    DebugItem *debugItem = rack::createMenuItem<DebugItem>("Profile CPU usage", CHECKMARK(module->debug));
+    debugItem->module = module;
+    menu->addChild(debugItem);
+    if (module->debug)
+        menu->addChild(construct<DebugStatsMenuItem>(&MenuItem::text, "Statistics…", &MenuItem::rightText, RIGHT_ARROW, &DebugStatsMenuItem::module, module));
+    TelemetryRecorder* telemetry = module->telemetry.load(std::memory_order_relaxed);
+    menu->addChild(construct<TelemetryMenuItem>(&MenuItem::text, "Telemetry…", &MenuItem::rightText, (telemetry && telemetry->recording ? "Recording " : "") + std::string(RIGHT_ARROW), &TelemetryMenuItem::module, module));
 }
 
 void AlgomorphSmallWidget::step() {
     if (module) {
         AlgomorphSmall* m = dynamic_cast<AlgomorphSmall*>(module);
+        pushHistoryRequests(m);
         // ink->visible = m->glowingInk == 1;
         if (m->inputs[AlgomorphSmall::MORPH_INPUTS + 0].isConnected() || m->inputs[AlgomorphSmall::MORPH_INPUTS + 1].isConnected()) {
             if (morphKnobShown) {
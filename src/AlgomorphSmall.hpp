@@ -5,6 +5,8 @@ using rack::window::mm2px;
 
 
 struct AlgomorphSmall : Algomorph<> {
+    static constexpr uint8_t STATE_VERSION = 1;
+
     enum ParamIds {
         ENUMS(OPERATOR_BUTTONS, 4),
         ENUMS(MODULATOR_BUTTONS, 4),
@@ -54,19 +56,9 @@ struct AlgomorphSmall : Algomorph<> {
     AlgomorphSmall();
     void onReset() override;
     void process(const ProcessArgs& args) override;
-    float routeHorizontal(float sampleTime, float inputVoltage, int op, int c);
-    float routeHorizontalRing(float sampleTime, float inputVoltage, int op, int c);
-    float routeDiagonal(float sampleTime, float inputVoltage, int op, int mod, int c);
-    float routeDiagonalB(float sampleTime, float inputVoltage, int op, int mod, int c);
-    float routeDiagonalRing(float sampleTime, float inputVoltage, int op, int mod, int c);
-    float routeDiagonalRingB(float sampleTime, float inputVoltage, int op, int mod, int c);
-    float routeSum(float sampleTime, float inputVoltage, int op, int c);
-    float routeSumB(float sampleTime, float inputVoltage, int op, int c);
-    float routeSumRing(float sampleTime, float inputVoltage, int op, int c);
-    float routeSumRingB(float sampleTime, float inputVoltage, int op, int c);
-    void updateSceneBrightnesses();
-    float getInputBrightness(int portID);
-    float getOutputBrightness(int portID);
+    std::string stateToBase64();
+    bool stateFromBase64(const std::string& state);
+    void legacyDataFromJson(json_t* rootJ);
     json_t* dataToJson() override;
     void dataFromJson(json_t* rootJ) override;
 };
@@ -0,0 +1,93 @@
+#include "AlgomorphWide.hpp"
+#include "Components.hpp"
+#include "plugin.hpp" // For constants
+#include <rack.hpp>
+#include <algorithm>
+using rack::RACK_GRID_WIDTH;
+
+
+static const float WideGroupColumns[WIDE_GROUPS] = {12.7f, 25.4f, 38.1f};
+static const float WideOperatorRows[4] = {18.f, 28.f, 38.f, 48.f};
+static const float WideModulatorRows[4] = {62.f, 72.f, 82.f, 92.f};
+static constexpr float WIDE_CARRIER_SUM_ROW = 104.f;
+static constexpr float WIDE_MODULATOR_SUM_ROW = 114.f;
+
+AlgomorphWide::AlgomorphWide() {
+    config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+
+    for (int group = 0; group < WIDE_GROUPS; group++) {
+        std::string voices = " (voices " + std::to_string((group + 1) * CHANNELS + 1) + "-" + std::to_string((group + 2) * CHANNELS) + ")";
+        for (int i = 0; i < 4; i++) {
+            configInput(OPERATOR_INPUTS + group * 4 + i, "Operator " + std::to_string(i + 1) + voices);
+            configOutput(MODULATOR_OUTPUTS + group * 4 + i, "Modulator " + std::to_string(i + 1) + voices);
+        }
+        configOutput(CARRIER_SUM_OUTPUTS + group, "Carrier Sum" + voices);
+        configOutput(MODULATOR_SUM_OUTPUTS + group, "Modulator Sum" + voices);
+    }
+    configLight(LINK_LIGHT, "Linked to Algomorph Advance");
+
+    leftExpander.producerMessage = &outputMessages[0];
+    leftExpander.consumerMessage = &outputMessages[1];
+}
+
+void AlgomorphWide::process(const ProcessArgs& args) {
+    bool linked = leftExpander.module && leftExpander.module->model == modelAlgomorphLarge;
+    lights[LINK_LIGHT].setBrightness(linked);
+
+    if (!linked) {
+        for (int i = 0; i < NUM_OUTPUTS; i++)
+            outputs[i].setChannels(0);
+        return;
+    }
+
+    // Inputs go straight into Algomorph Advance's buffer, ready for its next sample
+    WideInputMessage* in = (WideInputMessage*) leftExpander.module->rightExpander.producerMessage;
+    for (int group = 0; group < WIDE_GROUPS; group++) {
+        for (int i = 0; i < 4; i++) {
+            int channels = inputs[OPERATOR_INPUTS + group * 4 + i].getChannels();
+            in->channels[group][i] = channels;
+            inputs[OPERATOR_INPUTS + group * 4 + i].readVoltages(in->in[group][i]);
+            std::fill(in->in[group][i] + channels, in->in[group][i] + CHANNELS, 0.f);
+        }
+    }
+    leftExpander.module->rightExpander.requestMessageFlip();
+
+    WideOutputMessage* out = (WideOutputMessage*) leftExpander.consumerMessage;
+    for (int group = 0; group < WIDE_GROUPS; group++) {
+        for (int i = 0; i < 4; i++) {
+            outputs[MODULATOR_OUTPUTS + group * 4 + i].setChannels(out->channels[group]);
+            outputs[MODULATOR_OUTPUTS + group * 4 + i].writeVoltages(out->modOut[group][i]);
+        }
+        outputs[CARRIER_SUM_OUTPUTS + group].setChannels(out->channels[group]);
+        outputs[CARRIER_SUM_OUTPUTS + group].writeVoltages(out->carSumOut[group]);
+        outputs[MODULATOR_SUM_OUTPUTS + group].setChannels(out->channels[group]);
+        outputs[MODULATOR_SUM_OUTPUTS + group].writeVoltages(out->modSumOut[group]);
+    }
+}
+
+
+///// Panel Widget
+
+AlgomorphWideWidget::AlgomorphWideWidget(AlgomorphWide* module) {
+    setModule(module);
+    setPanel(APP->window->loadSvg(rack::asset::plugin(pluginInstance, "res/AlgomorphWide.svg")));
+
+    addChild(rack::createWidget<DLXGameBitBlack>(Vec(RACK_GRID_WIDTH, 0)));
+    addChild(rack::createWidget<DLXGameBitBlack>(Vec(box.size.x - RACK_GRID_WIDTH * 2, 0)));
+    addChild(rack::createWidget<DLXGameBitBlack>(Vec(RACK_GRID_WIDTH, 365)));
+    addChild(rack::createWidget<DLXGameBitBlack>(Vec(box.size.x - RACK_GRID_WIDTH * 2, 365)));
+
+    addChild(rack::createLightCentered<rack::componentlibrary::SmallLight<rack::componentlibrary::PurpleLight>>(mm2px(Vec(25.4, 8.f)), module, AlgomorphWide::LINK_LIGHT));
+
+    for (int group = 0; group < WIDE_GROUPS; group++) {
+        float x = WideGroupColumns[group];
+        for (int i = 0; i < 4; i++) {
+            addInput(rack::createInputCentered<DLXPJ301MPort>(mm2px(Vec(x, WideOperatorRows[i])), module, AlgomorphWide::OPERATOR_INPUTS + group * 4 + i));
+            addOutput(rack::createOutputCentered<DLXPJ301MPort>(mm2px(Vec(x, WideModulatorRows[i])), module, AlgomorphWide::MODULATOR_OUTPUTS + group * 4 + i));
+        }
+        addOutput(rack::createOutputCentered<DLXPJ301MPort>(mm2px(Vec(x, WIDE_CARRIER_SUM_ROW)), module, AlgomorphWide::CARRIER_SUM_OUTPUTS + group));
+        addOutput(rack::createOutputCentered<DLXPJ301MPort>(mm2px(Vec(x, WIDE_MODULATOR_SUM_ROW)), module, AlgomorphWide::MODULATOR_SUM_OUTPUTS + group));
+    }
+}
+
+Model* modelAlgomorphWide = createModel<AlgomorphWide, AlgomorphWideWidget>("AlgomorphWide");
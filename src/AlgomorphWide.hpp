@@ -0,0 +1,57 @@
+#pragma once
+#include "plugin.hpp" // For constants
+#include <rack.hpp>
+using rack::window::mm2px;
+
+
+// Algomorph Wide Structure
+// Expander for Algomorph Advance, placed to its right. Adds WIDE_GROUPS more sets of operator inputs and modulator,
+// carrier sum and modulator sum outputs, so one instance can route up to 4 x 16 voices per operator. Voice c of every
+// group follows channel c of the module: routing, morph, click filters and AUX processing are computed once per
+// channel by Algomorph Advance and applied to all groups.
+// Voltages travel over Rack's double-buffered expander messages, each side writing into buffers the other owns,
+// so the wide groups run one sample behind the module in each direction. A group's input is routed with the module's
+// state of the sample after it, which only shows while morph, a click filter or the run gate is moving.
+
+static constexpr int WIDE_GROUPS = 3;
+
+struct alignas(16) WideInputMessage {          // Wide to Advance, held by Advance's rightExpander
+    float in[WIDE_GROUPS][4][CHANNELS];
+    int channels[WIDE_GROUPS][4];               // 0 when unconnected
+};
+
+struct alignas(16) WideOutputMessage {         // Advance to Wide, held by Wide's leftExpander
+    float modOut[WIDE_GROUPS][4][CHANNELS];
+    float carSumOut[WIDE_GROUPS][CHANNELS];
+    float modSumOut[WIDE_GROUPS][CHANNELS];
+    int channels[WIDE_GROUPS];
+};
+
+struct AlgomorphWide : rack::engine::Module {
+    enum ParamIds {
+        NUM_PARAMS
+    };
+    enum InputIds {
+        ENUMS(OPERATOR_INPUTS, WIDE_GROUPS * 4),
+        NUM_INPUTS
+    };
+    enum OutputIds {
+        ENUMS(MODULATOR_OUTPUTS, WIDE_GROUPS * 4),
+        ENUMS(CARRIER_SUM_OUTPUTS, WIDE_GROUPS),
+        ENUMS(MODULATOR_SUM_OUTPUTS, WIDE_GROUPS),
+        NUM_OUTPUTS
+    };
+    enum LightIds {
+        LINK_LIGHT,
+        NUM_LIGHTS
+    };
+
+    WideOutputMessage outputMessages[2] = {};      // Written by Algomorph Advance on the left
+
+    AlgomorphWide();
+    void process(const ProcessArgs& args) override;
+};
+
+struct AlgomorphWideWidget : rack::app::ModuleWidget {
+    AlgomorphWideWidget(AlgomorphWide* module);
+};
@@ -1,6 +1,7 @@
 #include "AuxSources.hpp"
 #include "AlgomorphLarge.hpp"
 #include "plugin.hpp" // For constants
+#include <algorithm>
 
 
 AuxInput::AuxInput(int id, rack::engine::Module* module) {
@@ -33,7 +34,7 @@ void AuxInput::setMode(int newMode) {
     lastSetMode = newMode;
     reinterpret_cast<AlgomorphLarge*>(module)->auxModeFlags[newMode] = true;
 
-    updateLabel();
+    labelDirty = true;
 
     reinterpret_cast<AlgomorphLarge*>(module)->auxPanelDirty = true;
 }
@@ -44,7 +45,7 @@ void AuxInput::unsetAuxMode(int oldMode) {
         
         modeIsActive[oldMode] = false;
 
-        updateLabel();
+        labelDirty = true;
     }
 
     reinterpret_cast<AlgomorphLarge*>(module)->auxPanelDirty = true;
@@ -68,6 +69,14 @@ void AuxInput::updateVoltage() {
     }
 }
 
+// From a buffer already spread over 16 channels, e.g. an Algomorph AUX lane
+void AuxInput::updateVoltage(const float* voltages) {
+    for (int mode = 0; mode < AuxInputModes::NUM_MODES; mode++) {
+        if (modeIsActive[mode])
+            std::copy(voltages, voltages + channels, voltage[mode]);
+    }
+}
+
 void AuxInput::updateLabel() {
     int displayCode;
 
@@ -92,17 +101,17 @@ void AuxInput::updateLabel() {
     else if (displayCode == -2) {
         shortLabel = "MULTI";
         label = "Multimode Input";
-        std::string description = "Multimode: ";
+        description = "Multimode: ";
         int count = 0;
         for (int i = 0; i < AuxInputModes::NUM_MODES; i++) {
             if (modeIsActive[i]) {
                 count++;
                 description += AuxInputModeLabels[i];
+                if (count < activeModes)
+                    description += ", ";
+                else
+                    break;
             }
-            if (count < activeModes)
-                description += ", ";
-            else
-                break;
         }
     }
     else if (displayCode == -1)
@@ -119,11 +128,19 @@ void AuxInput::updateLabel() {
     }
 }
 
+// Mode changes can happen on the engine thread, so they only mark the labels dirty. Rebuild them here, from the UI thread.
+void AuxInput::refreshLabel() {
+    if (labelDirty.exchange(false))
+        updateLabel();
+}
+
 std::string AuxInputInfo::getName() {
+    this->input->refreshLabel();
     return this->input->label;
 }
 
 std::string AuxInputInfo::getDescription() {
+    this->input->refreshLabel();
     return this->input->description;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include <rack.hpp>
+#include <atomic>
 
 
 // AuxInput and AuxKnob modes:
@@ -29,7 +30,8 @@ struct AuxInputModes : AuxSourceModes {
 	// 4 shadow modes
 	static const int DOUBLE_MORPH_ATTEN = AuxSourceModes::NUM_MODES + 13;
 	static const int TRIPLE_MORPH_ATTEN = AuxSourceModes::NUM_MODES + 14;
-	static const int NUM_MODES = AuxSourceModes::NUM_MODES + 15;
+	static const int BANK_SLOT = 		AuxSourceModes::NUM_MODES + 15;
+	static const int NUM_MODES = AuxSourceModes::NUM_MODES + 16;
 };
 
 //Order must match above
@@ -52,7 +54,8 @@ static const std::string AuxInputModeLabels[AuxInputModes::NUM_MODES] = {	"Morph
 																			"Operator 3",
 																			"Operator 4",
 																			"Morph CV Double Ampliverter",
-																			"Morph CV Triple Ampliverter"};
+																			"Morph CV Triple Ampliverter",
+																			"Scene Bank Slot"};
 
 //Order must match above
 static const std::string AuxInputModeShortLabels[AuxInputModes::NUM_MODES] = {	"CV",
@@ -74,7 +77,8 @@ static const std::string AuxInputModeShortLabels[AuxInputModes::NUM_MODES] = {	"
 																				"OP 3",
 																				"OP 4",
 																				"CV%x2",
-																				"CV%x3"	};
+																				"CV%x3",
+																				"BANK"	};
 
 //Order must match above
 static const std::string AuxInputModeDescriptions[AuxInputModes::NUM_MODES] = {	"CV input for modulating Morph state",
@@ -96,7 +100,8 @@ static const std::string AuxInputModeDescriptions[AuxInputModes::NUM_MODES] = {
 																				"Operator 3 input, routed to match Operator 3's destination",
 																				"Operator 4 input, routed to match Operator 4's destination",
 																				"2x CV input for attenuating/inverting Morph modulation",
-																				"3x CV input for attenuating/inverting Morph modulation" };
+																				"3x CV input for attenuating/inverting Morph modulation",
+																				"CV input for loading scene bank slots, 12 slots per volt from the chosen slot" };
 
 // AuxKnob-only modes:
 
@@ -162,6 +167,7 @@ struct AuxInput {
 	std::string label = "";
 	std::string shortLabel = "";
 	std::string description = "";
+	std::atomic<bool> labelDirty{true};                             // Set by mode changes on any thread, cleared by refreshLabel() on the UI thread
 
     rack::dsp::SchmittTrigger runCVTrigger;
     rack::dsp::SchmittTrigger sceneAdvCVTrigger;
@@ -180,7 +186,9 @@ struct AuxInput {
     void unsetAuxMode(int oldMode);
     void clearAuxModes();
     void updateVoltage();
+    void updateVoltage(const float* voltages);
 	void updateLabel();
+	void refreshLabel();
 };
 
 // Dynamic port tooltips
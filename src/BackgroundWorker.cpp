@@ -0,0 +1,131 @@
+#include "BackgroundWorker.hpp"
+#include <rack.hpp>
+#include <chrono>
+#include <future>
+
+
+BackgroundWorker backgroundWorker;
+
+// The last user has joined the thread by now, and joining it here, while the plugin library is being unloaded, can
+// deadlock. So this only runs what was submitted since, and lets go of a thread started without acquiring the worker
+BackgroundWorker::~BackgroundWorker() {
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            running = false;
+        }
+        wake.notify_one();
+        thread.detach();
+    }
+    else
+        runPending();
+}
+
+void BackgroundWorker::acquire() {
+    users++;
+}
+
+void BackgroundWorker::release() {
+    if (--users == 0)
+        stop();
+}
+
+void BackgroundWorker::submit(std::function<void()> task) {
+    if (!running.load(std::memory_order_acquire))
+        start();
+
+    Task* t = new Task{std::move(task), pending.load(std::memory_order_relaxed)};
+    while (!pending.compare_exchange_weak(t->next, t, std::memory_order_release, std::memory_order_relaxed));
+    // The worker may sleep without a timeout, so wait until it has either checked for tasks or gone to sleep
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+}
+
+void BackgroundWorker::addPeriodic(const void* owner, std::function<void()> task) {
+    submit([this, owner, task] {
+        periodic.push_back(std::make_pair(owner, task));
+    });
+}
+
+// Once this returns, the owner's periodic task has run for the last time
+void BackgroundWorker::removePeriodic(const void* owner) {
+    submit([this, owner] {
+        for (auto it = periodic.begin(); it != periodic.end(); ++it) {
+            if (it->first == owner) {
+                periodic.erase(it);
+                break;
+            }
+        }
+    });
+    flush();
+}
+
+// Blocks until every task submitted so far has run. Not for use from a task
+void BackgroundWorker::flush() {
+    std::promise<void> done;
+    std::future<void> ran = done.get_future();
+    submit([&done] {
+        done.set_value();
+    });
+    ran.wait();
+}
+
+void BackgroundWorker::start() {
+    std::lock_guard<std::mutex> lock(threadMutex);
+    if (running)
+        return;
+    running = true;
+    thread = std::thread(&BackgroundWorker::run, this);
+}
+
+// Runs every task submitted so far, then joins the thread
+void BackgroundWorker::stop() {
+    std::lock_guard<std::mutex> lock(threadMutex);
+    if (!thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> sleepLock(sleepMutex);
+        running = false;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void BackgroundWorker::runPending() {
+    Task* t = pending.exchange(NULL, std::memory_order_acquire);
+    // Reverse the stack into submission order
+    Task* ordered = NULL;
+    while (t) {
+        Task* next = t->next;
+        t->next = ordered;
+        ordered = t;
+        t = next;
+    }
+    while (ordered) {
+        Task* next = ordered->next;
+        ordered->run();
+        delete ordered;
+        ordered = next;
+    }
+}
+
+void BackgroundWorker::run() {
+    rack::system::setThreadName("Delexander worker");
+    while (running) {
+        runPending();
+        for (auto& task : periodic)
+            task.second();
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        auto woken = [this] {
+            return pending.load(std::memory_order_relaxed) || !running;
+        };
+        if (periodic.empty())
+            wake.wait(lock, woken);
+        else
+            wake.wait_for(lock, std::chrono::milliseconds(PERIOD_MS), woken);
+    }
+    runPending();
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+// BackgroundWorker Structure
+// One thread owned by the plugin, for file writes and precomputation that shouldn't stall the UI or audio threads.
+// Submitting is a lock-free push onto a stack of pending tasks; the worker takes the whole stack at once and runs it in
+// submission order. Never submit from the audio thread, since a task is allocated.
+// Periodic tasks, e.g. telemetry flushes, run after each batch and every PERIOD_MS. They are added and removed through
+// the queue, so only the worker touches them. Without any, the worker sleeps until the next submission.
+// The thread starts on the first submission. Modules and recording telemetry hold the worker with acquire(), and when
+// the last of them releases it, the thread runs what's left and is joined. A later submission starts it again.
+
+struct BackgroundWorker {
+    static constexpr int PERIOD_MS = 20;
+
+    struct Task {
+        std::function<void()> run;
+        Task* next;
+    };
+
+    std::atomic<Task*> pending{NULL};                   // Newest first
+    std::atomic<bool> running{false};
+    std::atomic<int> users{0};
+    std::thread thread;
+    std::mutex threadMutex;                             // Held while starting or stopping the thread
+    std::mutex sleepMutex;                              // Held by the worker while it sleeps
+    std::condition_variable wake;
+    std::vector<std::pair<const void*, std::function<void()>>> periodic;
+
+    ~BackgroundWorker();
+    void acquire();
+    void release();
+    void submit(std::function<void()> task);
+    void addPeriodic(const void* owner, std::function<void()> task);
+    void removePeriodic(const void* owner);
+    void flush();
+    void start();
+    void stop();
+    void runPending();
+    void run();
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "plugin.hpp" // For constants
+#include "HaloCache.hpp"
 #include <rack.hpp>
 using rack::math::Vec;
 using rack::engine::Module;
@@ -153,6 +154,7 @@ struct TLineLight : TBase {
 	bool flipped = false;
 	float angle = 0.f;
 	float length = 0.f;
+	SharedHaloCache haloCache;
 
 	TLineLight(Vec a, Vec b) {
 		flipped = a.y > b.y;
@@ -229,7 +231,6 @@ struct TLineLight : TBase {
 		float w = length + oradius * 2.f;
 		float h = radius + oradius * 2.f;
 
-		nvgBeginPath(args.vg);
 		if (flipped) {
 			nvgTranslate(args.vg, 0.f, this->box.size.y);
 			nvgRotate(args.vg, -angle);
@@ -238,13 +239,16 @@ struct TLineLight : TBase {
 		}
 		else
 			nvgRotate(args.vg, angle);
-		nvgRoundedRect(args.vg, x - w, y - h, w * 3.f, h * 3.f, h * 1.5f);
 
-		NVGcolor icol = rack::color::mult(this->color, halo);
-		NVGcolor ocol = nvgRGBA(0, 0, 0, 0);
-		NVGpaint paint = nvgBoxGradient(args.vg, x, y, w, h, h * 0.5f, h, icol, ocol);
-		nvgFillPaint(args.vg, paint);
-		nvgFill(args.vg);
+		// The gradient reaches zero half a feather outside its box
+		rack::math::Rect bounds = rack::math::Rect(x - h * 0.5f, y - h * 0.5f, w + h, h * 2.f);
+		haloCache.drawHalo(args, typeid(*this), bounds, rack::color::mult(this->color, halo), 0, [=](NVGcontext* vg, NVGcolor icol) {
+			nvgBeginPath(vg);
+			nvgRoundedRect(vg, x - w, y - h, w * 3.f, h * 3.f, h * 1.5f);
+			NVGpaint paint = nvgBoxGradient(vg, x, y, w, h, h * 0.5f, h, icol, nvgRGBA(0, 0, 0, 0));
+			nvgFillPaint(vg, paint);
+			nvgFill(vg);
+		});
 	}
 };
 typedef TLineLight<> LineLight;
@@ -260,6 +264,7 @@ TLineLight<TBase>* createLineLight(Vec a, Vec b, Module* module, int firstLightI
 template <typename TBase = rack::GrayModuleLightWidget>
 struct TRingLight : TBase {
 	float radius = 0.f;
+	SharedHaloCache haloCache;
 
 	TRingLight(float r) {
 		this->radius = r;
@@ -314,31 +319,34 @@ struct TRingLight : TBase {
 		if (this->color.r == 0.f && this->color.g == 0.f && this->color.b == 0.f)
 			return;
 
-		nvgShapeAntiAlias(args.vg, false);
-
 		Vec c = this->box.size.div(2);
-
-		// Outer halo
-		float iradius = RING_LIGHT_STROKEWIDTH + this->radius;
-		float oradius = RING_LIGHT_STROKEWIDTH * 9.125f + this->radius;
-		nvgBeginPath(args.vg);
-		nvgRect(args.vg, c.x - oradius, c.y - oradius, 2 * (oradius), 2 * (oradius));
-		nvgCircle(args.vg, c.x, c.y, this->radius);
-		nvgPathWinding(args.vg, NVG_HOLE);
-		NVGcolor icol = rack::color::mult(this->color, halo);
-		NVGcolor ocol = nvgRGBA(0, 0, 0, 0);
-		NVGpaint paint = nvgRadialGradient(args.vg, c.x, c.y, iradius, oradius, icol, ocol);
-		nvgFillPaint(args.vg, paint);
-		nvgFill(args.vg);
-
-		// Inner halo
-		iradius = -RING_LIGHT_STROKEWIDTH * 9.125f + this->radius;
-		oradius = this->radius;
-		nvgBeginPath(args.vg);
-		nvgCircle(args.vg, c.x, c.y, this->radius);
-		paint = nvgRadialGradient(args.vg, c.x, c.y, iradius, oradius, ocol, icol);
-		nvgFillPaint(args.vg, paint);
-		nvgFill(args.vg);
+		float r = this->radius;
+		float extent = RING_LIGHT_STROKEWIDTH * 9.125f + r;
+		rack::math::Rect bounds = rack::math::Rect(c.x - extent, c.y - extent, extent * 2.f, extent * 2.f);
+		haloCache.drawHalo(args, typeid(*this), bounds, rack::color::mult(this->color, halo), 0, [=](NVGcontext* vg, NVGcolor icol) {
+			nvgShapeAntiAlias(vg, false);
+
+			// Outer halo
+			float iradius = RING_LIGHT_STROKEWIDTH + r;
+			float oradius = RING_LIGHT_STROKEWIDTH * 9.125f + r;
+			nvgBeginPath(vg);
+			nvgRect(vg, c.x - oradius, c.y - oradius, 2 * (oradius), 2 * (oradius));
+			nvgCircle(vg, c.x, c.y, r);
+			nvgPathWinding(vg, NVG_HOLE);
+			NVGcolor ocol = nvgRGBA(0, 0, 0, 0);
+			NVGpaint paint = nvgRadialGradient(vg, c.x, c.y, iradius, oradius, icol, ocol);
+			nvgFillPaint(vg, paint);
+			nvgFill(vg);
+
+			// Inner halo
+			iradius = -RING_LIGHT_STROKEWIDTH * 9.125f + r;
+			oradius = r;
+			nvgBeginPath(vg);
+			nvgCircle(vg, c.x, c.y, r);
+			paint = nvgRadialGradient(vg, c.x, c.y, iradius, oradius, ocol, icol);
+			nvgFillPaint(vg, paint);
+			nvgFill(vg);
+		});
 	}
 };
 typedef TRingLight<> RingLight;
@@ -506,6 +514,13 @@ struct DLXSvgLight : rack::widget::SvgWidget {
 };
 
 struct DLXKnobLight : DLXSvgLight {
+	SharedHaloCache haloCache;
+
+	// Length of the indicator line from the top edge
+	virtual float getIndicatorLength() {
+		return this->box.size.y / 2.f;
+	}
+
 	void drawHalo(const DrawArgs& args) override {
         // Don't draw halo if rendering in a framebuffer, e.g. screenshots or Module Browser
 		if (args.fb)
@@ -515,8 +530,6 @@ struct DLXKnobLight : DLXSvgLight {
 		if (halo == 0.f)
 			return;
 
-		nvgShapeAntiAlias(args.vg, false);
-
 		Vec c = this->box.size.div(2);
 
 		nvgGlobalAlpha(args.vg, 2.f/9.f);
@@ -527,35 +540,46 @@ struct DLXKnobLight : DLXSvgLight {
 		float x = c.x - oradius - radius * 0.5f;
 		float y = -oradius - radius;
 		float w = radius + oradius * 2.f;
-		float h = c.y + oradius * 2.f;
-		nvgBeginPath(args.vg);
-		nvgRoundedRect(args.vg, x - w, y - h, w * 3.f, h * 3.f, w * 1.5f);
-		NVGcolor icol = rack::color::mult(rack::componentlibrary::SCHEME_LIGHT_GRAY, halo);
-		NVGcolor ocol = nvgRGBA(0, 0, 0, 0);
-		NVGpaint paint = nvgBoxGradient(args.vg, x, y, w, h, w * 0.5f, w * 0.5, icol, ocol);
-		nvgFillPaint(args.vg, paint);
-		nvgFill(args.vg);
+		float h = getIndicatorLength() + oradius * 2.f;
 
 		// Outer halo
-		radius = c.x;
-		float iradius = RING_LIGHT_STROKEWIDTH + radius;
-		oradius = RING_LIGHT_STROKEWIDTH * 9.125f + radius;
-		nvgBeginPath(args.vg);
-		nvgRect(args.vg, c.x - oradius, c.y - oradius, 2 * (oradius), 2 * (oradius));
-		nvgCircle(args.vg, c.x, c.y, radius);
-		nvgPathWinding(args.vg, NVG_HOLE);
-		paint = nvgRadialGradient(args.vg, c.x, c.y, iradius, oradius, icol, ocol);
-		nvgFillPaint(args.vg, paint);
-		nvgFill(args.vg);
-
-		// Inner halo
-		iradius = -RING_LIGHT_STROKEWIDTH * 11.f + radius;
-		oradius = radius;
-		nvgBeginPath(args.vg);
-		nvgCircle(args.vg, c.x, c.y, radius);
-		paint = nvgRadialGradient(args.vg, c.x, c.y, iradius, oradius, ocol, icol);
-		nvgFillPaint(args.vg, paint);
-		nvgFill(args.vg);
+		float extent = RING_LIGHT_STROKEWIDTH * 9.125f + c.x;
+
+		// The indicator gradient reaches zero half a feather outside its box
+		rack::math::Rect bounds = rack::math::Rect(x - w * 0.25f, y - w * 0.25f, w * 1.5f, h + w * 0.5f);
+		bounds = bounds.expand(rack::math::Rect(c.x - extent, c.y - extent, extent * 2.f, extent * 2.f));
+
+		haloCache.drawHalo(args, typeid(*this), bounds, rack::color::mult(rack::componentlibrary::SCHEME_LIGHT_GRAY, halo), 0, [=](NVGcontext* vg, NVGcolor icol) {
+			nvgShapeAntiAlias(vg, false);
+
+			nvgBeginPath(vg);
+			nvgRoundedRect(vg, x - w, y - h, w * 3.f, h * 3.f, w * 1.5f);
+			NVGcolor ocol = nvgRGBA(0, 0, 0, 0);
+			NVGpaint paint = nvgBoxGradient(vg, x, y, w, h, w * 0.5f, w * 0.5f, icol, ocol);
+			nvgFillPaint(vg, paint);
+			nvgFill(vg);
+
+			// Outer halo
+			float radius = c.x;
+			float iradius = RING_LIGHT_STROKEWIDTH + radius;
+			float oradius = RING_LIGHT_STROKEWIDTH * 9.125f + radius;
+			nvgBeginPath(vg);
+			nvgRect(vg, c.x - oradius, c.y - oradius, 2 * (oradius), 2 * (oradius));
+			nvgCircle(vg, c.x, c.y, radius);
+			nvgPathWinding(vg, NVG_HOLE);
+			paint = nvgRadialGradient(vg, c.x, c.y, iradius, oradius, icol, ocol);
+			nvgFillPaint(vg, paint);
+			nvgFill(vg);
+
+			// Inner halo
+			iradius = -RING_LIGHT_STROKEWIDTH * 11.f + radius;
+			oradius = radius;
+			nvgBeginPath(vg);
+			nvgCircle(vg, c.x, c.y, radius);
+			paint = nvgRadialGradient(vg, c.x, c.y, iradius, oradius, ocol, icol);
+			nvgFillPaint(vg, paint);
+			nvgFill(vg);
+		});
 	}
 };
 
@@ -586,56 +610,8 @@ struct DLXDonutLargeKnobLight : DLXKnobLight {
 		setSvg(Svg::load(asset::plugin(pluginInstance, "res/DonutRoundHugeBlackKnob.svg")));
 	}
 
-	void drawHalo(const DrawArgs& args) override {
-        // Don't draw halo if rendering in a framebuffer, e.g. screenshots or Module Browser
-		if (args.fb)
-			return;
-
-		const float halo = rack::settings::haloBrightness;
-		if (halo == 0.f)
-			return;
-
-		nvgShapeAntiAlias(args.vg, false);
-
-		Vec c = this->box.size.div(2);
-
-		nvgGlobalAlpha(args.vg, 2.f/9.f);
-
-		// Indicator halo
-		float radius = LINE_LIGHT_STROKEWIDTH * 1.5f;
-		float oradius = radius * 1.5f;
-		float x = c.x - oradius - radius * 0.5f;
-		float y = -oradius - radius;
-		float w = radius + oradius * 2.f;
-		float h = (c.y * HOLE_RATIO) + oradius * 2.f;
-		nvgBeginPath(args.vg);
-		nvgRoundedRect(args.vg, x - w, y - h, w * 3.f, h * 3.f, w * 1.5f);
-		NVGcolor icol = rack::color::mult(rack::componentlibrary::SCHEME_LIGHT_GRAY, halo);
-		NVGcolor ocol = nvgRGBA(0, 0, 0, 0);
-		NVGpaint paint = nvgBoxGradient(args.vg, x, y, w, h, w * 0.5f, w * 0.5f, icol, ocol);
-		nvgFillPaint(args.vg, paint);
-		nvgFill(args.vg);
-
-		// Outer halo
-		radius = c.x;
-		float iradius = RING_LIGHT_STROKEWIDTH + radius;
-		oradius = RING_LIGHT_STROKEWIDTH * 9.125f + radius;
-		nvgBeginPath(args.vg);
-		nvgRect(args.vg, c.x - oradius, c.y - oradius, 2 * (oradius), 2 * (oradius));
-		nvgCircle(args.vg, c.x, c.y, radius);
-		nvgPathWinding(args.vg, NVG_HOLE);
-		paint = nvgRadialGradient(args.vg, c.x, c.y, iradius, oradius, icol, ocol);
-		nvgFillPaint(args.vg, paint);
-		nvgFill(args.vg);
-
-		// Inner halo
-		iradius = -RING_LIGHT_STROKEWIDTH * 11.f + radius;
-		oradius = radius;
-		nvgBeginPath(args.vg);
-		nvgCircle(args.vg, c.x, c.y, radius);
-		paint = nvgRadialGradient(args.vg, c.x, c.y, iradius, oradius, ocol, icol);
-		nvgFillPaint(args.vg, paint);
-		nvgFill(args.vg);
+	float getIndicatorLength() override {
+		return (this->box.size.y / 2.f) * HOLE_RATIO;
 	}
 };
 
@@ -699,10 +675,25 @@ struct DLXSmallLightKnob : DLXLightKnob<DLXSmallKnobLight> {
 };
 
 struct DLXSvgBloomLight : DLXSvgLight {
+	static const int NUM_CACHED_HALOS = 2;
+
 	std::shared_ptr<Svg> svgHalo;
+	int haloFrame = 0;
+	SharedHaloCache haloCache[NUM_CACHED_HALOS];	// [haloFrame], so toggling between frames doesn't re-render
 
-	void setHaloSvg(std::shared_ptr<Svg> svg) {
+	void setHaloSvg(std::shared_ptr<Svg> svg, int frame = 0) {
 		svgHalo = svg;
+		haloFrame = frame;
+	}
+
+	rack::math::Rect getHaloBounds() {
+		rack::math::Rect bounds = rack::math::Rect(Vec(0.f, 0.f), Vec(svgHalo->handle->width, svgHalo->handle->height));
+		for (NSVGshape* shape = svgHalo->handle->shapes; shape; shape = shape->next) {
+			float stroke = shape->strokeWidth * 0.5f;
+			bounds = bounds.expand(rack::math::Rect::fromMinMax(Vec(shape->bounds[0] - stroke, shape->bounds[1] - stroke),
+																Vec(shape->bounds[2] + stroke, shape->bounds[3] + stroke)));
+		}
+		return bounds;
 	}
 
 	void drawHalo(const DrawArgs& args) override {
@@ -714,8 +705,18 @@ struct DLXSvgBloomLight : DLXSvgLight {
 		if (halo == 0.f)
 			return;
 
+		if (!svgHalo)
+			return;
+
 		nvgAlpha(args.vg, halo);
-		rack::window::svgDraw(args.vg, svgHalo->handle);
+		if (haloFrame >= NUM_CACHED_HALOS) {
+			rack::window::svgDraw(args.vg, svgHalo->handle);
+			return;
+		}
+		std::shared_ptr<Svg> svg = svgHalo;
+		haloCache[haloFrame].drawHalo(args, typeid(*this), getHaloBounds(), nvgRGB(0xff, 0xff, 0xff), (uintptr_t) svg.get(), [=](NVGcontext* vg, NVGcolor icol) {
+			rack::window::svgDraw(vg, svg->handle);
+		});
 	}
 };
 
@@ -753,13 +754,19 @@ struct DLXSvgSwitchBloomLight : rack::app::SvgSwitch {
 		}
 	}
 
+	//The halo is drawn from the same SVG as the light, so each frame is looked up once and shared.
+	void addLightFrame(std::shared_ptr<Svg> svg) {
+		addFrame(svg);
+		addHaloFrame(svg);
+	}
+
 	void onChange(const ChangeEvent& e) override {
 		rack::engine::ParamQuantity* pq = getParamQuantity();
 		if (!frames.empty() && !haloFrames.empty() && pq) {
 			int index = (int) std::round(pq->getValue() - pq->getMinValue());
 			index = rack::math::clamp(index, 0, (int) frames.size() - 1);
 			light->setSvg(frames[index]);
-			light->setHaloSvg(haloFrames[index]);
+			light->setHaloSvg(haloFrames[index], index);
 			fb->dirty = true;
 		}
 		ParamWidget::onChange(e);
@@ -769,49 +776,39 @@ struct DLXSvgSwitchBloomLight : rack::app::SvgSwitch {
 struct DLXPencilButtonLight : DLXSvgSwitchBloomLight {
 	DLXPencilButtonLight() {
 		momentary = true;
-		addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_PencilButtonLight_0.svg")));
-		addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_PencilButtonLight_1.svg")));
-		addHaloFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_PencilButtonLight_0.svg")));
-		addHaloFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_PencilButtonLight_1.svg")));
+		addLightFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_PencilButtonLight_0.svg")));
+		addLightFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_PencilButtonLight_1.svg")));
 	}
 };
 
 struct DLXScreenButtonLight : DLXSvgSwitchBloomLight {
 	DLXScreenButtonLight() {
 		momentary = true;
-		addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_ScreenButtonLight_0.svg")));
-		addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_ScreenButtonLight_1.svg")));
-		addHaloFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_ScreenButtonLight_0.svg")));
-		addHaloFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_ScreenButtonLight_1.svg")));
+		addLightFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_ScreenButtonLight_0.svg")));
+		addLightFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_ScreenButtonLight_1.svg")));
 	}
 };
 
 struct DLX1ButtonLight : DLXSvgSwitchBloomLight {
 	DLX1ButtonLight() {
 		momentary = true;
-		addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_1b_light_0.svg")));
-		addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_1b_light_1.svg")));
-		addHaloFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_1b_light_0.svg")));
-		addHaloFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_1b_light_1.svg")));
+		addLightFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_1b_light_0.svg")));
+		addLightFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_1b_light_1.svg")));
 	}
 };
 
 struct DLX2ButtonLight : DLXSvgSwitchBloomLight {
 	DLX2ButtonLight() {
 		momentary = true;
-		addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_2b_light_0.svg")));
-		addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_2b_light_1.svg")));
-		addHaloFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_2b_light_0.svg")));
-		addHaloFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_2b_light_1.svg")));
+		addLightFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_2b_light_0.svg")));
+		addLightFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_2b_light_1.svg")));
 	}
 };
 
 struct DLX3ButtonLight : DLXSvgSwitchBloomLight {
 	DLX3ButtonLight() {
 		momentary = true;
-		addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_3b_light_0.svg")));
-		addFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_3b_light_1.svg")));
-		addHaloFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_3b_light_0.svg")));
-		addHaloFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_3b_light_1.svg")));
+		addLightFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_3b_light_0.svg")));
+		addLightFrame(APP->window->loadSvg(asset::plugin(pluginInstance, "res/DLX_3b_light_1.svg")));
 	}
 };
@@ -21,15 +21,12 @@ struct InitializeCurrentAlgorithmItem : MenuItem {
 		// History
 		InitializeCurrentAlgorithmAction<OPS, SCENES>* h = new InitializeCurrentAlgorithmAction<OPS, SCENES>;
 		h->moduleId = module->id;
-		h->scene = scene;
-		h->oldAlgoName = module->algoName[scene].to_ullong();
-		h->oldHorizontalMarks = module->horizontalMarks[scene].to_ullong();
-		h->oldForcedCarriers = module->forcedCarriers[scene].to_ullong();
-		h->oldOpsDisabled = module->opsDisabled[scene].to_ullong();
+		h->capture(module);
 
 		module->initializeAlgorithm(scene);
 		module->graphDirty = true;
 
+		h->commit(module);
 		APP->history->push(h);
 	};
 };
@@ -42,16 +39,13 @@ struct InitializeAllAlgorithmsItem : MenuItem {
 		// History
 		InitializeAllAlgorithmsAction<OPS, SCENES>* h = new InitializeAllAlgorithmsAction<OPS, SCENES>;
 		h->moduleId = module->id;
-		for (int scene = 0; scene < 3; scene++) {
-			h->oldAlgorithm[scene] = module->algoName[scene].to_ullong();
-			h->oldHorizontalMarks[scene] = module->horizontalMarks[scene].to_ullong();
-			h->oldForcedCarriers[scene] = module->forcedCarriers[scene].to_ullong();
-			h->oldOpsDisabled[scene] = module->opsDisabled[scene].to_ullong();
-			module->initializeAlgorithm(scene);
-		}
+		h->capture(module);
 
+		for (int scene = 0; scene < 3; scene++)
+			module->initializeAlgorithm(scene);
 		module->graphDirty = true;
 
+		h->commit(module);
 		APP->history->push(h);
 	};
 };
@@ -63,23 +57,15 @@ struct RandomizeCurrentAlgorithmItem : MenuItem {
     void onAction(const Action &e) override {
 		int scene = module->configMode ? module->configScene : module->centerMorphScene[0];
 
+		// History
 		RandomizeCurrentAlgorithmAction<OPS, SCENES>* h = new RandomizeCurrentAlgorithmAction<OPS, SCENES>();
 		h->moduleId = module->id;
-		h->scene = scene;
-
-		h->oldAlgoName = module->algoName[scene].to_ullong();
-		h->oldHorizontalMarks = module->horizontalMarks[scene].to_ullong();
-		h->oldOpsDisabled = module->opsDisabled[scene].to_ullong();
-		h->oldForcedCarriers = module->forcedCarriers[scene].to_ullong();
-		
-		module->randomizeAlgorithm(module->configMode ? module->configScene : module->centerMorphScene[0]);
-		module->graphDirty = true;
+		h->capture(module);
 
-		h->newAlgoName = module->algoName[scene].to_ullong();
-		h->newHorizontalMarks = module->horizontalMarks[scene].to_ullong();
-		h->newOpsDisabled = module->opsDisabled[scene].to_ullong();
-		h->newForcedCarriers = module->forcedCarriers[scene].to_ullong();
+		module->randomizeAlgorithm(scene);
+		module->graphDirty = true;
 
+		h->commit(module);
 		APP->history->push(h);
 	};
 };
@@ -92,25 +78,13 @@ struct RandomizeAllAlgorithmsItem : MenuItem {
 		// History
 		RandomizeAllAlgorithmsAction<OPS, SCENES>* h = new RandomizeAllAlgorithmsAction<OPS, SCENES>();
 		h->moduleId = module->id;
-		for (int scene = 0; scene < 3; scene++) {
-			h->oldAlgorithm[scene] = module->algoName[scene].to_ullong();
-			h->oldHorizontalMarks[scene] = module->horizontalMarks[scene].to_ullong();
-			h->oldOpsDisabled[scene] = module->opsDisabled[scene].to_ullong();
-			h->oldForcedCarriers[scene] = module->forcedCarriers[scene].to_ullong();
-			module->randomizeAlgorithm(scene);
-		}
+		h->capture(module);
 
 		for (int scene = 0; scene < 3; scene++)
 			module->randomizeAlgorithm(scene);
 		module->graphDirty = true;
 
-		for (int scene = 0; scene < 3; scene++) {
-			h->newAlgorithm[scene] = module->algoName[scene].to_ullong();
-			h->newHorizontalMarks[scene] = module->horizontalMarks[scene].to_ullong();
-			h->newOpsDisabled[scene] = module->opsDisabled[scene].to_ullong();
-			h->newForcedCarriers[scene] = module->forcedCarriers[scene].to_ullong();
-		}
-
+		h->commit(module);
 		APP->history->push(h);
 	};
 };
@@ -145,36 +119,66 @@ struct Line {
 	};
 };
 
+// ConnectionBgWidget Structure
+// The unlit connection lines never change, so they are rendered once into a framebuffer and redrawn only when
+// the widget is resized or the rack zoom changes (FramebufferWidget handles the latter by itself).
+// The widget itself stays on top for the context menu.
+
 template < int OPS = 4, int SCENES = 3 >
 struct ConnectionBgWidget : rack::widget::OpaqueWidget {
+	struct LinesDrawWidget : rack::widget::TransparentWidget {
+		std::vector<Line> lines;
+		Vec offset;
+
+		void draw(const Widget::DrawArgs& args) override {
+			//Colors from rack::GrayModuleLightWidget
+			for (const Line& line : lines) {
+				nvgBeginPath(args.vg);
+				nvgMoveTo(args.vg, line.left.x - offset.x, line.left.y - offset.y);
+				nvgLineTo(args.vg, line.right.x - offset.x, line.right.y - offset.y);
+				nvgStrokeWidth(args.vg, 1.1f);
+				// Background
+				nvgStrokeColor(args.vg, nvgRGB(0x5a, 0x5a, 0x5a));
+				nvgStroke(args.vg);
+				// Border
+				nvgStrokeWidth(args.vg, 0.6);
+				nvgStrokeColor(args.vg, nvgRGBA(0, 0, 0, 0x60));
+				nvgStroke(args.vg);
+			}
+		};
+	};
+
+	// Room around the box for stroke width and antialiasing, since lines run along its edges
+	static constexpr float MARGIN = 2.f;
+
 	Algomorph<OPS, SCENES>* module;
-	std::vector<Line> lines;
+	rack::widget::FramebufferWidget* fb;
+	LinesDrawWidget* w;
+	rack::math::Rect cachedBox;
 
 	ConnectionBgWidget(std::vector<Vec> left, std::vector<Vec> right, Algomorph<OPS, SCENES>* module) {
 		this->module = module;	
+		fb = new rack::widget::FramebufferWidget;
+		addChild(fb);
+		w = new LinesDrawWidget;
+		fb->addChild(w);
 		for (unsigned i = 0; i < left.size(); i++) {
 			for (unsigned j = 0; j < right.size(); j++) {
-				lines.push_back(Line(left[i], right[j]));
+				w->lines.push_back(Line(left[i], right[j]));
 			}
 		}
 	};
-	void draw(const Widget::DrawArgs& args) override {
-		//Colors from rack::GrayModuleLightWidget
-		for (Line line : lines) {
-			nvgBeginPath(args.vg);
-			nvgMoveTo(args.vg, line.left.x - box.pos.x, line.left.y - box.pos.y);
-			nvgLineTo(args.vg, line.right.x - box.pos.x, line.right.y - box.pos.y);
-			nvgStrokeWidth(args.vg, 1.1f);
-			// Background
-			nvgStrokeColor(args.vg, nvgRGB(0x5a, 0x5a, 0x5a));
-			nvgStroke(args.vg);
-			// Border
-			nvgStrokeWidth(args.vg, 0.6);
-			nvgStrokeColor(args.vg, nvgRGBA(0, 0, 0, 0x60));
-			nvgStroke(args.vg);
-		}
 
-		OpaqueWidget::draw(args);
+	void step() override {
+		if (!box.equals(cachedBox)) {
+			fb->box.pos = Vec(-MARGIN, -MARGIN);
+			fb->box.size = box.size.plus(Vec(MARGIN * 2.f, MARGIN * 2.f));
+			w->box.size = fb->box.size;
+			w->offset = box.pos.minus(Vec(MARGIN, MARGIN));
+			fb->dirty = true;
+			cachedBox = box;
+		}
+		OpaqueWidget::step();
 	};
 
 	void onButton(const rack::event::Button& e) override {
@@ -0,0 +1,162 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+
+// Profiled sections of Algomorph::process()
+
+struct DebugSections {
+	static const int AUX = 0;
+	static const int CV = 1;
+	static const int ROUTING = 2;
+	static const int LIGHTS = 3;
+	static const int NUM_SECTIONS = 4;
+};
+
+//Order must match above
+static const std::string DebugSectionLabels[DebugSections::NUM_SECTIONS] = {	"AUX & morph",
+																				"CV & buttons",
+																				"Routing",
+																				"Lights"	};
+
+
+// DebugResults Structure
+// One published window of DebugStats, which the UI reads.
+
+struct DebugResults {
+    float meanNs[DebugSections::NUM_SECTIONS] = {0.f};        // Average cost per sample
+    float peakNs[DebugSections::NUM_SECTIONS] = {0.f};        // Most expensive timed sample
+    float totalMeanNs = 0.f;
+    float totalPeakNs = 0.f;
+    float load = 0.f;                                         // Average share of the sample period, 0..1
+    long morphWraps = 0;
+    long sceneChanges = 0;
+    long clickFilterRearms = 0;
+    long windows = 0;
+};
+
+
+// DebugStats Structure
+// Only touched while the module's debug flag is set. Reading the clock costs about as much as a section, so only one
+// frame in TIMED_FRAME_INTERVAL is timed; the counters see every frame. The audio thread accumulates one window
+// (about a second), then fills the results buffer the UI isn't pointed at and flips `published` to it.
+
+struct DebugStats {
+    static const int TIMED_FRAME_INTERVAL = 17;              // Odd, so timed frames visit every phase of the power-of-two blocks and dividers
+
+    // Published results, double-buffered
+    DebugResults results[2];
+    std::atomic<int> published {0};
+
+    // Counters, published with each window
+    long morphWraps = 0;
+    long sceneChanges = 0;
+    long clickFilterRearms = 0;
+
+    // Accumulators
+    int64_t frameNs[DebugSections::NUM_SECTIONS] = {0};
+    int64_t windowNs[DebugSections::NUM_SECTIONS] = {0};
+    int64_t windowPeakNs[DebugSections::NUM_SECTIONS] = {0};
+    int64_t windowTotalNs = 0;
+    int64_t windowTotalPeakNs = 0;
+    int windowFrames = 0;
+    int windowTimedFrames = 0;
+    int untimedFrames = 0;
+    bool timing = false;                                     // This frame is timed
+    int lastScene = -1;
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    const DebugResults& read() const {
+        return results[published.load(std::memory_order_acquire)];
+    }
+
+    // Returns the frame's start time, for add() and endFrame(), or 0 if this frame isn't timed
+    int64_t startFrame() {
+        timing = ++untimedFrames >= TIMED_FRAME_INTERVAL;
+        if (!timing)
+            return 0;
+        untimedFrames = 0;
+        return now();
+    }
+
+    // Charges the time since `start` to `section`, and returns the current time so calls can be chained
+    int64_t add(int section, int64_t start) {
+        if (!timing)
+            return start;
+        int64_t t = now();
+        frameNs[section] += t - start;
+        return t;
+    }
+
+    void countScene(int scene) {
+        if (lastScene > -1 && scene != lastScene)
+            sceneChanges++;
+        lastScene = scene;
+    }
+
+    void endFrame(int64_t frameStart, float sampleRate) {
+        if (timing) {
+            int64_t total = now() - frameStart;
+            windowTotalNs += total;
+            if (total > windowTotalPeakNs)
+                windowTotalPeakNs = total;
+            for (int i = 0; i < DebugSections::NUM_SECTIONS; i++) {
+                windowNs[i] += frameNs[i];
+                if (frameNs[i] > windowPeakNs[i])
+                    windowPeakNs[i] = frameNs[i];
+                frameNs[i] = 0;
+            }
+            windowTimedFrames++;
+        }
+
+        if (++windowFrames >= sampleRate && windowTimedFrames > 0) {
+            int next = 1 - published.load(std::memory_order_relaxed);
+            DebugResults& out = results[next];
+            for (int i = 0; i < DebugSections::NUM_SECTIONS; i++) {
+                out.meanNs[i] = (float) windowNs[i] / windowTimedFrames;
+                out.peakNs[i] = windowPeakNs[i];
+                windowNs[i] = 0;
+                windowPeakNs[i] = 0;
+            }
+            out.totalMeanNs = (float) windowTotalNs / windowTimedFrames;
+            out.totalPeakNs = windowTotalPeakNs;
+            out.load = out.totalMeanNs * sampleRate * 1e-9f;
+            out.morphWraps = morphWraps;
+            out.sceneChanges = sceneChanges;
+            out.clickFilterRearms = clickFilterRearms;
+            out.windows = results[1 - next].windows + 1;
+            published.store(next, std::memory_order_release);
+            windowTotalNs = 0;
+            windowTotalPeakNs = 0;
+            windowFrames = 0;
+            windowTimedFrames = 0;
+        }
+    }
+
+    // Only while the audio thread leaves the stats alone, with the debug flag clear
+    void reset() {
+        results[0] = DebugResults();
+        results[1] = DebugResults();
+        published.store(0, std::memory_order_release);
+        morphWraps = 0;
+        sceneChanges = 0;
+        clickFilterRearms = 0;
+        for (int i = 0; i < DebugSections::NUM_SECTIONS; i++) {
+            frameNs[i] = 0;
+            windowNs[i] = 0;
+            windowPeakNs[i] = 0;
+        }
+        windowTotalNs = 0;
+        windowTotalPeakNs = 0;
+        windowFrames = 0;
+        windowTimedFrames = 0;
+        untimedFrames = 0;
+        timing = false;
+        lastScene = -1;
+    }
+};
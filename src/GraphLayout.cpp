@@ -0,0 +1,223 @@
+#include "GraphLayout.hpp"
+#include "plugin.hpp" // For backgroundWorker
+#include <algorithm>
+#include <climits>
+
+using rack::math::Vec;
+
+
+// Distance from p to the segment ab
+static float segmentDistance(Vec p, Vec a, Vec b) {
+    Vec ab = b.minus(a);
+    float lengthSquared = ab.dot(ab);
+    float t = lengthSquared > 0.f ? rack::math::clamp(p.minus(a).dot(ab) / lengthSquared, 0.f, 1.f) : 0.f;
+    return p.minus(a.plus(ab.mult(t))).norm();
+}
+
+Vec GraphLayout::getSize() {
+    return rack::window::mm2px(Vec(38.295f, 31.590f));
+}
+
+alGraph GraphLayout::build(int algoName, int forcedCarriers) {
+    alGraph graph;
+    Vec size = getSize();
+    Vec center = size.div(2.f);
+
+    bool visible[OPS];
+    int order[OPS];
+    int n = 0;
+    for (int op = 0; op < OPS; op++) {
+        visible[op] = !((algoName >> (12 + op)) & 1);
+        if (visible[op])
+            order[n++] = op;
+    }
+    bool connected[OPS][OPS] = {{false}};
+    for (int op = 0; op < OPS; op++) {
+        for (int rel = 0; rel < OPS - 1; rel++) {
+            int mod = rel < op ? rel : rel + 1;
+            if (((algoName >> (op * (OPS - 1) + rel)) & 1) && visible[op] && visible[mod])
+                connected[op][mod] = true;
+        }
+    }
+
+    // Top to bottom order with the fewest upward edges, then with forced carriers as low as possible
+    int best[OPS];
+    int bestScore = INT_MAX;
+    do {
+        int position[OPS];
+        for (int i = 0; i < n; i++)
+            position[order[i]] = i;
+        int score = 0;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (connected[order[i]][order[j]] && i > j)
+                    score += 100;
+            }
+            if ((forcedCarriers >> order[i]) & 1)
+                score += n - 1 - position[order[i]];
+        }
+        if (score < bestScore) {
+            bestScore = score;
+            std::copy(order, order + n, best);
+        }
+    } while (std::next_permutation(order, order + n));
+
+    // Rank by longest downward path, so carriers end up on the bottom row
+    int depth[OPS] = {0};
+    int maxDepth = 0;
+    for (int i = n - 1; i >= 0; i--) {
+        for (int j = i + 1; j < n; j++) {
+            if (connected[best[i]][best[j]])
+                depth[best[i]] = std::max(depth[best[i]], depth[best[j]] + 1);
+        }
+        maxDepth = std::max(maxDepth, depth[best[i]]);
+    }
+
+    // Place rows bottom up, each node under the mean of what it modulates in the rows below
+    float rowSpacing = ROW_SPACING;
+    if (maxDepth > 0)
+        rowSpacing = std::min(rowSpacing, (size.y - 2.f * MARGIN) / maxDepth);
+    Vec coords[OPS];
+    for (int d = 0; d <= maxDepth; d++) {
+        int row[OPS];
+        float key[OPS];
+        int count = 0;
+        for (int op = 0; op < OPS; op++) {
+            if (!visible[op] || depth[op] != d)
+                continue;
+            float sum = 0.f;
+            int targets = 0;
+            for (int mod = 0; mod < OPS; mod++) {
+                if (connected[op][mod] && depth[mod] < d) {
+                    sum += coords[mod].x;
+                    targets++;
+                }
+            }
+            key[op] = targets > 0 ? sum / targets : center.x;
+            row[count++] = op;
+        }
+        std::stable_sort(row, row + count, [&](int a, int b) {
+            return key[a] < key[b];
+        });
+
+        float columnSpacing = COLUMN_SPACING;
+        if (count > 1)
+            columnSpacing = std::min(columnSpacing, (size.x - 2.f * MARGIN) / (count - 1));
+        for (int i = 0; i < count; i++)
+            coords[row[i]] = Vec(center.x + (i - (count - 1) / 2.f) * columnSpacing, center.y + (maxDepth / 2.f - d) * rowSpacing);
+    }
+
+    for (int op = 0; op < OPS; op++) {
+        graph.nodes[op].id = visible[op] ? op + 1 : 404;
+        if (visible[op]) {
+            graph.nodes[op].coords = coords[op];
+            graph.numNodes++;
+        }
+    }
+
+    for (int op = 0; op < OPS; op++) {
+        for (int mod = 0; mod < OPS; mod++) {
+            if (!connected[op][mod])
+                continue;
+            Vec p = coords[op];
+            Vec q = coords[mod];
+
+            // Straight down unless that would cross another node
+            bool straight = depth[op] > depth[mod];
+            for (int other = 0; other < OPS && straight; other++) {
+                if (visible[other] && other != op && other != mod && segmentDistance(coords[other], p, q) < RADIUS * 1.2f)
+                    straight = false;
+            }
+            Vec offset;
+            if (!straight) {
+                Vec direction = q.minus(p).normalize();
+                Vec normal = Vec(-direction.y, direction.x);
+                float side = p.plus(q).div(2.f).minus(center).dot(normal) >= 0.f ? 1.f : -1.f;
+                // Bend the two directions of a pair to opposite sides
+                if (connected[mod][op] && op > mod)
+                    side = -side;
+                offset = normal.mult(side * BEND);
+            }
+            Vec control1 = p.plus(q.minus(p).div(3.f)).plus(offset);
+            Vec control2 = p.plus(q.minus(p).mult(2.f / 3.f)).plus(offset);
+
+            Vec start = p.plus(control1.minus(p).normalize().mult(RADIUS));
+            Vec tip = q.plus(control2.minus(q).normalize().mult(RADIUS));
+            Vec direction = tip.minus(control2).normalize();
+            Vec end = tip.minus(direction.mult(ARROW_LENGTH));
+
+            Edge& edge = graph.edges[graph.numEdges];
+            edge.moveCoords = start;
+            edge.curve[0][0] = control1;
+            edge.curve[0][1] = control2;
+            edge.curve[0][2] = end;
+            edge.curveLength = 1;
+
+            Arrow& arrow = graph.arrows[graph.numEdges];
+            Vec normal = Vec(-direction.y, direction.x).mult(ARROW_WIDTH / 2.f);
+            arrow.moveCoords = tip;
+            arrow.lines[0] = end.plus(normal);
+            arrow.lines[1] = end.minus(normal);
+            for (int j = 2; j < 9; j++)
+                arrow.lines[j] = tip;
+
+            graph.numEdges++;
+        }
+    }
+
+    return graph;
+}
+
+GraphLayoutCache::Entry* GraphLayoutCache::find(int key) {
+    Entry* oldest = &entries[0];
+    for (Entry& entry : entries) {
+        if (entry.key == key)
+            return &entry;
+        if (entry.lastUse < oldest->lastUse)
+            oldest = &entry;
+    }
+    return oldest;
+}
+
+// Takes in the layouts warm() had built
+void GraphLayoutCache::collect() {
+    while (!built.empty()) {
+        Entry ready = built.shift();
+        Entry* entry = find(ready.key);
+        if (entry->key != ready.key) {
+            *entry = ready;
+            entry->lastUse = ++clock;
+        }
+    }
+}
+
+const alGraph& GraphLayoutCache::get(int algoName, int forcedCarriers) {
+    collect();
+    int key = getKey(algoName, forcedCarriers);
+    Entry* entry = find(key);
+    if (entry->key != key) {
+        entry->key = key;
+        entry->graph = GraphLayout::build(algoName, forcedCarriers);
+    }
+    entry->lastUse = ++clock;
+    return entry->graph;
+}
+
+void GraphLayoutCache::warm(int algoName, int forcedCarriers) {
+    collect();
+    int key = getKey(algoName, forcedCarriers);
+    if (find(key)->key == key)
+        return;
+    backgroundWorker.submit([this, key, algoName, forcedCarriers] {
+        Entry entry;
+        entry.key = key;
+        entry.graph = GraphLayout::build(algoName, forcedCarriers);
+        if (!built.full())
+            built.push(entry);
+    });
+}
+
+GraphLayoutCache& GraphLayoutCache::shared() {
+    static GraphLayoutCache cache;
+    return cache;
+}
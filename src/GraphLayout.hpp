@@ -0,0 +1,63 @@
+#pragma once
+#include "GraphStructure.hpp"
+#include <rack.hpp>
+
+
+// GraphLayout Structure
+// Lays out any 4-op display algorithm as an alGraph, for the states GRAPH_DATA has no entry for (those without a
+// natural carrier). Takes the same 16-bit display name the module pushes to the display: bits op * 3 + relative mod
+// for connections, bits 12 + op for operators hidden by being disabled and unmodulated.
+// Layered layout: operators are put in the order with the fewest upward edges (forced carriers preferring the bottom),
+// ranked by their longest downward path, and spread out row by row under their modulators. Downward edges are straight,
+// everything else is a single bezier bent around the nodes in between.
+// Results go in a small shared cache keyed by name and forced carriers, read on the UI thread only, so drawing a
+// computed layout costs the same as drawing a table graph. warm() has the plugin's background worker build a layout
+// ahead of time and hand it back through a ring, which the UI thread collects before its next lookup.
+
+struct GraphLayout {
+    static constexpr int OPS = 4;
+    static constexpr float RADIUS = 8.35425f;       // Node radius, as drawn by the display
+    static constexpr float ROW_SPACING = 2.8f * RADIUS;
+    static constexpr float COLUMN_SPACING = 3.2f * RADIUS;
+    static constexpr float MARGIN = RADIUS + 2.f;
+    static constexpr float BEND = 1.4f * RADIUS;
+    static constexpr float ARROW_LENGTH = 4.5f;
+    static constexpr float ARROW_WIDTH = 3.5f;
+
+    static alGraph build(int algoName, int forcedCarriers);
+
+    // Where the table graphs are laid out: the display on both modules
+    static rack::math::Vec getSize();
+};
+
+struct GraphLayoutCache {
+    static constexpr int SIZE = 32;
+
+    struct Entry {
+        int key = -1;
+        unsigned lastUse = 0;
+        alGraph graph;
+    };
+
+    Entry entries[SIZE];
+    unsigned clock = 0;
+    rack::dsp::RingBuffer<Entry, 8> built;          // From the background worker to the UI thread
+
+    // Key for a computed layout, distinct from table graph ids
+    static int getKey(int algoName, int forcedCarriers) {
+        return 0x100000 | (forcedCarriers << 16) | algoName;
+    }
+
+    // The entry for key, or else the least recently used one
+    Entry* find(int key);
+    void collect();
+
+    // Builds on a miss, replacing the least recently used entry
+    const alGraph& get(int algoName, int forcedCarriers);
+
+    // Builds in the background unless cached. A full ring drops the layout, and get() builds it instead
+    void warm(int algoName, int forcedCarriers);
+
+    // One cache for every display, which are all drawn on the UI thread
+    static GraphLayoutCache& shared();
+};
@@ -27,8 +27,8 @@ struct Arrow {
 
 struct alGraph {
     Node nodes[4];
-    Edge edges[9];
-    Arrow arrows[9];
+    Edge edges[12];         // Table graphs have at most 9, computed layouts (see GraphLayout) up to 12
+    Arrow arrows[12];
     int numEdges = 0;
     int numNodes = 0;
     bool mystery = false;
@@ -0,0 +1,116 @@
+#pragma once
+#include <rack.hpp>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <typeindex>
+
+
+// HaloCache Structure
+// Renders a halo once, in white at full strength, into a framebuffer at the current zoom. Every frame it is then
+// composited as a single textured rect tinted with the light's color, instead of rebuilding its paths and gradients.
+// The tint multiplies the premultiplied texture, so the result matches drawing the gradients in that color.
+// Re-renders only when the zoom, the bounds or the caller's key (e.g. an SVG frame) changes.
+// Lives outside the widget tree, shared through SharedHaloCache by every light that draws the same halo.
+// Shapes take the color to draw in: white when cached, or the tint itself when drawn directly.
+
+struct HaloCache : rack::widget::FramebufferWidget {
+    rack::math::Rect bounds;                        // Halo extent, in the light's local coordinates
+    float scale = 0.f;                              // Zoom the framebuffer was rendered at
+    int key = -1;
+    std::function<void(NVGcontext*, NVGcolor)> drawShape;  // Draws the halo in the given color, in local coordinates
+
+    // Draw every shape straight into the frame instead, for headless tools that have no window to render with
+    static bool& direct() {
+        static bool d = false;
+        return d;
+    }
+
+    void drawFramebuffer() override {
+        NVGcontext* vg = APP->window->fbVg;
+        nvgTranslate(vg, -bounds.pos.x, -bounds.pos.y);
+        if (drawShape)
+            drawShape(vg, nvgRGB(0xff, 0xff, 0xff));
+    }
+
+    template <typename TShape>
+    void drawHalo(const rack::widget::Widget::DrawArgs& args, rack::math::Rect haloBounds, NVGcolor tint, int haloKey, TShape shape) {
+        if (direct()) {
+            shape(args.vg, tint);
+            return;
+        }
+
+        float t[6];
+        nvgCurrentTransform(args.vg, t);
+        float s = std::hypot(t[0], t[1]);
+        if (s <= 0.f)
+            return;
+
+        if (s != scale || haloKey != key || !haloBounds.equals(bounds) || !getFramebuffer()) {
+            bounds = haloBounds;
+            box.size = bounds.size;
+            scale = s;
+            key = haloKey;
+            drawShape = shape;
+            render(rack::math::Vec(s, s));
+        }
+
+        NVGLUframebuffer* fb = getFramebuffer();
+        if (!fb)
+            return;
+
+        // The framebuffer covers the bounds rounded up to whole pixels
+        rack::math::Vec size = bounds.size.mult(scale).ceil().div(scale);
+        nvgBeginPath(args.vg);
+        nvgRect(args.vg, bounds.pos.x, bounds.pos.y, size.x, size.y);
+        NVGpaint paint = nvgImagePattern(args.vg, bounds.pos.x, bounds.pos.y, size.x, size.y, 0.f, fb->image, 1.f);
+        paint.innerColor = tint;
+        paint.outerColor = tint;
+        nvgFillPaint(args.vg, paint);
+        nvgFill(args.vg);
+    }
+};
+
+// SharedHaloCache Structure
+// Lights of one type drawing a halo of the same bounds and key draw the same image, so they share one HaloCache,
+// looked up by type, bounds and key (e.g. an SVG frame). Each light keeps the cache it uses alive, and the registry only
+// holds weak references, so a halo's framebuffer goes away with the last light drawing it.
+
+struct SharedHaloCache {
+    typedef std::tuple<std::type_index, float, float, float, float, uintptr_t> Key;
+
+    std::shared_ptr<HaloCache> cache;
+    std::type_index type = typeid(void);
+    rack::math::Rect bounds;
+    uintptr_t key = 0;
+
+    static std::shared_ptr<HaloCache> get(const Key& key) {
+        static std::map<Key, std::weak_ptr<HaloCache>> caches;
+        std::shared_ptr<HaloCache> cache = caches[key].lock();
+        if (!cache) {
+            for (auto it = caches.begin(); it != caches.end();)
+                it = it->second.expired() ? caches.erase(it) : std::next(it);
+            cache = std::make_shared<HaloCache>();
+            caches[key] = cache;
+        }
+        return cache;
+    }
+
+    template <typename TShape>
+    void drawHalo(const rack::widget::Widget::DrawArgs& args, std::type_index haloType, rack::math::Rect haloBounds, NVGcolor tint, uintptr_t haloKey, TShape shape) {
+        if (HaloCache::direct()) {
+            shape(args.vg, tint);
+            return;
+        }
+        if (!cache || haloType != type || haloKey != key || !haloBounds.equals(bounds)) {
+            type = haloType;
+            bounds = haloBounds;
+            key = haloKey;
+            cache = get(Key(type, bounds.pos.x, bounds.pos.y, bounds.size.x, bounds.size.y, key));
+        }
+        cache->drawHalo(args, bounds, tint, 0, shape);
+    }
+};
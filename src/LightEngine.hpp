@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <rack.hpp>
+
+
+// Panel lights driven by the light engine. Both Algomorphs share this LightIds order up to EDIT_LIGHT;
+// the screen button ring is placed after it here and mapped back to its real ID on write.
+
+struct LightSlots {
+	static const int DISPLAY_BACKLIGHT = 0;             // 3 colors
+	static const int SCENE_LIGHTS = 3;                  // 3 colors per light
+	static const int SCENE_INDICATORS = 12;             // 3 colors per light
+	static const int H_CONNECTION_LIGHTS = 21;          // 3 colors per light
+	static const int D_DISABLE_LIGHTS = 33;
+	static const int CONNECTION_LIGHTS = 45;            // 3 colors per light
+	static const int OPERATOR_LIGHTS = 81;              // 3 colors per light
+	static const int CARRIER_INDICATORS = 93;           // 3 colors per light
+	static const int MODULATOR_LIGHTS = 105;            // 3 colors per light
+	static const int EDIT_LIGHT = 117;
+	static const int SCREEN_BUTTON_RING_LIGHT = 118;    // 3 colors
+	static const int NUM_SLOTS = 121;
+	static const int NUM_PADDED_SLOTS = 124;            // Rounded up to whole float_4s
+};
+
+// Port brightnesses a light can follow
+struct LightVuSources {
+	static const int NONE = 0;                          // Always 0
+	static const int OPERATOR_INPUTS = 1;
+	static const int MODULATOR_OUTPUTS = 5;
+	static const int CARRIER_SUM_OUTPUT = 9;
+	static const int NUM_SOURCES = 10;
+};
+
+// Everything the light targets depend on, apart from morph amount and port brightness.
+// Compared as raw memory, so keep every field 4 bytes wide.
+struct LightState {
+    int32_t configMode = -1;
+    int32_t modeB = 0;
+    int32_t configScene = 0;
+    int32_t configOp = 0;
+    int32_t blinkStatus = 0;
+    int32_t indicatedScene = 0;
+    int32_t centerScene = 0;
+    int32_t forwardScene = 0;
+    float screenButton = 0.f;
+    uint32_t algoName[3] = {0};
+    uint32_t horizontalMarks[3] = {0};
+    uint32_t forcedCarriers[3] = {0};
+};
+
+
+// LightEngine Structure
+// Each light's target is base + gain * vu[source], crossfaded between two tables (center and forward morph scene)
+// by the morph amount. The tables are rebuilt only when the LightState changes; every light tick is then a single
+// pass over flat arrays indexed by slot, smoothing with the same fall rate as Light::setBrightnessSmooth().
+
+struct LightEngine {
+    float base[2][LightSlots::NUM_PADDED_SLOTS] = {{0.f}};        // [table][slot]
+    float gain[2][LightSlots::NUM_PADDED_SLOTS] = {{0.f}};        // [table][slot]
+    int source[LightSlots::NUM_PADDED_SLOTS] = {0};               // [slot], shared by both tables
+    float value[LightSlots::NUM_PADDED_SLOTS] = {0.f};            // [slot], smoothed brightness
+    LightState state;
+    bool snap = false;                                            // Jump straight to the targets on the next pass
+
+    // Forces a rebuild and a jump to the new targets, e.g. after the panel was hidden
+    void resync() {
+        state.configMode = -1;
+        snap = true;
+    }
+
+    // Returns true if the tables need rebuilding
+    bool setState(const LightState& newState) {
+        if (!std::memcmp(&state, &newState, sizeof(LightState)))
+            return false;
+        state = newState;
+        return true;
+    }
+
+    void clear() {
+        std::memset(base, 0, sizeof(base));
+        std::memset(gain, 0, sizeof(gain));
+        std::memset(source, 0, sizeof(source));
+    }
+
+    void set(int table, int slot, float brightness) {
+        base[table][slot] = brightness;
+    }
+
+    void follow(int table, int slot, int vuSource, float vuGain = 1.f, float brightness = 0.f) {
+        base[table][slot] = brightness;
+        gain[table][slot] = vuGain;
+        source[slot] = vuSource;
+    }
+
+    // `lights` is the module's light array; `ringLightId` is its SCREEN_BUTTON_RING_LIGHT
+    void process(const float* vu, float morph, float deltaTime, rack::engine::Light* lights, int ringLightId) {
+        using rack::simd::float_4;
+        float_4 fall = 30.f * deltaTime;
+        for (int i = 0; i < LightSlots::NUM_PADDED_SLOTS; i += 4) {
+            float_4 vuSlot(vu[source[i]], vu[source[i + 1]], vu[source[i + 2]], vu[source[i + 3]]);
+            float_4 a = float_4::load(&base[0][i]) + float_4::load(&gain[0][i]) * vuSlot;
+            float_4 b = float_4::load(&base[1][i]) + float_4::load(&gain[1][i]) * vuSlot;
+            float_4 target = a + (b - a) * morph;
+            float_4 v = float_4::load(&value[i]);
+            v = rack::simd::ifelse(target < v, v + (target - v) * fall, target);
+            v.store(&value[i]);
+        }
+        if (snap) {
+            // Recompute instead of branching in the loop above, which only happens once per resync
+            for (int i = 0; i < LightSlots::NUM_PADDED_SLOTS; i++) {
+                float a = base[0][i] + gain[0][i] * vu[source[i]];
+                float b = base[1][i] + gain[1][i] * vu[source[i]];
+                value[i] = a + (b - a) * morph;
+            }
+            snap = false;
+        }
+
+        for (int i = 0; i < LightSlots::SCREEN_BUTTON_RING_LIGHT; i++)
+            lights[i].value = value[i];
+        for (int i = 0; i < 3; i++)
+            lights[ringLightId + i].value = value[LightSlots::SCREEN_BUTTON_RING_LIGHT + i];
+    }
+};
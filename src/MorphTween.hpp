@@ -0,0 +1,137 @@
+#pragma once
+#include "GraphStructure.hpp"
+#include <rack.hpp>
+#include <algorithm>
+
+
+// MorphTween Structure
+// Lines up every point the display draws for a pair of graphs: nodes, bezier control points and arrow vertices,
+// from the scene graph (morph 0) to the morph scene graph (morph 1). Whatever one graph has and the other lacks
+// is paired with the display origin, or with the other graph's last curve segment or edge, so both lists are
+// equal length. build() runs on a graph pair or origin change; lerp() is then a single pass over flat buffers.
+
+struct MorphTween {
+    static constexpr int MAX_NODES = 4;
+    static constexpr int MAX_EDGES = 12;
+    static constexpr int MAX_SEGMENTS = 15;
+    static constexpr int ARROW_POINTS = 10;
+    static constexpr int MAX_POINTS = MAX_NODES + MAX_EDGES * (1 + MAX_SEGMENTS * 3) + MAX_EDGES * ARROW_POINTS;
+    static constexpr int MAX_FLOATS = (MAX_POINTS * 2 + 3) / 4 * 4;     // Rounded up to whole float_4s
+
+    alignas(16) float from[MAX_FLOATS] = {0.f};     // x, y pairs at morph 0
+    alignas(16) float to[MAX_FLOATS] = {0.f};       // x, y pairs at morph 1
+    alignas(16) float points[MAX_FLOATS] = {0.f};   // x, y pairs at the current morph
+    int numFloats = 0;
+
+    bool nodeDrawn[MAX_NODES] = {false};
+    float nodeAlpha[MAX_NODES][2] = {{0.f}};        // [op][end], 1 where the node exists
+    Vec nodeCoords[MAX_NODES];                      // An end where the node exists, for text metrics
+
+    int numEdges = 0;
+    int edgeStart[MAX_EDGES] = {0};                 // Point index of the moveTo, followed by 3 points per segment
+    int edgeSegments[MAX_EDGES] = {0};
+    float edgeAlpha[MAX_EDGES][2] = {{0.f}};        // [edge][end], 1 where the edge exists
+    int arrowStart[MAX_EDGES] = {0};                // Point index of the moveTo, followed by 9 lineTos
+
+    // What the buffers were built for
+    int sceneKey = -1;
+    int morphKey = -1;
+    Vec origin;
+
+    // Call when a graph changes under the same key
+    void invalidate() {
+        sceneKey = -1;
+    }
+
+    bool needsBuild(int newSceneKey, int newMorphKey, Vec newOrigin) {
+        return newSceneKey != sceneKey || newMorphKey != morphKey || !newOrigin.equals(origin);
+    }
+
+    void build(const alGraph& scene, const alGraph& morph, int newSceneKey, int newMorphKey, Vec newOrigin) {
+        sceneKey = newSceneKey;
+        morphKey = newMorphKey;
+        origin = newOrigin;
+        int n = 0;
+
+        for (int op = 0; op < MAX_NODES; op++) {
+            bool inScene = scene.nodes[op].id != 404;
+            bool inMorph = morph.nodes[op].id != 404;
+            nodeDrawn[op] = inScene || inMorph;
+            nodeAlpha[op][0] = inScene ? 1.f : 0.f;
+            nodeAlpha[op][1] = inMorph ? 1.f : 0.f;
+            nodeCoords[op] = inScene ? scene.nodes[op].coords : morph.nodes[op].coords;
+            addPoint(n, inScene ? scene.nodes[op].coords : origin, inMorph ? morph.nodes[op].coords : origin);
+        }
+
+        numEdges = std::max(scene.numEdges, morph.numEdges);
+        for (int i = 0; i < numEdges; i++) {
+            const Edge* sceneEdge = getEdge(scene, i);
+            const Edge* morphEdge = getEdge(morph, i);
+            edgeAlpha[i][0] = sceneEdge ? 1.f : 0.f;
+            edgeAlpha[i][1] = morphEdge ? 1.f : 0.f;
+            edgeStart[i] = n;
+            addPoint(n, sceneEdge ? sceneEdge->moveCoords : origin, morphEdge ? morphEdge->moveCoords : origin);
+            edgeSegments[i] = std::max(sceneEdge ? sceneEdge->curveLength : 0, morphEdge ? morphEdge->curveLength : 0);
+            for (int j = 0; j < edgeSegments[i]; j++) {
+                for (int k = 0; k < 3; k++)
+                    addPoint(n, getCurvePoint(sceneEdge, j, k), getCurvePoint(morphEdge, j, k));
+            }
+
+            const Arrow* sceneArrow = getArrow(scene, i);
+            const Arrow* morphArrow = getArrow(morph, i);
+            arrowStart[i] = n;
+            addPoint(n, sceneArrow ? sceneArrow->moveCoords : origin, morphArrow ? morphArrow->moveCoords : origin);
+            for (int j = 0; j < ARROW_POINTS - 1; j++)
+                addPoint(n, sceneArrow ? sceneArrow->lines[j] : origin, morphArrow ? morphArrow->lines[j] : origin);
+        }
+
+        numFloats = (n * 2 + 3) / 4 * 4;
+        for (int i = n * 2; i < numFloats; i++) {
+            from[i] = 0.f;
+            to[i] = 0.f;
+        }
+    }
+
+    void lerp(float morph) {
+        using rack::simd::float_4;
+        float_4 m = morph;
+        for (int i = 0; i < numFloats; i += 4) {
+            float_4 a = float_4::load(&from[i]);
+            float_4 b = float_4::load(&to[i]);
+            (a + (b - a) * m).store(&points[i]);
+        }
+    }
+
+    Vec getPoint(int index) {
+        return Vec(points[index * 2], points[index * 2 + 1]);
+    }
+
+    // The edge drawn at index i, or the graph's last edge once it runs out; NULL if it has none
+    static const Edge* getEdge(const alGraph& graph, int i) {
+        if (graph.numEdges == 0)
+            return NULL;
+        return &graph.edges[std::min(i, graph.numEdges - 1)];
+    }
+
+    static const Arrow* getArrow(const alGraph& graph, int i) {
+        if (graph.numEdges == 0)
+            return NULL;
+        const Arrow* arrow = &graph.arrows[std::min(i, graph.numEdges - 1)];
+        return arrow->moveCoords.x == 0 ? NULL : arrow;
+    }
+
+    // Control point k of segment j, holding on the last segment once the edge runs out
+    Vec getCurvePoint(const Edge* edge, int j, int k) {
+        if (!edge || edge->curveLength == 0)
+            return origin;
+        return edge->curve[std::min(j, edge->curveLength - 1)][k];
+    }
+
+    void addPoint(int& n, Vec a, Vec b) {
+        from[n * 2] = a.x;
+        from[n * 2 + 1] = a.y;
+        to[n * 2] = b.x;
+        to[n * 2 + 1] = b.y;
+        n++;
+    }
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <rack.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+// PatchState Structure
+// Bitpacked module state, stored in patches as one base64 string next to the verbose JSON keys. The first byte is
+// the module's state version; after it, fields are read back in exactly the order and widths they were written.
+// Each module keeps its own version, and its reader skips fields that the decoded version didn't have yet.
+// A writer that was given a value too wide for its field is not exact, and its state should not be saved.
+// A reader that runs out of bytes or finds a version newer than its own is not ok, and the legacy keys should be used instead.
+
+struct PatchStateWriter {
+    std::vector<uint8_t> bytes;
+    int bitCount = 0;
+    bool exact = true;
+
+    PatchStateWriter(uint8_t version) {
+        writeBits(version, 8);
+    }
+
+    void writeBits(uint32_t value, int bits) {
+        for (int i = 0; i < bits; i++, bitCount++) {
+            if (bitCount % 8 == 0)
+                bytes.push_back(0);
+            if ((value >> i) & 1)
+                bytes.back() |= 1 << (bitCount % 8);
+        }
+    }
+
+    void writeBool(bool value) {
+        writeBits(value, 1);
+    }
+
+    // Two's complement, so -1 (nothing selected) fits
+    void writeInt(int value, int bits) {
+        if (value < -(1 << (bits - 1)) || value >= (1 << (bits - 1)))
+            exact = false;
+        writeBits((uint32_t) value, bits);
+    }
+
+    void writeFloat(float value) {
+        uint32_t raw;
+        std::memcpy(&raw, &value, sizeof(raw));
+        writeBits(raw, 32);
+    }
+
+    std::string toBase64() {
+        return rack::string::toBase64(bytes.data(), bytes.size());
+    }
+};
+
+struct PatchStateReader {
+    std::vector<uint8_t> bytes;
+    int bitCount = 0;
+    int version = 0;
+    bool ok = true;
+
+    PatchStateReader(const std::string& base64, uint8_t currentVersion) {
+        try {
+            bytes = rack::string::fromBase64(base64);
+        }
+        catch (rack::Exception& e) {
+            ok = false;
+            return;
+        }
+        version = readBits(8);
+        if (version < 1 || version > currentVersion)
+            ok = false;
+    }
+
+    uint32_t readBits(int bits) {
+        uint32_t value = 0;
+        for (int i = 0; i < bits; i++, bitCount++) {
+            if (bitCount / 8 >= (int) bytes.size()) {
+                ok = false;
+                return 0;
+            }
+            if ((bytes[bitCount / 8] >> (bitCount % 8)) & 1)
+                value |= 1u << i;
+        }
+        return value;
+    }
+
+    bool readBool() {
+        return readBits(1);
+    }
+
+    int readInt(int bits) {
+        uint32_t value = readBits(bits);
+        if (bits < 32 && (value >> (bits - 1)) & 1)
+            value |= ~0u << bits;
+        return (int32_t) value;
+    }
+
+    float readFloat() {
+        uint32_t raw = readBits(32);
+        float value;
+        std::memcpy(&value, &raw, sizeof(value));
+        return value;
+    }
+};
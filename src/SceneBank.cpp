@@ -0,0 +1,174 @@
+#include "SceneBank.hpp"
+#include "plugin.hpp" // For backgroundWorker
+#include <cstring>
+#if defined ARCH_WIN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+SceneBank sceneBank;
+
+static const char BANK_MAGIC[4] = {'D', 'L', 'X', 'B'};
+static constexpr size_t BANK_FILE_SIZE = sizeof(BankHeader) + BANK_SLOTS * sizeof(BankSlot);
+
+SceneBank::~SceneBank() {
+    close();
+}
+
+// Without create, only a bank that's already on disk is opened, so nothing is written to the user folder
+// until the first save
+bool SceneBank::open(bool create) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (slots)
+        return true;
+
+    std::string dir = rack::asset::user("DelexanderVol1");
+    std::string path = rack::system::join(dir, "SceneBank.bin");
+    if (!create && !rack::system::isFile(path))
+        return false;
+    rack::system::createDirectories(dir);
+    unusable = true;
+
+    BankHeader newHeader = {};
+    std::memcpy(newHeader.magic, BANK_MAGIC, sizeof(BANK_MAGIC));
+    newHeader.version = BANK_VERSION;
+    newHeader.slots = BANK_SLOTS;
+
+#if defined ARCH_WIN
+    std::wstring pathW = rack::string::UTF8toUTF16(path);
+    file = CreateFileW(pathW.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        file = NULL;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx((HANDLE) file, &size)) {
+        close();
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        // Extending the file fills it with zeros, i.e. empty slots
+        LARGE_INTEGER end;
+        end.QuadPart = BANK_FILE_SIZE;
+        DWORD written = 0;
+        if (!SetFilePointerEx((HANDLE) file, end, NULL, FILE_BEGIN) || !SetEndOfFile((HANDLE) file)
+            || SetFilePointer((HANDLE) file, 0, NULL, FILE_BEGIN) == INVALID_SET_FILE_POINTER
+            || !WriteFile((HANDLE) file, &newHeader, sizeof(newHeader), &written, NULL) || written != sizeof(newHeader)) {
+            close();
+            return false;
+        }
+        size.QuadPart = BANK_FILE_SIZE;
+    }
+    if ((size_t) size.QuadPart != BANK_FILE_SIZE) {
+        WARN("Scene bank %s has an unexpected size, leaving it closed", path.c_str());
+        close();
+        return false;
+    }
+    mapping = CreateFileMappingW((HANDLE) file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    view = MapViewOfFile((HANDLE) mapping, FILE_MAP_READ, 0, 0, BANK_FILE_SIZE);
+#else
+    file = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (file < 0)
+        return false;
+    struct stat st;
+    if (fstat(file, &st) != 0) {
+        close();
+        return false;
+    }
+    if (st.st_size == 0) {
+        // Extending the file fills it with zeros, i.e. empty slots
+        if (ftruncate(file, BANK_FILE_SIZE) != 0 || pwrite(file, &newHeader, sizeof(newHeader), 0) != (ssize_t) sizeof(newHeader)) {
+            close();
+            return false;
+        }
+        st.st_size = BANK_FILE_SIZE;
+    }
+    if ((size_t) st.st_size != BANK_FILE_SIZE) {
+        WARN("Scene bank %s has an unexpected size, leaving it closed", path.c_str());
+        close();
+        return false;
+    }
+    view = mmap(NULL, BANK_FILE_SIZE, PROT_READ, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED)
+        view = NULL;
+#endif
+    if (!view) {
+        close();
+        return false;
+    }
+
+    const BankHeader* header = (const BankHeader*) view;
+    if (std::memcmp(header->magic, BANK_MAGIC, sizeof(BANK_MAGIC)) || header->version != BANK_VERSION || header->slots != BANK_SLOTS) {
+        WARN("Scene bank %s is not a version %u bank of %d slots, leaving it closed", path.c_str(), BANK_VERSION, BANK_SLOTS);
+        close();
+        return false;
+    }
+    unusable = false;
+    slots.store((const BankSlot*) (header + 1), std::memory_order_release);
+    return true;
+}
+
+// For the UI thread when an input is in Bank Slot mode: maps an existing bank once, off the UI thread
+void SceneBank::requestOpen() {
+    if (slots.load(std::memory_order_acquire) || openRequested.exchange(true))
+        return;
+    backgroundWorker.submit([this] {
+        open(false);
+    });
+}
+
+void SceneBank::close() {
+    slots.store(NULL, std::memory_order_release);
+#if defined ARCH_WIN
+    if (view)
+        UnmapViewOfFile(view);
+    if (mapping)
+        CloseHandle((HANDLE) mapping);
+    if (file)
+        CloseHandle((HANDLE) file);
+    mapping = NULL;
+    file = NULL;
+#else
+    if (view)
+        munmap((void*) view, BANK_FILE_SIZE);
+    if (file >= 0)
+        ::close(file);
+    file = -1;
+#endif
+    view = NULL;
+}
+
+// NULL if the bank is closed or the slot is empty
+const BankSlot* SceneBank::getSlot(int slot) {
+    const BankSlot* slots = this->slots.load(std::memory_order_acquire);
+    if (!slots || slot < 0 || slot >= BANK_SLOTS || !(slots[slot].flags & BankSlot::WRITTEN))
+        return NULL;
+    return &slots[slot];
+}
+
+bool SceneBank::writeSlot(int slot, const BankSlot& data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!slots.load(std::memory_order_acquire) || slot < 0 || slot >= BANK_SLOTS)
+        return false;
+
+    BankSlot written = data;
+    written.flags |= BankSlot::WRITTEN;
+    size_t offset = sizeof(BankHeader) + slot * sizeof(BankSlot);
+#if defined ARCH_WIN
+    OVERLAPPED at = {};
+    at.Offset = (DWORD) offset;
+    DWORD count = 0;
+    return WriteFile((HANDLE) file, &written, sizeof(written), &count, &at) && count == sizeof(written);
+#else
+    return pwrite(file, &written, sizeof(written), offset) == (ssize_t) sizeof(written);
+#endif
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+
+// SceneBank Structure
+// A user file of BANK_SLOTS packed scene triplets, shared by every Algomorph Advance. The file is memory-mapped
+// read-only once, so a slot is a pointer into the mapping: the audio thread switches slots without touching the file,
+// allocating or locking. Writes go through the file itself and show up in the mapping.
+// Nothing is opened until the bank is used: the Scene bank menu and Bank Slot mode open an existing file, and only the
+// first save creates it.
+// An empty slot has no WRITTEN flag and reads back as NULL. A file that doesn't match BANK_VERSION and BANK_SLOTS is
+// left alone, and the bank stays closed.
+
+static constexpr int BANK_SLOTS = 4096;
+static constexpr uint32_t BANK_VERSION = 1;
+
+struct BankSlot {                               // 16 bytes, stored as is
+    static const uint8_t WRITTEN = 1 << 0;
+    static const uint8_t MODE_B = 1 << 1;
+    static const uint8_t RING_MORPH = 1 << 2;
+
+    uint16_t algoName[3];
+    uint8_t horizontalMarks[3];
+    uint8_t forcedCarriers[3];
+    uint8_t flags;
+    uint8_t reserved[3];
+};
+
+struct BankHeader {
+    char magic[4];                              // "DLXB"
+    uint32_t version;
+    uint32_t slots;
+    uint32_t reserved;
+};
+
+struct SceneBank {
+    std::atomic<const BankSlot*> slots{NULL};   // NULL until open() succeeds
+    std::atomic<bool> openRequested{false};
+    bool unusable = false;                      // The file exists but isn't a bank we can map
+    std::mutex mutex;                           // Held by open() and writeSlot(), never by readers
+#if defined ARCH_WIN
+    void* file = NULL;
+    void* mapping = NULL;
+#else
+    int file = -1;
+#endif
+    const void* view = NULL;
+
+    ~SceneBank();
+    bool open(bool create);
+    void requestOpen();
+    void close();
+    const BankSlot* getSlot(int slot);
+    bool writeSlot(int slot, const BankSlot& data);
+};
@@ -0,0 +1,91 @@
+#include "TelemetryRecorder.hpp"
+#include "plugin.hpp" // For backgroundWorker
+#include <ctime>
+
+
+static const char TELEMETRY_MAGIC[8] = {'A', 'L', 'G', 'O', 'T', 'L', 'M', '1'};
+
+TelemetryRecorder::~TelemetryRecorder() {
+    stop();
+}
+
+bool TelemetryRecorder::start(int64_t moduleId) {
+    if (recording)
+        return true;
+
+    char timestamp[32];
+    std::time_t t = std::time(NULL);
+    std::strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", std::localtime(&t));
+    std::string dir = rack::asset::user("DelexanderVol1");
+    rack::system::createDirectories(dir);
+    path = rack::system::join(dir, rack::string::f("telemetry-%lld-%s.%s", (long long) moduleId, timestamp, format == TelemetryFormats::CSV ? "csv" : "bin"));
+
+    file = std::fopen(path.c_str(), format == TelemetryFormats::CSV ? "w" : "wb");
+    if (!file)
+        return false;
+
+    if (format == TelemetryFormats::CSV) {
+        std::fprintf(file, "frame,channel,morph,relativeMorphMagnitude,centerMorphScene,forwardMorphScene,backwardMorphScene");
+        for (int op = 0; op < TelemetryFrame::OPS; op++)
+            std::fprintf(file, ",sumClickGain%d", op + 1);
+        for (int op = 0; op < TelemetryFrame::OPS; op++) {
+            for (int mod = 0; mod < TelemetryFrame::OPS; mod++)
+                std::fprintf(file, ",modClickGain%d_%d", op + 1, mod + 1);
+        }
+        std::fprintf(file, "\n");
+    }
+    else {
+        uint32_t frameSize = sizeof(TelemetryFrame);
+        std::fwrite(TELEMETRY_MAGIC, 1, sizeof(TELEMETRY_MAGIC), file);
+        std::fwrite(&frameSize, sizeof(frameSize), 1, file);
+    }
+
+    // Discard anything a late push left behind after the previous stop()
+    while (!ring.empty())
+        ring.shift();
+    divider.setDivision(decimation);
+    divider.reset();
+    dropped = 0;
+    written = 0;
+
+    backgroundWorker.acquire();
+    backgroundWorker.addPeriodic(this, [this] {
+        drain();
+    });
+    recording = true;
+    return true;
+}
+
+void TelemetryRecorder::stop() {
+    recording = false;
+    if (file) {
+        backgroundWorker.removePeriodic(this);
+        drain();
+        std::fclose(file);
+        file = NULL;
+        backgroundWorker.release();
+    }
+}
+
+void TelemetryRecorder::writeFrame(const TelemetryFrame& f) {
+    if (format == TelemetryFormats::BINARY) {
+        std::fwrite(&f, sizeof(f), 1, file);
+        return;
+    }
+    std::fprintf(file, "%lld,%d,%g,%g,%d,%d,%d", (long long) f.frame, f.channel, f.morph, f.relativeMorphMagnitude,
+                 f.centerMorphScene, f.forwardMorphScene, f.backwardMorphScene);
+    for (int op = 0; op < TelemetryFrame::OPS; op++)
+        std::fprintf(file, ",%g", f.sumClickGain[op]);
+    for (int op = 0; op < TelemetryFrame::OPS; op++) {
+        for (int mod = 0; mod < TelemetryFrame::OPS; mod++)
+            std::fprintf(file, ",%g", f.modClickGain[op][mod]);
+    }
+    std::fprintf(file, "\n");
+}
+
+void TelemetryRecorder::drain() {
+    while (!ring.empty()) {
+        writeFrame(ring.shift());
+        written++;
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <rack.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+
+// One decimated snapshot of a single channel's morph and routing state
+struct TelemetryFrame {
+    static constexpr int OPS = 4;
+
+    int64_t frame = 0;
+    int32_t channel = 0;
+    float morph = 0.f;
+    float relativeMorphMagnitude = 0.f;
+    int32_t centerMorphScene = 0;
+    int32_t forwardMorphScene = 0;
+    int32_t backwardMorphScene = 0;
+    float sumClickGain[OPS] = {0.f};                // [op]
+    float modClickGain[OPS][OPS] = {{0.f}};         // [op][mod]
+};
+
+struct TelemetryFormats {
+	static const int CSV = 0;
+	static const int BINARY = 1;
+	static const int NUM_FORMATS = 2;
+};
+
+//Order must match above
+static const std::string TelemetryFormatLabels[TelemetryFormats::NUM_FORMATS] = {	"CSV",
+																					"Binary"	};
+
+static constexpr int TELEMETRY_DECIMATIONS[] = {1, 16, 64, 256, 1024};
+static constexpr int DEF_TELEMETRY_DECIMATION = 64;
+
+
+// TelemetryRecorder Structure
+// The audio thread pushes into a preallocated single-producer/single-consumer ring, and the plugin's background
+// worker drains it to disk with its periodic tasks. Only start() and stop() allocate or touch files; call them from
+// the UI thread.
+
+struct TelemetryRecorder {
+    rack::dsp::RingBuffer<TelemetryFrame, 1 << 14> ring;
+    rack::dsp::ClockDivider divider;
+    std::atomic<bool> recording{false};
+    std::atomic<long> dropped{0};       // Frames lost to a full ring, counted by the audio thread
+    std::atomic<long> written{0};       // Counted by the background worker
+
+    int format = TelemetryFormats::CSV;
+    int decimation = DEF_TELEMETRY_DECIMATION;
+    std::string path = "";
+
+    FILE* file = NULL;
+
+    ~TelemetryRecorder();
+    bool start(int64_t moduleId);
+    void stop();
+    void writeFrame(const TelemetryFrame& f);
+    void drain();
+
+    // Audio thread
+    bool shouldRecord() {
+        return recording && divider.process();
+    }
+    void push(const TelemetryFrame& f) {
+        if (ring.full())
+            dropped++;
+        else
+            ring.push(f);
+    }
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include "LightEngine.hpp" // For LightVuSources
+#include <rack.hpp>
+
+
+// VuMeter Structure
+// Accumulates peak and energy per port during the audio loop, four channels at a time, so the lights see every
+// sample instead of whatever the port voltage happened to be on the light tick. Ports are indexed by
+// LightVuSources; read() fills a light engine VU array and starts a new window.
+
+struct VuMeter {
+    static constexpr int PORTS = LightVuSources::NUM_SOURCES;
+    static constexpr float PEAK_SCALE = 0.1f;       // 10V peak is full brightness
+    static constexpr float RMS_SCALE = 0.4f;        // 2.5V RMS is full brightness
+
+    rack::simd::float_4 peak[PORTS][4];             // [port][channel / 4]
+    rack::simd::float_4 energy[PORTS][4];           // [port][channel / 4]
+    int frames = 0;
+
+    VuMeter() {
+        reset();
+    }
+
+    void reset() {
+        for (int port = 0; port < PORTS; port++) {
+            for (int i = 0; i < 4; i++) {
+                peak[port][i] = 0.f;
+                energy[port][i] = 0.f;
+            }
+        }
+        frames = 0;
+    }
+
+    void accumulate(int port, const float* voltages, int channels) {
+        using rack::simd::float_4;
+        for (int c = 0; c < channels; c += 4) {
+            float_4 v = float_4::load(&voltages[c]);
+            if (channels - c < 4)
+                v = rack::simd::ifelse(float_4(c, c + 1, c + 2, c + 3) < float_4(channels), v, 0.f);
+            peak[port][c / 4] = rack::simd::fmax(peak[port][c / 4], rack::simd::fabs(v));
+            energy[port][c / 4] += v * v;
+        }
+    }
+
+    // Call once per process(), after the ports have been accumulated
+    void endFrame() {
+        frames++;
+    }
+
+    // Brightness per port: the louder of peak and RMS (summed over channels, like Rack's polyphonic plug lights)
+    void read(float* vu) {
+        vu[LightVuSources::NONE] = 0.f;
+        float invFrames = frames > 0 ? 1.f / frames : 0.f;
+        for (int port = 1; port < PORTS; port++) {
+            float portPeak = 0.f;
+            float portEnergy = 0.f;
+            for (int i = 0; i < 4; i++) {
+                for (int lane = 0; lane < 4; lane++) {
+                    portPeak = std::fmax(portPeak, peak[port][i][lane]);
+                    portEnergy += energy[port][i][lane];
+                }
+            }
+            float rms = std::sqrt(portEnergy * invFrames);
+            vu[port] = rack::math::clamp(std::fmax(portPeak * PEAK_SCALE, rms * RMS_SCALE), 0.f, 1.f);
+        }
+        reset();
+    }
+};
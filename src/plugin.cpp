@@ -9,6 +9,6 @@ void init(Plugin* p) {
 	// As an alternative, consider lazy-loading assets and lookup tables when your module is created to reduce startup times of Rack.
 	p->addModel(modelAlgomorphLarge);
 	p->addModel(modelAlgomorphSmall);
-
-	pluginSettings.readFromJson();
+	p->addModel(modelAlgomorphWide);
+	p->addModel(modelAlgomorphAux);
 }
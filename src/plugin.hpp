@@ -2,6 +2,8 @@
 #include <rack.hpp>
 #include <bitset>
 #include "pluginsettings.hpp"
+#include "SceneBank.hpp"
+#include "BackgroundWorker.hpp"
 #include "GraphStructure.hpp"
 #include "GraphData.hpp"
 
@@ -11,9 +13,13 @@ using namespace rack;
 extern Plugin* pluginInstance;
 
 extern DelexanderVol1Settings pluginSettings;
+extern SceneBank sceneBank;
+extern BackgroundWorker backgroundWorker;
 
 extern Model* modelAlgomorphLarge;
 extern Model* modelAlgomorphSmall;
+extern Model* modelAlgomorphWide;
+extern Model* modelAlgomorphAux;
 
 
 /// Constants:
@@ -34,6 +40,13 @@ constexpr float CLOCK_IGNORE_DURATION = 0.001f;     // disable clock on powerup
 constexpr float DEF_RED_BRIGHTNESS = 0.4695f;
 constexpr float INDICATOR_BRIGHTNESS = 1.f;
 constexpr float SVG_LIGHT_MIN_ALPHA = 5.f/9.f;
+constexpr float VISIBILITY_TIMEOUT = 0.25f;         // skip light and display work once the panel hasn't been drawn for this long
+constexpr float MIN_VISIBLE_ZOOM = 0.3f;            // below this rack zoom, the panel doesn't count as drawn
+constexpr float DISPLAY_QUANTIZE_STEPS = 256.f;     // display morph resolution, well under a pixel of node travel
+constexpr int DISPLAY_FRAME_RATES[] = {15, 30, 60, 0};  // 0 is unlimited
+constexpr int DEF_DISPLAY_FRAME_RATE = 30;
+constexpr int BLOCK_SIZES[] = {0, 4, 8, 16, 32};     // 0 routes per sample. Each divides the 32 sample CV rate
+constexpr int MAX_BLOCK_SIZE = 32;
 constexpr float RING_RADIUS = 8.752f;
 constexpr float RING_LIGHT_STROKEWIDTH = 0.75f;
 constexpr float RING_BG_STROKEWIDTH = 1.55f;
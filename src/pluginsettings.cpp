@@ -1,6 +1,7 @@
 #include <rack.hpp>
 #include "pluginsettings.hpp"
 #include "AuxSources.hpp"
+#include "plugin.hpp" // For backgroundWorker
 
 
 DelexanderVol1Settings pluginSettings;
@@ -43,13 +44,36 @@ void DelexanderVol1Settings::saveToJson() {
         json_object_set_new(settingsJ, (std::string("Aux Input ") + std::to_string(auxIndex) + " Default Modes").c_str(), auxDefaultsJ);
     }
 
-    std::string settingsFilename = rack::asset::user("DelexanderVol1.json");
-    FILE* file = fopen(settingsFilename.c_str(), "w");
-    if (file) {
-        json_dumpf(settingsJ, file, JSON_INDENT(2) | JSON_REAL_PRECISION(9));
-        fclose(file);
-    }
+    char* settingsText = json_dumps(settingsJ, JSON_INDENT(2) | JSON_REAL_PRECISION(9));
     json_decref(settingsJ);
+    if (!settingsText)
+        return;
+    std::string text = settingsText;
+    free(settingsText);
+
+    // Written to a temporary file and renamed over the old one, so a crash mid-write never leaves half a file
+    std::string settingsFilename = rack::asset::user("DelexanderVol1.json");
+    backgroundWorker.submit([text, settingsFilename] {
+        std::string tempFilename = settingsFilename + ".tmp";
+        FILE* file = fopen(tempFilename.c_str(), "w");
+        if (!file)
+            return;
+        bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+        written &= fclose(file) == 0;
+        if (written)
+            rack::system::rename(tempFilename, settingsFilename);
+        else
+            rack::system::remove(tempFilename);
+    });
+}
+
+// Settings are only needed once a module exists, so reading them waits for the first one instead of slowing down
+// Rack's startup
+void DelexanderVol1Settings::load() {
+    if (loaded)
+        return;
+    loaded = true;
+    readFromJson();
 }
 
 void DelexanderVol1Settings::readFromJson() {
@@ -8,9 +8,11 @@ struct DelexanderVol1Settings {
 	//NUM_AUX_INPUTS = 5
 	bool allowMultipleModes[5] = {false};
 	bool auxInputDefaults[5][AuxInputModes::NUM_MODES] = {{false}};
+	bool loaded = false;    // Modules are created on the UI thread only
 
 	DelexanderVol1Settings();
 	void initDefaults();
 	void saveToJson();
 	void readFromJson();
+	void load();
 };